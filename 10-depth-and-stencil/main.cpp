@@ -2,6 +2,7 @@
 #include "shader.h"
 #include "model.h"
 #include "camera.h"
+#include "benchmark.h"
 #include "stb_image.h"
 
 #include <sstream>
@@ -49,8 +50,19 @@ bool firstMouse = true;
 float lastX = width / 2.0f;
 float lastY = height / 2.0f;
 
-int main()
+int main(int argc, char** argv)
 {
+    // Benchmark mode renders a scripted camera path without a visible window and reports frame timings
+    BenchmarkOptions benchmarkOptions;
+    if(!Benchmark::parseArguments(argc, argv, benchmarkOptions))
+        return -1;
+    if(benchmarkOptions.enabled)
+    {
+        width = benchmarkOptions.width;
+        height = benchmarkOptions.height;
+        Benchmark::prepareContext();
+    }
+
     // Create window object
     glWindow window(title, width, height);
 
@@ -95,13 +107,29 @@ int main()
     // Uncomment to render models in wireframe
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    std::unique_ptr<Benchmark> benchmark;
+    if(benchmarkOptions.enabled)
+        benchmark.reset(new Benchmark(benchmarkOptions, "10-depth-and-stencil", glm::vec3(0.0f, 0.0f, 5.0f), 10.0f));
+
     // Render loop
     // -----------
-    while (!window.isShouldClose())
+    while (!window.isShouldClose() && !(benchmark && benchmark->isDone()))
     {
+        if(benchmark)
+            benchmark->beginFrame();
+
         // Process input
         // -------------
         processMovement(window.getGlWindow(), &camera);
+        if(benchmark)
+        {
+            // Scripted camera replaces mouse and keyboard
+            BenchmarkCameraPose pose = benchmark->cameraPose();
+            camera.setPosition(pose.position);
+            camera.setYaw(pose.yaw);
+            camera.setPitch(pose.pitch);
+            camera.processMouseMovement(0.0f, 0.0f);
+        }
 
         // Set background color and clear color buffer, depth buffer and stencil buffer
         // ------------------------------------------------------------
@@ -203,10 +231,16 @@ int main()
         // Shader::stencilFunctionality(GL_ALWAYS, 1, 0xFF);
         Shader::enableDepth();
 
-        window.swapBuffers();
+        if(benchmark)
+            benchmark->endFrame();
+        else
+            window.swapBuffers();
         glfwPollEvents();
     }
 
+    if(benchmark)
+        benchmark->finish();
+
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,100 @@
+#include "commandBuffer.h"
+
+CommandBuffer::CommandBuffer()
+{
+    count = 0;
+}
+
+CommandBuffer::~CommandBuffer()
+{
+
+}
+
+void CommandBuffer::record(const DrawPacket &packet)
+{
+    if(count == packets.size())
+        packets.resize(count == 0 ? 256 : count * 2);
+
+    packets[count++] = packet;
+}
+
+CommandReplayer::CommandReplayer()
+{
+    reset();
+}
+
+CommandReplayer::~CommandReplayer()
+{
+
+}
+
+void CommandReplayer::reset()
+{
+    // Use values that never match a real packet so first packet sets everything, state flags are all applied
+    stateKnown = false;
+    currentState = ~0u;
+    currentProgram = ~0u;
+    currentVertexArray = ~0u;
+    currentTexture = ~0u;
+    modelLocation = -1;
+}
+
+void CommandReplayer::applyState(uint32_t state)
+{
+    uint32_t changed = stateKnown ? state ^ currentState : ~0u;
+    if(changed & STATE_DEPTH_TEST)
+    {
+        if(state & STATE_DEPTH_TEST)
+            glEnable(GL_DEPTH_TEST);
+        else
+            glDisable(GL_DEPTH_TEST);
+    }
+    if(changed & STATE_DEPTH_WRITE)
+        glDepthMask((state & STATE_DEPTH_WRITE) ? GL_TRUE : GL_FALSE);
+    if(changed & STATE_BLEND)
+    {
+        if(state & STATE_BLEND)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+    }
+
+    currentState = state;
+    stateKnown = true;
+}
+
+void CommandReplayer::submit(const DrawPacket &packet)
+{
+    if(!stateKnown || packet.state != currentState)
+        applyState(packet.state);
+
+    if(packet.program != currentProgram)
+    {
+        glUseProgram(packet.program);
+        modelLocation = glGetUniformLocation(packet.program, "model");
+        currentProgram = packet.program;
+    }
+
+    if(packet.vertexArray != currentVertexArray)
+    {
+        glBindVertexArray(packet.vertexArray);
+        currentVertexArray = packet.vertexArray;
+    }
+
+    if(packet.texture != currentTexture)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, packet.texture);
+        currentTexture = packet.texture;
+    }
+
+    glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(packet.model));
+    glDrawArrays(packet.mode, packet.first, packet.count);
+}
+
+void CommandReplayer::submit(const CommandBuffer &buffer)
+{
+    const DrawPacket* packets = buffer.data();
+    for(unsigned int i = 0; i < buffer.size(); i++)
+        submit(packets[i]);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+/**
+ * @brief Render state flags a draw packet can ask for.
+*/
+enum DrawStateFlags
+{
+    STATE_DEPTH_TEST = 1 << 0,
+    STATE_DEPTH_WRITE = 1 << 1,
+    STATE_BLEND = 1 << 2,
+};
+
+/**
+ * @brief Backend-agnostic description of a single draw, recorded by worker threads and replayed on the GL thread.
+ * Packets only hold object names and plain data, so recording never touches the GL context.
+*/
+struct DrawPacket
+{
+    uint32_t state;             // Combination of DrawStateFlags
+    unsigned int program;       // Shader program to draw with
+    unsigned int vertexArray;   // Vertex array with geometry
+    unsigned int texture;       // 2D texture bound to texture unit 0 (0 for none)
+    GLenum mode;                // Primitive type (GL_TRIANGLES, etc.)
+    GLint first;                // First vertex to draw
+    GLsizei count;              // Number of vertices to draw
+    float depth;                // Distance from camera, used for sorting
+    glm::mat4 model;            // Uploaded to "model" uniform
+};
+
+/**
+ * @brief Class CommandBuffer is a linear per-thread buffer of draw packets.
+ * Memory is kept between frames so recording doesn't allocate once buffer has grown to scene size.
+*/
+class CommandBuffer
+{
+private:
+    std::vector<DrawPacket> packets;
+    unsigned int count;
+
+public:
+    CommandBuffer();
+    ~CommandBuffer();
+
+    /**
+     * @brief Empty buffer without releasing its memory.
+    */
+    void reset() { count = 0; };
+
+    /**
+     * @brief Append a packet to buffer.
+     * @param packet Packet to record.
+    */
+    void record(const DrawPacket &packet);
+
+    unsigned int size() const { return count; };
+    const DrawPacket* data() const { return packets.data(); };
+};
+
+/**
+ * @brief Class CommandReplayer executes draw packets on the GL thread and skips state changes that are already set.
+*/
+class CommandReplayer
+{
+private:
+    uint32_t currentState;
+    bool stateKnown;        // False after reset(), GL state left by other code is unknown
+    unsigned int currentProgram;
+    unsigned int currentVertexArray;
+    unsigned int currentTexture;
+    GLint modelLocation;    // Location of "model" uniform in current program
+
+    /**
+     * @brief Apply state flags that differ from current state.
+     * @param state Requested DrawStateFlags.
+    */
+    void applyState(uint32_t state);
+
+public:
+    CommandReplayer();
+    ~CommandReplayer();
+
+    /**
+     * @brief Forget cached state, should be called before replaying if GL state was changed outside replayer.
+    */
+    void reset();
+
+    /**
+     * @brief Execute a single packet.
+     * @param packet Packet to execute.
+    */
+    void submit(const DrawPacket &packet);
+
+    /**
+     * @brief Execute all packets of a buffer in recorded order.
+     * @param buffer Buffer to execute.
+    */
+    void submit(const CommandBuffer &buffer);
+};
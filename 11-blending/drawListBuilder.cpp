@@ -0,0 +1,111 @@
+#include "drawListBuilder.h"
+
+// Below this many items waking up workers costs more than it saves, so calling thread does everything
+constexpr unsigned int MIN_ITEMS_PER_THREAD = 512;
+
+DrawListBuilder::DrawListBuilder(unsigned int threadCount)
+{
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    job = nullptr;
+    itemCount = 0;
+    generation = 0;
+    pending = 0;
+    stopping = false;
+
+    buffers.resize(threadCount);
+    // Calling thread works too, so we only need threadCount - 1 workers
+    for(unsigned int i = 1; i < threadCount; i++)
+        workers.emplace_back(&DrawListBuilder::workerLoop, this, i);
+}
+
+DrawListBuilder::~DrawListBuilder()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+
+    for(unsigned int i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+void DrawListBuilder::workerLoop(unsigned int threadIndex)
+{
+    unsigned int seenGeneration = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+            if(stopping)
+                return;
+            seenGeneration = generation;
+        }
+
+        runRange(threadIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+        }
+        doneCondition.notify_one();
+    }
+}
+
+void DrawListBuilder::runRange(unsigned int threadIndex)
+{
+    CommandBuffer &buffer = buffers[threadIndex];
+    buffer.reset();
+
+    // Contiguous ranges keep packets in the same order a single thread would record them
+    unsigned int threadCount = buffers.size();
+    unsigned int chunk = (itemCount + threadCount - 1) / threadCount;
+    unsigned int begin = std::min(itemCount, threadIndex * chunk);
+    unsigned int end = std::min(itemCount, begin + chunk);
+
+    if(begin < end)
+        (*job)(begin, end, buffer);
+}
+
+void DrawListBuilder::build(unsigned int itemCount, const RecordFunction &record)
+{
+    // Small scenes are recorded on calling thread alone
+    if(workers.empty() || itemCount < MIN_ITEMS_PER_THREAD * 2)
+    {
+        for(unsigned int i = 1; i < buffers.size(); i++)
+            buffers[i].reset();
+
+        buffers[0].reset();
+        if(itemCount > 0)
+            record(0, itemCount, buffers[0]);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &record;
+        this->itemCount = itemCount;
+        pending = workers.size();
+        generation++;
+    }
+    startCondition.notify_all();
+
+    // Calling thread records first range while workers record the rest
+    runRange(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [&]() { return pending == 0; });
+    job = nullptr;
+}
+
+unsigned int DrawListBuilder::getPacketCount() const
+{
+    unsigned int count = 0;
+    for(unsigned int i = 0; i < buffers.size(); i++)
+        count += buffers[i].size();
+
+    return count;
+}
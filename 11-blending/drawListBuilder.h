@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "commandBuffer.h"
+
+/**
+ * @brief Class DrawListBuilder splits scene processing (culling, packet recording) across worker threads.
+ * Every thread records into its own CommandBuffer, so recording needs no locking. Buffers are kept in thread
+ * order, so replaying them one after another gives the same order as a single-threaded loop would.
+ * Only the GL thread (the one calling build()) should ever replay them.
+*/
+class DrawListBuilder
+{
+public:
+    /**
+     * @brief Function that processes items [begin, end) of the scene and records packets into buffer.
+    */
+    using RecordFunction = std::function<void(unsigned int begin, unsigned int end, CommandBuffer &buffer)>;
+
+private:
+    std::vector<std::thread> workers;
+    std::vector<CommandBuffer> buffers;     // Buffer 0 belongs to calling thread, buffer i to worker i - 1
+
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+
+    const RecordFunction* job;      // Job of current build, only valid while build() runs
+    unsigned int itemCount;         // Number of items of current build
+    unsigned int generation;        // Incremented every build so workers know a new job arrived
+    unsigned int pending;           // Workers that didn't finish current job yet
+    bool stopping;
+
+    /**
+     * @brief Main loop of every worker thread, waits for a job, runs its range and reports back.
+     * @param threadIndex Index of thread (and of its buffer).
+    */
+    void workerLoop(unsigned int threadIndex);
+
+    /**
+     * @brief Run current job on the range of items that belongs to thread.
+     * @param threadIndex Index of thread (and of its buffer).
+    */
+    void runRange(unsigned int threadIndex);
+
+public:
+    /**
+     * @brief Constructor to start worker threads.
+     * @param threadCount Number of threads recording in parallel (including calling thread), 0 uses all hardware threads.
+    */
+    DrawListBuilder(unsigned int threadCount = 0);
+    /**
+     * @brief Destructor stops and joins worker threads.
+    */
+    ~DrawListBuilder();
+
+    /**
+     * @brief Record packets for "itemCount" items using all threads, returns once every buffer is complete.
+     * @param itemCount Number of scene items to process.
+     * @param record Function that processes a range of items.
+    */
+    void build(unsigned int itemCount, const RecordFunction &record);
+
+    unsigned int getBufferCount() const { return buffers.size(); };
+    const CommandBuffer& getBuffer(unsigned int index) const { return buffers[index]; };
+
+    /**
+     * @brief Get number of packets recorded by all threads in last build.
+    */
+    unsigned int getPacketCount() const;
+};
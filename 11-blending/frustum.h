@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+/**
+ * @brief Class Frustum holds the 6 clipping planes of a camera to cull objects that are out of view.
+*/
+class Frustum
+{
+private:
+    glm::vec4 planes[6];    // Left, right, bottom, top, near, far (xyz is normal pointing inside, w is distance)
+
+public:
+    Frustum();
+    /**
+     * @brief Constructor to extract planes from camera matrices.
+     * @param viewProjection Projection matrix multiplied by view matrix.
+    */
+    Frustum(const glm::mat4 &viewProjection);
+    ~Frustum();
+
+    /**
+     * @brief Check whether a sphere is at least partially inside frustum.
+     * @param center Center of sphere in world space.
+     * @param radius Radius of sphere.
+    */
+    bool isSphereVisible(const glm::vec3 &center, float radius) const;
+};
@@ -58,7 +58,13 @@ int glWindow::initialise()
 
     // Initialize GLEW
     glewExperimental = GL_TRUE;
-    if(glewInit() != GLEW_OK)
+    GLenum glewStatus = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLEW built for GLX finds no display on surfaceless EGL contexts (headless benchmark), functions still load
+    if(glewStatus == GLEW_ERROR_NO_GLX_DISPLAY)
+        glewStatus = GLEW_OK;
+#endif
+    if(glewStatus != GLEW_OK)
     {
         std::cerr << "Failed to initialize GLEW" << std::endl;
         glfwDestroyWindow(window);
@@ -84,4 +90,7 @@ void glWindow::staticFrameBufferSizeCallback(GLFWwindow* window, int width, int
 void glWindow::frameBufferSizeCallback(GLFWwindow* window, int width, int height)
 {
     glViewport(0, 0, width, height);
+    // Offscreen targets follow framebuffer size through getBufferWidth() and getBufferHeight()
+    bufferWidth = width;
+    bufferHeight = height;
 }
@@ -3,6 +3,11 @@
 #include "texture.h"
 #include "model.h"
 #include "camera.h"
+#include "transparentQueue.h"
+#include "weightedBlendedOIT.h"
+#include "drawListBuilder.h"
+#include "frustum.h"
+#include "benchmark.h"
 #include "stb_image.h"
 
 #include <sstream>
@@ -28,6 +33,10 @@ std::string meshVShaderPath = pwd + "/../shaders/mesh.vs";
 std::string meshFShaderPath = pwd + "/../shaders/mesh.fs";
 std::string blendingVShaderPath = pwd + "/../shaders/blending.vs";
 std::string blendingFShaderPath = pwd + "/../shaders/blending.fs";
+std::string oitFShaderPath = pwd + "/../shaders/oit.fs";
+std::string screenVShaderPath = pwd + "/../shaders/screen.vs";
+std::string screenFShaderPath = pwd + "/../shaders/screen.fs";
+std::string compositeFShaderPath = pwd + "/../shaders/composite.fs";
 std::string modelPath = pwd + "/../../assets/backpack/backpack.obj";
 std::string cubePath = pwd + "/../../assets/cube/cube.obj";
 
@@ -43,6 +52,15 @@ glm::vec3 translationVec(0.0f);
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// Transparency mode, press "O" to switch between sorted blending and weighted blended OIT
+bool useOIT = false;
+// Press "B" to switch between the hand placed windows and a large field of windows for benchmarking
+bool useBenchmarkField = false;
+constexpr unsigned int BENCHMARK_FIELD_SIZE = 100;   // Field is BENCHMARK_FIELD_SIZE^2 windows
+constexpr float BENCHMARK_REPORT_INTERVAL = 2.0f;   // Seconds between benchmark reports
+// Radius of a sphere around a window quad, used to cull windows outside the camera's view
+constexpr float WINDOW_BOUNDING_RADIUS = 0.71f;
+
 // Create Camera object with starting location
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
 
@@ -76,8 +94,21 @@ std::vector<glm::vec3> windowsPositions =
     glm::vec3(0.0f, 0.5f, -10.0f),
 };
 
-int main()
+std::vector<glm::vec3> benchmarkPositions;
+
+int main(int argc, char** argv)
 {
+    // Benchmark mode renders a scripted camera path without a visible window and reports frame timings
+    BenchmarkOptions benchmarkOptions;
+    if(!Benchmark::parseArguments(argc, argv, benchmarkOptions))
+        return -1;
+    if(benchmarkOptions.enabled)
+    {
+        width = benchmarkOptions.width;
+        height = benchmarkOptions.height;
+        Benchmark::prepareContext();
+    }
+
     // Create window object
     glWindow window(title, width, height);
 
@@ -95,6 +126,9 @@ int main()
     // Build and compile shaders
     Shader meshShader(meshVShaderPath.c_str(), meshFShaderPath.c_str());
     Shader blendShader(blendingVShaderPath.c_str(), blendingFShaderPath.c_str());
+    Shader oitShader(blendingVShaderPath.c_str(), oitFShaderPath.c_str());
+    Shader compositeShader(screenVShaderPath.c_str(), compositeFShaderPath.c_str());
+    Shader screenShader(screenVShaderPath.c_str(), screenFShaderPath.c_str());
 
     // Configure OpenGL to use depth buffer
     Shader::enableGL(GL_DEPTH_TEST);
@@ -127,21 +161,75 @@ int main()
     // Point shader's uniform sampler2D to point to texture unit 0
     blendShader.setInt("texture1", 0);
 
+    oitShader.use();
+    oitShader.setInt("texture1", 0);
+
+    // Grid of windows to compare transparency modes under heavy load
+    for(unsigned int x = 0; x < BENCHMARK_FIELD_SIZE; x++)
+        for(unsigned int z = 0; z < BENCHMARK_FIELD_SIZE; z++)
+            benchmarkPositions.push_back(glm::vec3(x * 0.5f - BENCHMARK_FIELD_SIZE * 0.25f, 0.5f, z * 0.5f - BENCHMARK_FIELD_SIZE * 0.25f));
+
+    // Queue to sort transparent windows every frame, preallocated so sorting never allocates in render loop
+    TransparentQueue transparentQueue(benchmarkPositions.size());
+
+    // Worker threads cull windows and record draw packets, render thread only replays them
+    DrawListBuilder drawListBuilder;
+    CommandReplayer replayer;
+    // Pointers to recorded packets of all threads, indexed by transparent queue
+    std::vector<const DrawPacket*> recordedPackets;
+    recordedPackets.reserve(benchmarkPositions.size());
+
+    // Offscreen targets for weighted blended order-independent transparency
+    WeightedBlendedOIT oit(window.getBufferWidth(), window.getBufferHeight());
+
+    // Benchmark counters, reported every BENCHMARK_REPORT_INTERVAL seconds for active mode
+    unsigned int benchmarkFrames = 0;
+    double benchmarkFrameTime = 0.0;
+    double benchmarkTransparentTime = 0.0;
+    double benchmarkStart = glfwGetTime();
+
     // Uncomment to render models in wireframe
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    std::unique_ptr<Benchmark> benchmark;
+    if(benchmarkOptions.enabled)
+        benchmark.reset(new Benchmark(benchmarkOptions, "11-blending", glm::vec3(0.0f), 12.0f));
+
     // Render loop
     // -----------
-    while (!window.isShouldClose())
+    while (!window.isShouldClose() && !(benchmark && benchmark->isDone()))
     {
+        if(benchmark)
+            benchmark->beginFrame();
+
         // Process input
         // -------------
         processMovement(window.getGlWindow(), &camera);
+        if(benchmark)
+        {
+            // Scripted camera replaces mouse and keyboard
+            BenchmarkCameraPose pose = benchmark->cameraPose();
+            camera.setPosition(pose.position);
+            camera.setYaw(pose.yaw);
+            camera.setPitch(pose.pitch);
+            camera.processMouseMovement(0.0f, 0.0f);
+        }
+
+        const std::vector<glm::vec3> &transparentPositions = useBenchmarkField ? benchmarkPositions : windowsPositions;
 
         // Set background color and clear color buffer, depth buffer and stencil buffer
         // ------------------------------------------------------------
-        glClearColor(0, 0, 0, 1);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if(useOIT)
+        {
+            // Opaque scene is rendered offscreen so transparent pass can use its depth, targets follow window resizes
+            oit.resize(window.getBufferWidth(), window.getBufferHeight());
+            oit.beginOpaquePass(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+        }
+        else
+        {
+            glClearColor(0, 0, 0, 1);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
 
         // Calculate projection and view
         // ----------------------------------------------
@@ -190,34 +278,106 @@ int main()
 
         // Render transparent windows
         // ------------------------------------------------
-        // Sorting windows positions according to their distance from camera
-        // We need to render the windows from the farthest window to the closest one
-        // We just create a map with the distance as key and the map will automatically sort the keys for us from low to high
-        std::map<float, glm::vec3> sortedWindows;
-        for(unsigned int i = 0; i < windowsPositions.size(); i++)
+        double transparentStart = glfwGetTime();
+
+        // Template packet for windows, workers only fill in per-window data
+        DrawPacket windowPacket;
+        windowPacket.state = STATE_DEPTH_TEST | STATE_BLEND | (useOIT ? 0 : STATE_DEPTH_WRITE);
+        windowPacket.program = useOIT ? oitShader.getID() : blendShader.getID();
+        windowPacket.vertexArray = windowVAO;
+        windowPacket.texture = windowTexture.getTextureId();
+        windowPacket.mode = GL_TRIANGLES;
+        windowPacket.first = 0;
+        windowPacket.count = 6;
+
+        // Cull and record windows on all threads
+        Frustum frustum(projection * view);
+        glm::vec3 cameraPosition = camera.getPosition();
+        drawListBuilder.build(transparentPositions.size(), [&](unsigned int begin, unsigned int end, CommandBuffer &buffer)
+        {
+            DrawPacket packet = windowPacket;
+            for(unsigned int i = begin; i < end; i++)
+            {
+                // Quad spans from 0 to 1 on the X-axis so its center is half a unit to the right
+                glm::vec3 center = transparentPositions[i] + glm::vec3(0.5f, 0.0f, 0.0f);
+                if(!frustum.isSphereVisible(center, WINDOW_BOUNDING_RADIUS))
+                    continue;
+
+                // Squared distance keeps the same order as distance so we can skip the square root
+                glm::vec3 offset = cameraPosition - transparentPositions[i];
+                packet.depth = glm::dot(offset, offset);
+                packet.model = glm::translate(glm::mat4(1.0f), transparentPositions[i]);
+                buffer.record(packet);
+            }
+        });
+
+        if(useOIT)
         {
-            float distance = glm::length(camera.getPosition() - windowsPositions[i]);
-            sortedWindows[distance] = windowsPositions[i];
+            // Weighted blended OIT doesn't care about order so buffers are replayed as they are
+            oit.beginTransparentPass();
+
+            oitShader.use();
+            oitShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
+            oitShader.setMatrix4fv("view" , 1, GL_FALSE, view);
+            replayer.reset();
+            for(unsigned int i = 0; i < drawListBuilder.getBufferCount(); i++)
+                replayer.submit(drawListBuilder.getBuffer(i));
+
+            oit.composite(compositeShader, screenShader);
         }
+        else
+        {
+            // Sorting recorded windows according to their distance from camera
+            // We need to render the windows from the farthest window to the closest one
+            transparentQueue.clear();
+            recordedPackets.clear();
+            for(unsigned int i = 0; i < drawListBuilder.getBufferCount(); i++)
+            {
+                const CommandBuffer &buffer = drawListBuilder.getBuffer(i);
+                for(unsigned int j = 0; j < buffer.size(); j++)
+                {
+                    transparentQueue.push(buffer.data()[j].depth, recordedPackets.size());
+                    recordedPackets.push_back(&buffer.data()[j]);
+                }
+            }
+            transparentQueue.sort();
+
+            blendShader.use();
+            blendShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
+            blendShader.setMatrix4fv("view" , 1, GL_FALSE, view);
+            // Queue is already ordered from the farthest to the closest window so we replay in queue order
+            replayer.reset();
+            for(unsigned int i = 0; i < transparentQueue.size(); i++)
+                replayer.submit(*recordedPackets[transparentQueue.getIndex(i)]);
+            glBindVertexArray(0);
+        }
+        benchmarkTransparentTime += glfwGetTime() - transparentStart;
 
-        blendShader.use();
-        blendShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
-        blendShader.setMatrix4fv("view" , 1, GL_FALSE, view);
-        glBindVertexArray(windowVAO);
-        // Iterate sorted windows in reverse order so we start from the highest (farthest) to the lowest (closest)
-        // and render the windows in this order
-        for(std::map<float, glm::vec3>::reverse_iterator iter = sortedWindows.rbegin(); iter != sortedWindows.rend(); ++iter)
+        // Benchmark report for active transparency mode
+        // ------------------------------------------------
+        benchmarkFrames++;
+        benchmarkFrameTime += deltaTime;
+        if(glfwGetTime() - benchmarkStart >= BENCHMARK_REPORT_INTERVAL)
         {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, iter->second);
-            blendShader.setMatrix4fv("model", 1, GL_FALSE, model);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+            std::cout << (useOIT ? "Weighted blended OIT" : "Sorted blending") << " | " << drawListBuilder.getPacketCount() << "/" << transparentPositions.size() << " windows visible | "
+                      << "frame " << benchmarkFrameTime * 1000.0 / benchmarkFrames << " ms | "
+                      << "transparent pass (CPU) " << benchmarkTransparentTime * 1000.0 / benchmarkFrames << " ms" << std::endl;
+            benchmarkFrames = 0;
+            benchmarkFrameTime = 0.0;
+            benchmarkTransparentTime = 0.0;
+            benchmarkStart = glfwGetTime();
         }
 
-        window.swapBuffers();
+        if(benchmark)
+            benchmark->endFrame();
+        else
+            window.swapBuffers();
         glfwPollEvents();
     }
 
+    if(benchmark)
+        benchmark->finish();
+
     glfwTerminate();
     return 0;
 }
@@ -294,6 +454,17 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         }
     }
 
+    // If user presses "O" key - switch between sorted blending and weighted blended OIT
+    if(key == GLFW_KEY_O && action == GLFW_PRESS)
+    {
+        useOIT = !useOIT;
+        std::cout << "Transparency mode: " << (useOIT ? "weighted blended OIT" : "sorted blending") << std::endl;
+    }
+
+    // If user presses "B" key - switch between hand placed windows and benchmark field
+    if(key == GLFW_KEY_B && action == GLFW_PRESS)
+        useBenchmarkField = !useBenchmarkField;
+
     // If user presses ESC key button - exit program
     if(key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         exit(0);
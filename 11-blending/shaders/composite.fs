@@ -0,0 +1,24 @@
+#version 330 core
+
+in vec2 texCoords;
+
+out vec4 fragColor;
+
+uniform sampler2D accumulationTexture;
+uniform sampler2D weightTexture;
+
+void main()
+{
+    vec4 accumulation = texture(accumulationTexture, texCoords);
+    float revealage = accumulation.a;
+
+    // Nothing transparent covered this pixel, leave opaque color untouched
+    if(revealage >= 1.0)
+        discard;
+
+    float weightSum = texture(weightTexture, texCoords).r;
+    vec3 averageColor = accumulation.rgb / max(weightSum, 1e-5);
+
+    // Composite over opaque color with (SRC_ALPHA, ONE_MINUS_SRC_ALPHA) blending
+    fragColor = vec4(averageColor, 1.0 - revealage);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+
+in vec2 texCoords;
+
+// Accumulation target: rgb holds weighted premultiplied color, alpha ends up as revealage
+layout (location = 0) out vec4 accumulation;
+// Weight target: sum of alpha * weight, used to normalize accumulated color
+layout (location = 1) out float weight;
+
+uniform sampler2D texture1;
+
+void main()
+{
+    vec4 color = texture(texture1, texCoords);
+
+    // Depth and coverage weight (McGuire & Bavoil, equation 7), closer and more opaque fragments weigh more
+    float w = clamp(pow(min(1.0, color.a * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+
+    // Blending is set to (ONE, ONE) for rgb and (ZERO, ONE_MINUS_SRC_ALPHA) for alpha,
+    // so rgb is summed and alpha is multiplied by (1 - alpha) of every fragment
+    accumulation = vec4(color.rgb * color.a * w, color.a);
+    weight = color.a * w;
+}
@@ -0,0 +1,12 @@
+#version 330 core
+
+in vec2 texCoords;
+
+out vec4 fragColor;
+
+uniform sampler2D screenTexture;
+
+void main()
+{
+    fragColor = vec4(texture(screenTexture, texCoords).rgb, 1.0);
+}
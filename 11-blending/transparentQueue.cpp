@@ -0,0 +1,113 @@
+#include "transparentQueue.h"
+
+// Radix sort works on 8 bits per pass, so 4 passes cover a 32-bit key
+constexpr unsigned int RADIX_BITS = 8;
+constexpr unsigned int RADIX_SIZE = 1 << RADIX_BITS;
+constexpr unsigned int RADIX_PASSES = 32 / RADIX_BITS;
+
+TransparentQueue::TransparentQueue(unsigned int capacity)
+{
+    count = 0;
+    reserve(capacity);
+}
+
+TransparentQueue::~TransparentQueue()
+{
+
+}
+
+uint32_t TransparentQueue::floatToKey(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // Negative floats have all bits flipped (so larger magnitude sorts lower),
+    // positive floats only get the sign bit flipped (so they sort above all negatives)
+    uint32_t mask = (bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+    return bits ^ mask;
+}
+
+void TransparentQueue::reserve(unsigned int capacity)
+{
+    if(capacity <= keys.size())
+        return;
+
+    keys.resize(capacity);
+    indices.resize(capacity);
+    tempKeys.resize(capacity);
+    tempIndices.resize(capacity);
+}
+
+void TransparentQueue::clear()
+{
+    count = 0;
+}
+
+void TransparentQueue::push(float distance, unsigned int index)
+{
+    // Only grows when the scene has more transparent objects than ever before, otherwise no allocation happens
+    if(count == keys.size())
+        reserve(count == 0 ? 64 : count * 2);
+
+    // Invert key so that an ascending sort gives us farthest objects first
+    keys[count] = ~floatToKey(distance);
+    indices[count] = index;
+    count++;
+}
+
+void TransparentQueue::sort()
+{
+    if(count < 2)
+        return;
+
+    // Build histograms for all passes with a single read over the keys
+    unsigned int histograms[RADIX_PASSES][RADIX_SIZE] = {};
+    for(unsigned int i = 0; i < count; i++)
+    {
+        uint32_t key = keys[i];
+        for(unsigned int pass = 0; pass < RADIX_PASSES; pass++)
+            histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+    }
+
+    uint32_t* srcKeys = keys.data();
+    uint32_t* srcIndices = indices.data();
+    uint32_t* dstKeys = tempKeys.data();
+    uint32_t* dstIndices = tempIndices.data();
+
+    for(unsigned int pass = 0; pass < RADIX_PASSES; pass++)
+    {
+        unsigned int* histogram = histograms[pass];
+        unsigned int shift = pass * RADIX_BITS;
+
+        // If every key has the same digit in this pass the order wouldn't change, so skip it.
+        // This is common for the high bits since nearby objects share the same float exponent.
+        if(histogram[(srcKeys[0] >> shift) & (RADIX_SIZE - 1)] == count)
+            continue;
+
+        // Turn digit counts into starting offsets
+        unsigned int offset = 0;
+        for(unsigned int digit = 0; digit < RADIX_SIZE; digit++)
+        {
+            unsigned int digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        // Scatter in order, which keeps the sort stable
+        for(unsigned int i = 0; i < count; i++)
+        {
+            unsigned int position = histogram[(srcKeys[i] >> shift) & (RADIX_SIZE - 1)]++;
+            dstKeys[position] = srcKeys[i];
+            dstIndices[position] = srcIndices[i];
+        }
+
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcIndices, dstIndices);
+    }
+
+    // After an odd number of passes the sorted data lives in the scratch buffers
+    if(srcKeys != keys.data())
+    {
+        keys.swap(tempKeys);
+        indices.swap(tempIndices);
+    }
+}
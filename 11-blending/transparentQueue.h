@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class TransparentQueue collects transparent objects every frame and sorts them back to front.
+ * Distances are stored as 32-bit keys built from the float bits, so a stable LSD radix sort orders them
+ * without any per-object allocation, and objects with the exact same distance are kept (in push order).
+*/
+class TransparentQueue
+{
+private:
+    std::vector<uint32_t> keys;         // Sort keys (one per pushed object)
+    std::vector<uint32_t> indices;      // Object indices that travel with the keys
+    std::vector<uint32_t> tempKeys;     // Scratch buffer for radix passes
+    std::vector<uint32_t> tempIndices;  // Scratch buffer for radix passes
+    unsigned int count;                 // Number of objects pushed this frame
+
+    /**
+     * @brief Convert float bits to an unsigned key that sorts the same way as the float does.
+     * @param value Float to convert.
+    */
+    static uint32_t floatToKey(float value);
+
+    /**
+     * @brief Grow internal buffers so they can hold at least "capacity" objects.
+     * @param capacity Number of objects buffers should hold.
+    */
+    void reserve(unsigned int capacity);
+
+public:
+    /**
+     * @brief Constructor to preallocate queue.
+     * @param capacity Number of objects to preallocate room for.
+    */
+    TransparentQueue(unsigned int capacity = 0);
+    ~TransparentQueue();
+
+    /**
+     * @brief Empty queue without releasing its memory, should be called at the start of every frame.
+    */
+    void clear();
+
+    /**
+     * @brief Add an object to queue.
+     * @param distance Distance (or squared distance) of object from camera.
+     * @param index Index of object in caller's array.
+    */
+    void push(float distance, unsigned int index);
+
+    /**
+     * @brief Sort queued objects from farthest to closest (stable, so equal distances keep push order).
+    */
+    void sort();
+
+    unsigned int size() const { return count; };
+
+    /**
+     * @brief Get object index at position in sorted order (0 is the farthest object).
+     * @param i Position in queue.
+    */
+    unsigned int getIndex(unsigned int i) const { return indices[i]; };
+
+    const uint32_t* getIndices() const { return indices.data(); };
+};
@@ -0,0 +1,177 @@
+#include "weightedBlendedOIT.h"
+
+float oitQuadVertices[] =
+{
+    // positions   // texture coordinates
+    -1.0f,  1.0f,  0.0f, 1.0f,
+    -1.0f, -1.0f,  0.0f, 0.0f,
+     1.0f, -1.0f,  1.0f, 0.0f,
+
+    -1.0f,  1.0f,  0.0f, 1.0f,
+     1.0f, -1.0f,  1.0f, 0.0f,
+     1.0f,  1.0f,  1.0f, 1.0f,
+};
+
+WeightedBlendedOIT::WeightedBlendedOIT(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    // Depth buffer shared by both framebuffers
+    glGenRenderbuffers(1, &depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    // Opaque framebuffer configuration
+    // --------------------------------------------------
+    glGenFramebuffers(1, &opaqueFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, opaqueFramebuffer);
+    opaqueTexture = createAttachment(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, opaqueTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "ERROR::WeightedBlendedOIT::can't initialise opaque framebuffer" << std::endl;
+
+    // Transparent framebuffer configuration
+    // --------------------------------------------------
+    glGenFramebuffers(1, &transparentFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, transparentFramebuffer);
+    // 32 bit float, sums of weights up to 3e3 per layer overflow half floats (65504) after about 20 layers
+    accumulationTexture = createAttachment(GL_RGBA32F, GL_RGBA, GL_FLOAT);
+    weightTexture = createAttachment(GL_R32F, GL_RED, GL_FLOAT);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumulationTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, weightTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "ERROR::WeightedBlendedOIT::can't initialise transparent framebuffer" << std::endl;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // 2D Quad creation
+    glGenVertexArrays(1, &quadVao);
+    glGenBuffers(1, &quadVbo);
+    glBindVertexArray(quadVao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(oitQuadVertices), oitQuadVertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glBindVertexArray(0);
+}
+
+WeightedBlendedOIT::~WeightedBlendedOIT()
+{
+    glDeleteVertexArrays(1, &quadVao);
+    glDeleteBuffers(1, &quadVbo);
+    glDeleteTextures(1, &opaqueTexture);
+    glDeleteTextures(1, &accumulationTexture);
+    glDeleteTextures(1, &weightTexture);
+    glDeleteRenderbuffers(1, &depthRenderbuffer);
+    glDeleteFramebuffers(1, &opaqueFramebuffer);
+    glDeleteFramebuffers(1, &transparentFramebuffer);
+}
+
+unsigned int WeightedBlendedOIT::createAttachment(GLint internalFormat, GLenum format, GLenum type)
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return texture;
+}
+
+void WeightedBlendedOIT::resize(int width, int height)
+{
+    if((width == this->width && height == this->height) || width <= 0 || height <= 0)
+        return;
+    this->width = width;
+    this->height = height;
+
+    // Redefining storage keeps texture names, so framebuffer attachments stay valid
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindTexture(GL_TEXTURE_2D, opaqueTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, accumulationTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    glBindTexture(GL_TEXTURE_2D, weightTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void WeightedBlendedOIT::beginOpaquePass(glm::vec4 clearColor)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, opaqueFramebuffer);
+    glViewport(0, 0, width, height);
+
+    glClearColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+void WeightedBlendedOIT::beginTransparentPass()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, transparentFramebuffer);
+
+    // Accumulation starts at zero color and full revealage, weight sum starts at zero
+    const GLfloat clearAccumulation[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    const GLfloat clearWeight[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, clearAccumulation);
+    glClearBufferfv(GL_COLOR, 1, clearWeight);
+
+    // Test against opaque depth but don't write, transparent fragments must never occlude each other
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+
+    // Same blend function on both targets (works on GL 3.3 without per-target blending):
+    // rgb is summed (accumulated color and weight), alpha is multiplied by (1 - alpha) (revealage)
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void WeightedBlendedOIT::composite(Shader &compositeShader, Shader &screenShader)
+{
+    glBindVertexArray(quadVao);
+
+    // Resolve transparent targets over opaque color
+    glBindFramebuffer(GL_FRAMEBUFFER, opaqueFramebuffer);
+    glDisable(GL_DEPTH_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    compositeShader.use();
+    compositeShader.setInt("accumulationTexture", 0);
+    compositeShader.setInt("weightTexture", 1);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, accumulationTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, weightTexture);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    // Draw final image to default framebuffer
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDisable(GL_BLEND);
+
+    screenShader.use();
+    screenShader.setInt("screenTexture", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, opaqueTexture);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    // Set state back to defaults used by the rest of the scene
+    glBindVertexArray(0);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <iostream>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include "shader.h"
+
+/**
+ * @brief Class WeightedBlendedOIT renders transparent objects with weighted blended order-independent transparency
+ * (McGuire & Bavoil). Transparent fragments are accumulated into an accumulation target and a weight target
+ * in any order, then a full-screen composite pass resolves them over the opaque scene, so no sorting is needed.
+*/
+class WeightedBlendedOIT
+{
+private:
+    int width, height;
+
+    // Opaque scene is rendered offscreen so transparent pass can depth test against it
+    unsigned int opaqueFramebuffer;
+    unsigned int opaqueTexture;
+    unsigned int depthRenderbuffer;     // Shared between opaque and transparent framebuffers
+
+    // Transparent pass targets
+    unsigned int transparentFramebuffer;
+    unsigned int accumulationTexture;   // RGBA32F - rgb: sum of weighted premultiplied color, a: revealage
+    unsigned int weightTexture;         // R32F - sum of alpha * weight
+
+    // Full-screen quad for composite and screen passes
+    unsigned int quadVao, quadVbo;
+
+    /**
+     * @brief Create texture to use as framebuffer color attachment.
+     * @param internalFormat Internal format of texture.
+     * @param format Format of pixel data.
+     * @param type Type of pixel data.
+    */
+    unsigned int createAttachment(GLint internalFormat, GLenum format, GLenum type);
+
+public:
+    /**
+     * @brief Constructor to create all framebuffers and targets.
+     * @param width Width of render targets.
+     * @param height Height of render targets.
+    */
+    WeightedBlendedOIT(int width, int height);
+    ~WeightedBlendedOIT();
+
+    /**
+     * @brief Resize all targets to framebuffer size, does nothing if size didn't change.
+     * @param width Width of render targets.
+     * @param height Height of render targets.
+    */
+    void resize(int width, int height);
+
+    /**
+     * @brief Bind and clear opaque framebuffer, opaque objects should be rendered after calling this.
+     * @param clearColor Background color.
+    */
+    void beginOpaquePass(glm::vec4 clearColor);
+
+    /**
+     * @brief Bind and clear transparent targets and set blending state, transparent objects can be rendered in any order after calling this.
+    */
+    void beginTransparentPass();
+
+    /**
+     * @brief Resolve transparent targets over opaque scene and draw result to default framebuffer.
+     * @param compositeShader Shader that resolves accumulation and weight targets.
+     * @param screenShader Shader that draws a texture on a full-screen quad.
+    */
+    void composite(Shader &compositeShader, Shader &screenShader);
+};
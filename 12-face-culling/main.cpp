@@ -1,6 +1,7 @@
 #include "glWindow.h"
 #include "shader.h"
 #include "camera.h"
+#include "benchmark.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -87,8 +88,19 @@ float cubeVertices[] =
     -0.5f,  0.5f,  0.5f,  0.0f, 0.0f  // bottom-left        
 };
 
-int main()
+int main(int argc, char** argv)
 {
+    // Benchmark mode renders a scripted camera path without a visible window and reports frame timings
+    BenchmarkOptions benchmarkOptions;
+    if(!Benchmark::parseArguments(argc, argv, benchmarkOptions))
+        return -1;
+    if(benchmarkOptions.enabled)
+    {
+        width = benchmarkOptions.width;
+        height = benchmarkOptions.height;
+        Benchmark::prepareContext();
+    }
+
     // Create window object
     glWindow window(title, width, height);
 
@@ -128,13 +140,29 @@ int main()
     // Uncomment to render models in wireframe
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    std::unique_ptr<Benchmark> benchmark;
+    if(benchmarkOptions.enabled)
+        benchmark.reset(new Benchmark(benchmarkOptions, "12-face-culling", glm::vec3(0.0f), 3.0f));
+
     // Render loop
     // -----------
-    while (!window.isShouldClose())
+    while (!window.isShouldClose() && !(benchmark && benchmark->isDone()))
     {
+        if(benchmark)
+            benchmark->beginFrame();
+
         // Process input
         // -------------
         processMovement(window.getGlWindow(), &camera);
+        if(benchmark)
+        {
+            // Scripted camera replaces mouse and keyboard
+            BenchmarkCameraPose pose = benchmark->cameraPose();
+            camera.setPosition(pose.position);
+            camera.setYaw(pose.yaw);
+            camera.setPitch(pose.pitch);
+            camera.processMouseMovement(0.0f, 0.0f);
+        }
 
         // Set background color and clear color buffer, depth buffer and stencil buffer
         // ------------------------------------------------------------
@@ -157,10 +185,16 @@ int main()
         meshShader.setVec3("color", glm::value_ptr(glm::vec3(0.9f)));
         glDrawArrays(GL_TRIANGLES, 0, 36);
 
-        window.swapBuffers();
+        if(benchmark)
+            benchmark->endFrame();
+        else
+            window.swapBuffers();
         glfwPollEvents();
     }
 
+    if(benchmark)
+        benchmark->finish();
+
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,348 @@
+#include "deferredRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Light volume sphere tessellation
+constexpr unsigned int SPHERE_RINGS = 8;
+constexpr unsigned int SPHERE_SEGMENTS = 12;
+
+float deferredQuadVertices[] =
+{
+    // First triangle
+    -1.0f,  1.0f, 0.0f, 1.0f,
+    -1.0f, -1.0f, 0.0f, 0.0f,
+     1.0f, -1.0f, 1.0f, 0.0f,
+
+    // Second triangle
+    -1.0f,  1.0f, 0.0f, 1.0f,
+     1.0f,  1.0f, 1.0f, 1.0f,
+     1.0f, -1.0f, 1.0f, 0.0f,
+};
+
+DeferredRenderer::DeferredRenderer(int width, int height, const std::string &shaderDirectory) :
+ambientShader((shaderDirectory + "/screen.vs").c_str(), (shaderDirectory + "/deferredAmbient.fs").c_str()),
+stencilShader((shaderDirectory + "/lightVolume.vs").c_str(), (shaderDirectory + "/lightStencil.fs").c_str()),
+volumeLightShader((shaderDirectory + "/lightVolume.vs").c_str(), (shaderDirectory + "/deferredLight.fs").c_str()),
+scissorLightShader((shaderDirectory + "/screen.vs").c_str(), (shaderDirectory + "/deferredLight.fs").c_str())
+{
+    this->width = width;
+    this->height = height;
+    lightVolumeMode = LIGHT_VOLUME_STENCIL;
+    clearColor = glm::vec4(0.0f);
+
+    // G-buffer
+    // --------------------------------------------------
+    glGenFramebuffers(1, &geometryFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, geometryFramebuffer);
+
+    normalTexture = createAttachment(GL_RG16F, GL_RG, GL_HALF_FLOAT);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, normalTexture, 0);
+
+    albedoSpecularTexture = createAttachment(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, albedoSpecularTexture, 0);
+
+    // Linear depth is stored as color so lighting never samples the depth buffer it is stencil testing against
+    depthTexture = createAttachment(GL_R32F, GL_RED, GL_FLOAT);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, depthTexture, 0);
+
+    GLenum geometryAttachments[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, geometryAttachments);
+
+    glGenRenderbuffers(1, &depthStencilRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthStencilRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencilRenderbuffer);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "ERROR::DeferredRenderer::G-buffer framebuffer is not complete" << std::endl;
+
+    // Lighting target
+    // --------------------------------------------------
+    glGenFramebuffers(1, &lightingFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, lightingFramebuffer);
+
+    lightingTexture = createAttachment(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, lightingTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencilRenderbuffer);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "ERROR::DeferredRenderer::lighting framebuffer is not complete" << std::endl;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Full-screen quad
+    glGenVertexArrays(1, &quadVao);
+    glGenBuffers(1, &quadVbo);
+    glBindVertexArray(quadVao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(deferredQuadVertices), deferredQuadVertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+
+    createSphere();
+    glBindVertexArray(0);
+
+    // G-buffer samplers never change
+    Shader* lightShaders[] = { &ambientShader, &volumeLightShader, &scissorLightShader };
+    for(Shader* shader : lightShaders)
+    {
+        shader->use();
+        shader->setInt("gNormal", 0);
+        shader->setInt("gAlbedoSpecular", 1);
+        shader->setInt("gDepth", 2);
+    }
+    glUseProgram(0);
+}
+
+DeferredRenderer::~DeferredRenderer()
+{
+    glDeleteFramebuffers(1, &geometryFramebuffer);
+    glDeleteFramebuffers(1, &lightingFramebuffer);
+
+    unsigned int textures[] = { normalTexture, albedoSpecularTexture, depthTexture, lightingTexture };
+    glDeleteTextures(4, textures);
+    glDeleteRenderbuffers(1, &depthStencilRenderbuffer);
+
+    glDeleteVertexArrays(1, &quadVao);
+    glDeleteBuffers(1, &quadVbo);
+    glDeleteVertexArrays(1, &sphereVao);
+    glDeleteBuffers(1, &sphereVbo);
+    glDeleteBuffers(1, &sphereEbo);
+}
+
+unsigned int DeferredRenderer::createAttachment(GLint internalFormat, GLenum format, GLenum type)
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+    // G-buffer is read texel by texel, filtering would blend normals and depths of different surfaces
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return texture;
+}
+
+void DeferredRenderer::createSphere()
+{
+    // Flat faces of a tessellated sphere lie inside the real sphere, scale vertices out so the volume fully encloses it
+    float scale = 1.0f / (std::cos(glm::pi<float>() / SPHERE_SEGMENTS) * std::cos(glm::pi<float>() / (2.0f * SPHERE_RINGS)));
+
+    std::vector<float> vertices;
+    for(unsigned int ring = 0; ring <= SPHERE_RINGS; ring++)
+    {
+        float phi = glm::pi<float>() * ring / SPHERE_RINGS;
+        for(unsigned int segment = 0; segment <= SPHERE_SEGMENTS; segment++)
+        {
+            float theta = 2.0f * glm::pi<float>() * segment / SPHERE_SEGMENTS;
+            vertices.push_back(scale * std::sin(phi) * std::cos(theta));
+            vertices.push_back(scale * std::cos(phi));
+            vertices.push_back(scale * std::sin(phi) * std::sin(theta));
+        }
+    }
+
+    std::vector<unsigned int> indices;
+    for(unsigned int ring = 0; ring < SPHERE_RINGS; ring++)
+    {
+        for(unsigned int segment = 0; segment < SPHERE_SEGMENTS; segment++)
+        {
+            unsigned int current = ring * (SPHERE_SEGMENTS + 1) + segment;
+            unsigned int below = current + SPHERE_SEGMENTS + 1;
+
+            // Counter-clockwise when seen from outside
+            indices.insert(indices.end(), { current, current + 1, below });
+            indices.insert(indices.end(), { current + 1, below + 1, below });
+        }
+    }
+    sphereIndexCount = indices.size();
+
+    glGenVertexArrays(1, &sphereVao);
+    glGenBuffers(1, &sphereVbo);
+    glGenBuffers(1, &sphereEbo);
+    glBindVertexArray(sphereVao);
+    glBindBuffer(GL_ARRAY_BUFFER, sphereVbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+}
+
+void DeferredRenderer::beginGeometryPass(glm::vec4 clearColor)
+{
+    this->clearColor = clearColor;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, geometryFramebuffer);
+    glViewport(0, 0, width, height);
+
+    // Zero depth marks background for ambient pass
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+void DeferredRenderer::setLightUniforms(Shader &shader, const DeferredLight &light, const glm::mat4 &view)
+{
+    glm::vec3 viewPosition = glm::vec3(view * glm::vec4(light.position, 1.0f));
+    shader.setVec3("lightPosition", glm::value_ptr(viewPosition));
+    shader.setVec3("lightColor", glm::value_ptr(light.color));
+    shader.setFloat("lightRadius", light.radius);
+}
+
+bool DeferredRenderer::calculateScissor(const DeferredLight &light, const glm::mat4 &view, const glm::mat4 &projection, GLint* rectangle)
+{
+    glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+
+    // Camera inside (or too close to) sphere, light can reach any pixel
+    float nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+    if(-center.z - light.radius <= nearPlane)
+    {
+        rectangle[0] = 0;
+        rectangle[1] = 0;
+        rectangle[2] = width;
+        rectangle[3] = height;
+        return true;
+    }
+
+    // Project corners of view space box around sphere, whole box is in front of near plane here
+    glm::vec2 minimum(1.0f), maximum(-1.0f);
+    for(unsigned int i = 0; i < 8; i++)
+    {
+        glm::vec3 offset((i & 1) ? light.radius : -light.radius, (i & 2) ? light.radius : -light.radius, (i & 4) ? light.radius : -light.radius);
+        glm::vec4 clip = projection * glm::vec4(center + offset, 1.0f);
+        glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        minimum = glm::min(minimum, ndc);
+        maximum = glm::max(maximum, ndc);
+    }
+
+    minimum = glm::clamp(minimum, glm::vec2(-1.0f), glm::vec2(1.0f));
+    maximum = glm::clamp(maximum, glm::vec2(-1.0f), glm::vec2(1.0f));
+    if(minimum.x >= maximum.x || minimum.y >= maximum.y)
+        return false;
+
+    rectangle[0] = GLint(std::floor((minimum.x * 0.5f + 0.5f) * width));
+    rectangle[1] = GLint(std::floor((minimum.y * 0.5f + 0.5f) * height));
+    rectangle[2] = GLint(std::ceil((maximum.x * 0.5f + 0.5f) * width)) - rectangle[0];
+    rectangle[3] = GLint(std::ceil((maximum.y * 0.5f + 0.5f) * height)) - rectangle[1];
+    return true;
+}
+
+void DeferredRenderer::lightingPass(const std::vector<DeferredLight> &lights, const glm::mat4 &view, const glm::mat4 &projection, glm::vec3 ambient)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, lightingFramebuffer);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, normalTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, albedoSpecularTexture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // View ray of a pixel is (ndc.xy * viewRayScale, -1), multiplied by linear depth it gives view space position
+    glm::vec2 viewRayScale(1.0f / projection[0][0], 1.0f / projection[1][1]);
+    glm::vec2 screenSize(width, height);
+
+    // Ambient pass writes every pixel, so lighting target doesn't need clearing
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_BLEND);
+
+    ambientShader.use();
+    ambientShader.setVec3("ambient", glm::value_ptr(ambient));
+    ambientShader.setVec3("clearColor", glm::value_ptr(glm::vec3(clearColor)));
+    glBindVertexArray(quadVao);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    // Every light adds its contribution
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    if(lightVolumeMode == LIGHT_VOLUME_STENCIL)
+    {
+        glEnable(GL_STENCIL_TEST);
+        glEnable(GL_CULL_FACE);
+        glBindVertexArray(sphereVao);
+
+        stencilShader.use();
+        stencilShader.setMatrix4fv("view", 1, GL_FALSE, view);
+        stencilShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
+
+        volumeLightShader.use();
+        volumeLightShader.setMatrix4fv("view", 1, GL_FALSE, view);
+        volumeLightShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
+        volumeLightShader.setVec2("viewRayScale", glm::value_ptr(viewRayScale));
+        volumeLightShader.setVec2("screenSize", glm::value_ptr(screenSize));
+
+        for(const DeferredLight &light : lights)
+        {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), light.position);
+            model = glm::scale(model, glm::vec3(light.radius));
+
+            // Stencil pass: pixels whose surface is inside the volume end with a non zero count
+            // (back face behind surface increments, front face behind surface decrements)
+            stencilShader.use();
+            stencilShader.setMatrix4fv("model", 1, GL_FALSE, model);
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            glEnable(GL_DEPTH_TEST);
+            glDisable(GL_CULL_FACE);
+            glStencilFunc(GL_ALWAYS, 0, 0xFF);
+            glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+            glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+            glDrawElements(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_INT, 0);
+
+            // Lighting pass: back faces cover whole footprint even with camera inside volume,
+            // every touched pixel is reset to zero so next light starts from a clean stencil without clearing
+            volumeLightShader.use();
+            volumeLightShader.setMatrix4fv("model", 1, GL_FALSE, model);
+            setLightUniforms(volumeLightShader, light, view);
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDisable(GL_DEPTH_TEST);
+            glEnable(GL_CULL_FACE);
+            glCullFace(GL_FRONT);
+            glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+            glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+            glDrawElements(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_INT, 0);
+        }
+
+        glCullFace(GL_BACK);
+        glDisable(GL_CULL_FACE);
+        glDisable(GL_STENCIL_TEST);
+    }
+    else
+    {
+        glEnable(GL_SCISSOR_TEST);
+        glBindVertexArray(quadVao);
+
+        scissorLightShader.use();
+        scissorLightShader.setVec2("viewRayScale", glm::value_ptr(viewRayScale));
+        scissorLightShader.setVec2("screenSize", glm::value_ptr(screenSize));
+
+        for(const DeferredLight &light : lights)
+        {
+            GLint rectangle[4];
+            if(!calculateScissor(light, view, projection, rectangle))
+                continue;
+
+            glScissor(rectangle[0], rectangle[1], rectangle[2], rectangle[3]);
+            setLightUniforms(scissorLightShader, light, view);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        }
+
+        glDisable(GL_SCISSOR_TEST);
+    }
+
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "shader.h"
+
+/**
+ * @brief Struct DeferredLight describes a point light with a hard radius, lighting drops smoothly to zero at radius.
+*/
+struct DeferredLight
+{
+    glm::vec3 position;     // World space position
+    float radius;
+    glm::vec3 color;
+};
+
+/**
+ * @brief How lighting pass limits every light to pixels it can reach.
+*/
+enum LightVolumeModes
+{
+    LIGHT_VOLUME_STENCIL,   // Sphere volume marks pixels inside light with stencil, then shades only those
+    LIGHT_VOLUME_SCISSOR,   // Full-screen quad clipped to screen rectangle of light's sphere
+};
+
+/**
+ * @brief Class DeferredRenderer renders opaque geometry once into a G-buffer and then shades it light by light,
+ * so lighting cost depends on pixels covered by every light instead of on scene overdraw.
+ *
+ * G-buffer: RG16F octahedral view space normal, RGBA8 albedo (rgb) + specular intensity (a), R32F linear view depth.
+ * Lighting pass accumulates into an RGBA16F target that shares depth-stencil with G-buffer.
+ *
+ * Every frame: beginGeometryPass(), draw scene with geometry shader, lightingPass(), draw getOutputTexture().
+*/
+class DeferredRenderer
+{
+private:
+    int width, height;
+    LightVolumeModes lightVolumeMode;
+    glm::vec4 clearColor;
+
+    unsigned int geometryFramebuffer;
+    unsigned int normalTexture;
+    unsigned int albedoSpecularTexture;
+    unsigned int depthTexture;
+    unsigned int depthStencilRenderbuffer;  // Shared with lighting framebuffer for light volume stencil tests
+
+    unsigned int lightingFramebuffer;
+    unsigned int lightingTexture;
+
+    Shader ambientShader;
+    Shader stencilShader;
+    Shader volumeLightShader;
+    Shader scissorLightShader;
+
+    unsigned int quadVao, quadVbo;
+    unsigned int sphereVao, sphereVbo, sphereEbo;
+    unsigned int sphereIndexCount;
+
+    /**
+     * @brief Create texture to use as framebuffer color attachment.
+     * @param internalFormat Internal format of texture.
+     * @param format Format of pixel data.
+     * @param type Type of pixel data.
+    */
+    unsigned int createAttachment(GLint internalFormat, GLenum format, GLenum type);
+
+    /**
+     * @brief Create low poly sphere enclosing unit sphere, used as light volume.
+    */
+    void createSphere();
+
+    /**
+     * @brief Set view space light uniforms shared by both light shaders.
+    */
+    void setLightUniforms(Shader &shader, const DeferredLight &light, const glm::mat4 &view);
+
+    /**
+     * @brief Compute screen rectangle covered by light's sphere.
+     * @return False if sphere is behind camera or clipped away.
+    */
+    bool calculateScissor(const DeferredLight &light, const glm::mat4 &view, const glm::mat4 &projection, GLint* rectangle);
+
+public:
+    /**
+     * @brief Constructor to create G-buffer, lighting target and lighting shaders.
+     * @param width Width of render targets.
+     * @param height Height of render targets.
+     * @param shaderDirectory Directory with lighting shaders.
+    */
+    DeferredRenderer(int width, int height, const std::string &shaderDirectory);
+    ~DeferredRenderer();
+
+    /**
+     * @brief Bind and clear G-buffer, opaque objects should be rendered with G-buffer shader after calling this.
+     * @param clearColor Background color, written where no geometry was rendered.
+    */
+    void beginGeometryPass(glm::vec4 clearColor);
+
+    /**
+     * @brief Shade G-buffer with ambient light and every light, result is stored in getOutputTexture().
+     * @param lights Lights in world space.
+     * @param view View matrix used in geometry pass.
+     * @param projection Projection matrix used in geometry pass.
+     * @param ambient Ambient light color.
+    */
+    void lightingPass(const std::vector<DeferredLight> &lights, const glm::mat4 &view, const glm::mat4 &projection, glm::vec3 ambient);
+
+    unsigned int getOutputTexture() const { return lightingTexture; };
+
+    LightVolumeModes getLightVolumeMode() const { return lightVolumeMode; };
+    void setLightVolumeMode(LightVolumeModes lightVolumeMode) { this->lightVolumeMode = lightVolumeMode; };
+};
@@ -2,6 +2,12 @@
 #include "shader.h"
 #include "camera.h"
 #include "texture.h"
+#include "deferredRenderer.h"
+#include "gpuProfiler.h"
+#include "benchmark.h"
+
+#include <cmath>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -13,6 +19,16 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 void processMovement(GLFWwindow* window, Camera* camera);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
+// CONSTANTS
+// Lighting
+constexpr unsigned int MAX_FORWARD_LIGHTS = 64;     // Must match MAX_FORWARD_LIGHTS in forward.fs
+constexpr unsigned int LIGHT_COUNT = MAX_FORWARD_LIGHTS;
+constexpr float LIGHT_RADIUS = 2.5f;
+constexpr float SPECULAR_INTENSITY = 0.5f;
+const glm::vec3 AMBIENT_LIGHT = glm::vec3(0.1f);
+const glm::vec4 BACKGROUND_COLOR = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+constexpr float BENCHMARK_REPORT_INTERVAL = 2.0f;   // Seconds between frame time reports
+
 // Window configuration
 GLfloat width = 800.0f, height = 600.0f;
 std::string title = "Main Window";
@@ -24,6 +40,10 @@ std::string meshVShaderPath = pwd + "/../shaders/mesh.vs";
 std::string meshFShaderPath = pwd + "/../shaders/mesh.fs";
 std::string screenVShaderPath = pwd + "/../shaders/screen.vs";
 std::string screenFShaderPath = pwd + "/../shaders/screen.fs";
+std::string geometryVShaderPath = pwd + "/../shaders/geometry.vs";
+std::string gBufferFShaderPath = pwd + "/../shaders/gbuffer.fs";
+std::string forwardFShaderPath = pwd + "/../shaders/forward.fs";
+std::string shaderDirectory = pwd + "/../shaders";
 
 // Model transformation matrix
 glm::mat4 model;
@@ -42,6 +62,12 @@ bool firstMouse = true;
 float lastX = width / 2.0f;
 float lastY = height / 2.0f;
 
+// Rendering path, switch with "G" key (deferred) and "V" key (light volume mode of deferred path)
+bool useDeferred = true;
+LightVolumeModes lightVolumeMode = LIGHT_VOLUME_STENCIL;
+// GPU pass timings in frame time report, switch with "P" key
+bool useGpuProfiler = true;
+
 float cubeVertices[] = 
 {
     // Back face          // Texture coordinates
@@ -126,8 +152,19 @@ float quadVerticies[] =
 //     0.3f,  1.0f,  1.0f, 1.0f
 // };
 
-int main()
+int main(int argc, char** argv)
 {
+    // Benchmark mode renders a scripted camera path without a visible window and reports frame timings
+    BenchmarkOptions benchmarkOptions;
+    if(!Benchmark::parseArguments(argc, argv, benchmarkOptions))
+        return -1;
+    if(benchmarkOptions.enabled)
+    {
+        width = benchmarkOptions.width;
+        height = benchmarkOptions.height;
+        Benchmark::prepareContext();
+    }
+
     // Create window object
     glWindow window(title, width, height);
 
@@ -145,6 +182,8 @@ int main()
     // Build and compile shaders
     Shader meshShader(meshVShaderPath.c_str(), meshFShaderPath.c_str());
     Shader screenShader(screenVShaderPath.c_str(), screenFShaderPath.c_str());
+    Shader forwardShader(geometryVShaderPath.c_str(), forwardFShaderPath.c_str());
+    Shader gBufferShader(geometryVShaderPath.c_str(), gBufferFShaderPath.c_str());
 
     // Cube creation
     unsigned int cubeVao, cubeVbo;
@@ -194,6 +233,15 @@ int main()
     meshShader.use();
     meshShader.setInt("diffuse", 0);
 
+    forwardShader.use();
+    forwardShader.setInt("diffuse", 0);
+    forwardShader.setFloat("specularIntensity", SPECULAR_INTENSITY);
+    forwardShader.setVec3("ambient", glm::value_ptr(AMBIENT_LIGHT));
+
+    gBufferShader.use();
+    gBufferShader.setInt("diffuse", 0);
+    gBufferShader.setFloat("specularIntensity", SPECULAR_INTENSITY);
+
     screenShader.use();
     screenShader.setInt("screenTexture", 0);
 
@@ -227,16 +275,56 @@ int main()
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+    // Deferred path renders into its own G-buffer and lighting target
+    DeferredRenderer deferredRenderer(width, height, shaderDirectory);
+
+    // Lights circle above floor, each with its own speed and color
+    std::vector<DeferredLight> lights(LIGHT_COUNT);
+    std::vector<glm::vec4> forwardLightPositions(LIGHT_COUNT);
+    std::vector<glm::vec3> forwardLightColors(LIGHT_COUNT);
+    for(unsigned int i = 0; i < LIGHT_COUNT; i++)
+    {
+        float hue = float(i) / LIGHT_COUNT * 6.0f;
+        lights[i].color = glm::clamp(glm::vec3(std::abs(hue - 3.0f) - 1.0f, 2.0f - std::abs(hue - 2.0f), 2.0f - std::abs(hue - 4.0f)), glm::vec3(0.0f), glm::vec3(1.0f));
+        lights[i].radius = LIGHT_RADIUS;
+    }
+
+    // Frame time counters, reported every BENCHMARK_REPORT_INTERVAL seconds for active path
+    // GPU time of every pass, read back a few frames late so it never waits for the GPU
+    GpuProfiler gpuProfiler;
+    unsigned int benchmarkFrames = 0;
+    double benchmarkFrameTime = 0.0;
+    double benchmarkStart = glfwGetTime();
+
     // Uncomment to render models in wireframe
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    std::unique_ptr<Benchmark> benchmark;
+    if(benchmarkOptions.enabled)
+        benchmark.reset(new Benchmark(benchmarkOptions, "13-framebuffer", glm::vec3(0.0f), 5.0f));
+
     // Render loop
     // -----------
-    while (!window.isShouldClose())
+    while (!window.isShouldClose() && !(benchmark && benchmark->isDone()))
     {
+        if(benchmark)
+            benchmark->beginFrame();
+
         // Process input
         // -------------
         processMovement(window.getGlWindow(), &camera);
+        if(benchmark)
+        {
+            // Scripted camera replaces mouse and keyboard
+            BenchmarkCameraPose pose = benchmark->cameraPose();
+            camera.setPosition(pose.position);
+            camera.setYaw(pose.yaw);
+            camera.setPitch(pose.pitch);
+            camera.processMouseMovement(0.0f, 0.0f);
+        }
+
+        gpuProfiler.setEnabled(useGpuProfiler);
+        gpuProfiler.beginFrame();
 
         glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
 
@@ -293,43 +381,115 @@ int main()
         // Comment this line if using rear-view code
         projection = glm::perspective(camera.getFov(), width / height, 0.1f, 100.0f);
 
-        meshShader.use();
-        meshShader.setMatrix4fv("view", 1, GL_FALSE, view);
-        meshShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
-
-        glBindVertexArray(cubeVao);
-        woodContainer.useTexture();
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-1.0f, 0.0f, -1.0f));
-        meshShader.setMatrix4fv("model", 1, GL_FALSE, model);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model ,glm::vec3(2.0f, 0.0f, 0.0f));
-        meshShader.setMatrix4fv("model", 1, GL_FALSE, model);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        glBindVertexArray(floorVao);
-        smileyFace.useTexture();
-        model = glm::mat4(1.0f);
-        meshShader.setMatrix4fv("model", 1, GL_FALSE, model);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        // Animate lights
+        // ----------------------------------------------
+        float time = glfwGetTime();
+        for(unsigned int i = 0; i < LIGHT_COUNT; i++)
+        {
+            float angle = time * (0.2f + 0.05f * (i % 7)) + i * 2.399963f;
+            float distance = 0.5f + 4.0f * float(i) / LIGHT_COUNT;
+            lights[i].position = glm::vec3(std::cos(angle) * distance, -0.2f + 0.3f * std::sin(time + i), std::sin(angle) * distance);
+        }
 
-        glBindVertexArray(0);
+        // Scene is shared by both paths, only shader differs
+        auto drawScene = [&](Shader &shader)
+        {
+            shader.use();
+            shader.setMatrix4fv("view", 1, GL_FALSE, view);
+            shader.setMatrix4fv("projection", 1, GL_FALSE, projection);
+
+            glBindVertexArray(cubeVao);
+            woodContainer.useTexture();
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(-1.0f, 0.0f, -1.0f));
+            shader.setMatrix4fv("model", 1, GL_FALSE, model);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+
+            model = glm::mat4(1.0f);
+            model = glm::translate(model ,glm::vec3(2.0f, 0.0f, 0.0f));
+            shader.setMatrix4fv("model", 1, GL_FALSE, model);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+
+            glBindVertexArray(floorVao);
+            smileyFace.useTexture();
+            model = glm::mat4(1.0f);
+            shader.setMatrix4fv("model", 1, GL_FALSE, model);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+
+            glBindVertexArray(0);
+        };
+
+        unsigned int outputTexture = textureColorBuffer;
+        if(useDeferred)
+        {
+            // Deferred: geometry once into G-buffer, then every light shades only pixels inside its volume
+            deferredRenderer.setLightVolumeMode(lightVolumeMode);
+            {
+                GpuScope scope(gpuProfiler, "geometry");
+                deferredRenderer.beginGeometryPass(BACKGROUND_COLOR);
+                drawScene(gBufferShader);
+            }
+            {
+                GpuScope scope(gpuProfiler, "lighting");
+                deferredRenderer.lightingPass(lights, view, projection, AMBIENT_LIGHT);
+            }
+            outputTexture = deferredRenderer.getOutputTexture();
+        }
+        else
+        {
+            // Forward: every rasterized fragment loops over all lights
+            for(unsigned int i = 0; i < LIGHT_COUNT; i++)
+            {
+                forwardLightPositions[i] = glm::vec4(glm::vec3(view * glm::vec4(lights[i].position, 1.0f)), lights[i].radius);
+                forwardLightColors[i] = lights[i].color;
+            }
+
+            forwardShader.use();
+            glUniform4fv(glGetUniformLocation(forwardShader.getID(), "lightPositions"), LIGHT_COUNT, glm::value_ptr(forwardLightPositions[0]));
+            glUniform3fv(glGetUniformLocation(forwardShader.getID(), "lightColors"), LIGHT_COUNT, glm::value_ptr(forwardLightColors[0]));
+            forwardShader.setInt("lightCount", LIGHT_COUNT);
+            GpuScope scope(gpuProfiler, "forward");
+            drawScene(forwardShader);
+        }
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
         Shader::disableGL(GL_DEPTH_TEST);
 
-        screenShader.use();
-        glBindVertexArray(quadVao);
-        glBindTexture(GL_TEXTURE_2D, textureColorBuffer);
-        glDrawArrays(GL_TRIANGLES, 0, 6);        
+        {
+            GpuScope scope(gpuProfiler, "composite");
+            screenShader.use();
+            glBindVertexArray(quadVao);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, outputTexture);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        }
+
+        // Frame time report for active path
+        // ----------------------------------------------
+        benchmarkFrames++;
+        benchmarkFrameTime += deltaTime;
+        if(!benchmark && glfwGetTime() - benchmarkStart >= BENCHMARK_REPORT_INTERVAL)
+        {
+            std::cout << (useDeferred ? (lightVolumeMode == LIGHT_VOLUME_STENCIL ? "Deferred (stencil volumes)" : "Deferred (scissor)") : "Forward") << " | "
+                      << LIGHT_COUNT << " lights | frame " << benchmarkFrameTime * 1000.0 / benchmarkFrames << " ms" << std::endl;
+            if(useGpuProfiler)
+                gpuProfiler.report(std::cout);
+            benchmarkFrames = 0;
+            benchmarkFrameTime = 0.0;
+            benchmarkStart = glfwGetTime();
+        }
 
-        window.swapBuffers();
+        if(benchmark)
+            benchmark->endFrame();
+        else
+            window.swapBuffers();
         glfwPollEvents();
     }
 
+    if(benchmark)
+        benchmark->finish();
+
     glfwTerminate();
     return 0;
 }
@@ -406,6 +566,27 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         }
     }
 
+    // If user presses "G" key - switch between forward and deferred shading
+    if(key == GLFW_KEY_G && action == GLFW_PRESS)
+    {
+        useDeferred = !useDeferred;
+        std::cout << "Shading path: " << (useDeferred ? "deferred" : "forward") << std::endl;
+    }
+
+    // If user presses "V" key - switch deferred light volumes between stencil masking and scissor rectangles
+    if(key == GLFW_KEY_V && action == GLFW_PRESS)
+    {
+        lightVolumeMode = lightVolumeMode == LIGHT_VOLUME_STENCIL ? LIGHT_VOLUME_SCISSOR : LIGHT_VOLUME_STENCIL;
+        std::cout << "Deferred light volumes: " << (lightVolumeMode == LIGHT_VOLUME_STENCIL ? "stencil" : "scissor") << std::endl;
+    }
+
+    // If user presses "P" key - switch GPU pass timings on and off
+    if(key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        useGpuProfiler = !useGpuProfiler;
+        std::cout << "GPU profiler: " << (useGpuProfiler ? "on" : "off") << std::endl;
+    }
+
     // If user presses ESC key button - exit program
     if(key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         exit(0);
@@ -0,0 +1,23 @@
+#version 330 core
+
+out vec4 fragColor;
+
+in vec2 texCoords;
+
+uniform sampler2D gAlbedoSpecular;
+uniform sampler2D gDepth;
+
+uniform vec3 ambient;
+uniform vec3 clearColor;
+
+void main()
+{
+    // Nothing was rendered here
+    if(texture(gDepth, texCoords).r == 0.0)
+    {
+        fragColor = vec4(clearColor, 1.0);
+        return;
+    }
+
+    fragColor = vec4(ambient * texture(gAlbedoSpecular, texCoords).rgb, 1.0);
+}
@@ -0,0 +1,57 @@
+#version 330 core
+
+#define SHININESS 32.0
+
+out vec4 fragColor;
+
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpecular;
+uniform sampler2D gDepth;
+
+uniform vec2 screenSize;
+uniform vec2 viewRayScale;
+
+// View space light
+uniform vec3 lightPosition;
+uniform vec3 lightColor;
+uniform float lightRadius;
+
+vec3 decodeNormal(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = clamp(-normal.z, 0.0, 1.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.y += normal.y >= 0.0 ? -fold : fold;
+
+    return normalize(normal);
+}
+
+void main()
+{
+    // Same pixel is read back for volume and scissor passes, so G-buffer is addressed by fragment position
+    vec2 uv = gl_FragCoord.xy / screenSize;
+
+    float depth = texture(gDepth, uv).r;
+    if(depth == 0.0)
+        discard;
+
+    vec3 position = vec3((uv * 2.0 - 1.0) * viewRayScale, -1.0) * depth;
+    vec3 normal = decodeNormal(texture(gNormal, uv).rg);
+    vec4 albedoSpecular = texture(gAlbedoSpecular, uv);
+
+    vec3 toLight = lightPosition - position;
+    float distance = length(toLight);
+    if(distance >= lightRadius)
+        discard;
+
+    // Smooth falloff that reaches zero exactly at radius
+    float falloff = clamp(1.0 - (distance * distance) / (lightRadius * lightRadius), 0.0, 1.0);
+    falloff *= falloff;
+
+    vec3 lightDirection = toLight / distance;
+    vec3 halfway = normalize(lightDirection + normalize(-position));
+    float diff = max(dot(normal, lightDirection), 0.0);
+    float spec = pow(max(dot(normal, halfway), 0.0), SHININESS) * albedoSpecular.a;
+
+    fragColor = vec4((albedoSpecular.rgb * diff + spec) * lightColor * falloff, 1.0);
+}
@@ -0,0 +1,49 @@
+#version 330 core
+
+#define SHININESS 32.0
+// Must match MAX_FORWARD_LIGHTS in main.cpp
+#define MAX_FORWARD_LIGHTS 64
+
+out vec4 fragColor;
+
+in vec2 texCoords;
+in vec3 viewPosition;
+
+uniform sampler2D diffuse;
+uniform float specularIntensity;
+uniform vec3 ambient;
+
+// View space lights, xyz: position, w: radius
+uniform vec4 lightPositions[MAX_FORWARD_LIGHTS];
+uniform vec3 lightColors[MAX_FORWARD_LIGHTS];
+uniform int lightCount;
+
+void main()
+{
+    vec3 normal = normalize(cross(dFdx(viewPosition), dFdy(viewPosition)));
+    vec3 albedo = texture(diffuse, texCoords).rgb;
+    vec3 viewDirection = normalize(-viewPosition);
+
+    // Every fragment loops over every light, including fragments later hidden by closer geometry
+    vec3 result = ambient * albedo;
+    for(int i = 0; i < lightCount; i++)
+    {
+        vec3 toLight = lightPositions[i].xyz - viewPosition;
+        float distance = length(toLight);
+        float radius = lightPositions[i].w;
+        if(distance >= radius)
+            continue;
+
+        float falloff = clamp(1.0 - (distance * distance) / (radius * radius), 0.0, 1.0);
+        falloff *= falloff;
+
+        vec3 lightDirection = toLight / distance;
+        vec3 halfway = normalize(lightDirection + viewDirection);
+        float diff = max(dot(normal, lightDirection), 0.0);
+        float spec = pow(max(dot(normal, halfway), 0.0), SHININESS) * specularIntensity;
+
+        result += (albedo * diff + spec) * lightColors[i] * falloff;
+    }
+
+    fragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,32 @@
+#version 330 core
+
+layout (location = 0) out vec2 gNormal;
+layout (location = 1) out vec4 gAlbedoSpecular;
+layout (location = 2) out float gDepth;
+
+in vec2 texCoords;
+in vec3 viewPosition;
+
+uniform sampler2D diffuse;
+uniform float specularIntensity;
+
+// Octahedral encoding, unit normal folded onto a square so it fits 2 channels without losing precision near poles
+vec2 encodeNormal(vec3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    if(normal.z < 0.0)
+        normal.xy = (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+
+    return normal.xy;
+}
+
+void main()
+{
+    // Scene meshes only have positions and texture coordinates, flat normal comes from screen space derivatives
+    vec3 normal = normalize(cross(dFdx(viewPosition), dFdy(viewPosition)));
+
+    gNormal = encodeNormal(normal);
+    gAlbedoSpecular = vec4(texture(diffuse, texCoords).rgb, specularIntensity);
+    // Linear depth, 0 is left for background
+    gDepth = -viewPosition.z;
+}
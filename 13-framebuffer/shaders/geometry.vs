@@ -0,0 +1,22 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoords;
+
+out vec2 texCoords;
+out vec3 viewPosition;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    texCoords = aTexCoords;
+
+    // Lighting is done in view space, so camera is always at origin
+    vec4 position = view * model * vec4(aPos, 1.0);
+    viewPosition = position.xyz;
+
+    gl_Position = projection * position;
+}
@@ -0,0 +1,7 @@
+#version 330 core
+
+// Stencil pass only writes stencil, color writes are masked
+void main()
+{
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+constexpr unsigned int GPU_PROFILER_LATENCY = 4;        // Frames between issuing queries and reading them, GPU is never waited for
+constexpr unsigned int GPU_PROFILER_HISTORY = 240;      // Samples per scope statistics are computed over
+
+/**
+ * @brief Struct GpuScopeStats stores rolling statistics of one scope in milliseconds.
+*/
+struct GpuScopeStats
+{
+    float min = 0.0f;
+    float average = 0.0f;
+    float p99 = 0.0f;
+    unsigned int samples = 0;
+};
+
+/**
+ * @brief Class GpuProfiler measures GPU time of named passes with timestamp queries.
+ *
+ * Every scope writes a GL_TIMESTAMP at its start and end. Timestamps nest, unlike GL_TIME_ELAPSED, so a pass can be
+ * measured as a whole and in parts. Queries of a frame are read GPU_PROFILER_LATENCY frames later in beginFrame(), by
+ * then the GPU finished them; a result that still isn't available is dropped instead of stalling.
+*/
+class GpuProfiler
+{
+private:
+    struct Scope
+    {
+        std::string name;
+        GLuint queries[GPU_PROFILER_LATENCY][2];        // Start and end timestamp per frame slot
+        bool issued[GPU_PROFILER_LATENCY];
+        std::vector<float> history;                     // Ring of GPU_PROFILER_HISTORY samples in milliseconds
+        unsigned int nextSample;
+    };
+
+    std::vector<Scope> scopes;
+    std::unordered_map<std::string, unsigned int> scopeIndices;
+    unsigned long frame;
+    bool enabled;
+
+    void collect(Scope &scope, unsigned int slot);
+
+public:
+    GpuProfiler();
+    ~GpuProfiler();
+    GpuProfiler(const GpuProfiler &) = delete;
+    GpuProfiler& operator=(const GpuProfiler &) = delete;
+
+    /**
+     * @brief Read back results of the frame GPU_PROFILER_LATENCY frames ago, call once at the start of each frame.
+    */
+    void beginFrame();
+
+    /**
+     * @brief Write start timestamp of scope, prefer GpuScope over calling this directly.
+     * @return Scope index for end(), each scope is measured once per frame.
+    */
+    int begin(const std::string &name);
+    void end(int scope);
+
+    /**
+     * @brief Statistics over the last GPU_PROFILER_HISTORY samples, all zero for unknown scopes.
+    */
+    GpuScopeStats getStats(const std::string &name) const;
+
+    /**
+     * @brief Print min/avg/p99 of every scope, one line each.
+    */
+    void report(std::ostream &stream) const;
+
+    void setEnabled(bool enabled) { this->enabled = enabled; };
+    bool isEnabled() const { return enabled; };
+};
+
+/**
+ * @brief Class GpuScope measures the GPU time of the commands issued during its lifetime.
+*/
+class GpuScope
+{
+private:
+    GpuProfiler &profiler;
+    int scope;
+
+public:
+    GpuScope(GpuProfiler &profiler, const std::string &name) : profiler(profiler), scope(profiler.begin(name)) {}
+    ~GpuScope() { profiler.end(scope); }
+    GpuScope(const GpuScope &) = delete;
+    GpuScope& operator=(const GpuScope &) = delete;
+};
@@ -3,6 +3,8 @@
 #include "camera.h"
 #include "texture.h"
 #include "cubemap.h"
+#include "gpuProfiler.h"
+#include "benchmark.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -16,6 +18,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 void processMovement(GLFWwindow* window, Camera* camera);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
+// CONSTANTS
+constexpr float PROFILER_REPORT_INTERVAL = 2.0f;    // Seconds between GPU timing reports
+
 // Window configuration
 GLfloat width = 800.0f, height = 600.0f;
 std::string title = "Main Window";
@@ -29,6 +34,9 @@ glm::mat4 view;
 // Projection transformation matrix
 glm::mat4 projection;
 
+// GPU pass timings, switch reports with "P" key
+bool useGpuProfiler = false;
+
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
@@ -135,8 +143,19 @@ std::vector<std::string> faces =
     pwd + "/../../assets/skybox/back.jpg"
 };
 
-int main()
+int main(int argc, char** argv)
 {
+    // Benchmark mode renders a scripted camera path without a visible window and reports frame timings
+    BenchmarkOptions benchmarkOptions;
+    if(!Benchmark::parseArguments(argc, argv, benchmarkOptions))
+        return -1;
+    if(benchmarkOptions.enabled)
+    {
+        width = benchmarkOptions.width;
+        height = benchmarkOptions.height;
+        Benchmark::prepareContext();
+    }
+
     // Create window object
     glWindow window(title, width, height);
 
@@ -189,51 +208,95 @@ int main()
     // Uncomment to render models in wireframe
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    // GPU time of cube and skybox, read back a few frames late so it never waits for the GPU
+    GpuProfiler gpuProfiler;
+    double profilerReportStart = glfwGetTime();
+
+    std::unique_ptr<Benchmark> benchmark;
+    if(benchmarkOptions.enabled)
+        benchmark.reset(new Benchmark(benchmarkOptions, "14-cubemaps", glm::vec3(0.0f), 3.0f));
+
     // Render loop
     // -----------
-    while (!window.isShouldClose())
+    while (!window.isShouldClose() && !(benchmark && benchmark->isDone()))
     {
+        if(benchmark)
+            benchmark->beginFrame();
+
         // Process input
         // -------------
         processMovement(window.getGlWindow(), &camera);
+        if(benchmark)
+        {
+            // Scripted camera replaces mouse and keyboard
+            BenchmarkCameraPose pose = benchmark->cameraPose();
+            camera.setPosition(pose.position);
+            camera.setYaw(pose.yaw);
+            camera.setPitch(pose.pitch);
+            camera.processMouseMovement(0.0f, 0.0f);
+        }
+
+        gpuProfiler.setEnabled(useGpuProfiler);
+        gpuProfiler.beginFrame();
 
         // Clearing framebuffer
         // ------------------------------------------------------------
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        shader.use();
-        model = glm::mat4(1.0f);
         view = camera.calculateLookAtMatrix(camera.getPosition(), camera.getPosition() + camera.getFront());
         projection = glm::perspective(camera.getFov(), width / height, 0.1f, 100.0f);
-        shader.setMatrix4fv("model", 1, GL_FALSE, model);
-        shader.setMatrix4fv("view", 1, GL_FALSE, view);
-        shader.setMatrix4fv("projection", 1, GL_FALSE, projection);
-        shader.setVec3("cameraPosition", glm::value_ptr(camera.getPosition()));
-
-        glBindVertexArray(cubeVao);
-        container.useTexture();
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
-
-        Shader::depthFunctionality(GL_LEQUAL);
-        skyboxShader.use();
-        // Converting "view" matrix to 3x3 matrix and back to 4x4 matrix to update only rotation in skybox
-        view = glm::mat4(glm::mat3(camera.calculateLookAtMatrix(camera.getPosition(), camera.getPosition() + camera.getFront())));
-        skyboxShader.setMatrix4fv("view", 1, GL_FALSE, view);
-        skyboxShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
-
-        glBindVertexArray(skyboxVao);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, skybox.getTextureId());
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
-        Shader::depthFunctionality(GL_LESS);
-
-        window.swapBuffers();
+
+        {
+            GpuScope scope(gpuProfiler, "cube");
+            shader.use();
+            model = glm::mat4(1.0f);
+            shader.setMatrix4fv("model", 1, GL_FALSE, model);
+            shader.setMatrix4fv("view", 1, GL_FALSE, view);
+            shader.setMatrix4fv("projection", 1, GL_FALSE, projection);
+            shader.setVec3("cameraPosition", glm::value_ptr(camera.getPosition()));
+
+            glBindVertexArray(cubeVao);
+            container.useTexture();
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glBindVertexArray(0);
+        }
+
+        {
+            GpuScope scope(gpuProfiler, "skybox");
+            Shader::depthFunctionality(GL_LEQUAL);
+            skyboxShader.use();
+            // Converting "view" matrix to 3x3 matrix and back to 4x4 matrix to update only rotation in skybox
+            view = glm::mat4(glm::mat3(camera.calculateLookAtMatrix(camera.getPosition(), camera.getPosition() + camera.getFront())));
+            skyboxShader.setMatrix4fv("view", 1, GL_FALSE, view);
+            skyboxShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
+
+            glBindVertexArray(skyboxVao);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, skybox.getTextureId());
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glBindVertexArray(0);
+            Shader::depthFunctionality(GL_LESS);
+        }
+
+        // GPU timing report
+        // -----------------
+        if(useGpuProfiler && glfwGetTime() - profilerReportStart >= PROFILER_REPORT_INTERVAL)
+        {
+            gpuProfiler.report(std::cout);
+            profilerReportStart = glfwGetTime();
+        }
+
+        if(benchmark)
+            benchmark->endFrame();
+        else
+            window.swapBuffers();
         glfwPollEvents();
     }
 
+    if(benchmark)
+        benchmark->finish();
+
     glfwTerminate();
     return 0;
 }
@@ -310,6 +373,13 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         }
     }
 
+    // If user presses "P" key - switch GPU pass timing reports on and off
+    if(key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        useGpuProfiler = !useGpuProfiler;
+        std::cout << "GPU profiler: " << (useGpuProfiler ? "on" : "off") << std::endl;
+    }
+
     // If user presses ESC key button - exit program
     if(key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         exit(0);
@@ -1,6 +1,8 @@
 #include "glWindow.h"
 #include "shader.h"
 #include "camera.h"
+#include "uniformData.h"
+#include "benchmark.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -35,6 +37,9 @@ bool firstMouse = true;
 float lastX = width / 2.0f;
 float lastY = height / 2.0f;
 
+// Bytes streamed per frame through uniform ring buffer
+constexpr GLsizeiptr UNIFORM_RING_FRAME_SIZE = 64 * 1024;
+
 float points[] = 
 {
     -2.0f,  2.0f, 0.0f,   // Top left
@@ -42,8 +47,19 @@ float points[] =
      2.0f,  2.0f, 0.0f,   // Top right 
 };
 
-int main()
+int main(int argc, char** argv)
 {
+    // Benchmark mode renders a scripted camera path without a visible window and reports frame timings
+    BenchmarkOptions benchmarkOptions;
+    if(!Benchmark::parseArguments(argc, argv, benchmarkOptions))
+        return -1;
+    if(benchmarkOptions.enabled)
+    {
+        width = benchmarkOptions.width;
+        height = benchmarkOptions.height;
+        Benchmark::prepareContext();
+    }
+
     // Create window object
     glWindow window(title, width, height);
 
@@ -74,24 +90,35 @@ int main()
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 
-    // Uniform buffer creation
-    unsigned int uboMatrices;
-    glGenBuffers(1, &uboMatrices);
-    glBindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
-    glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), nullptr, GL_STATIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-    glBindBufferRange(GL_UNIFORM_BUFFER, 0, uboMatrices, 0, 2 * sizeof(glm::mat4));
+    // Uniform blocks are streamed through a ring buffer, camera and frame data are uploaded once per frame for all programs
+    UniformBlockManager uniformBlocks(UNIFORM_RING_FRAME_SIZE);
 
     // Uncomment to render models in wireframe
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    std::unique_ptr<Benchmark> benchmark;
+    if(benchmarkOptions.enabled)
+        benchmark.reset(new Benchmark(benchmarkOptions, "15-advanced-glsl", glm::vec3(0.0f, -1.0f, 0.0f), 6.0f));
+
     // Render loop
     // -----------
-    while (!window.isShouldClose())
+    while (!window.isShouldClose() && !(benchmark && benchmark->isDone()))
     {
+        if(benchmark)
+            benchmark->beginFrame();
+
         // Process input
         // -------------
         processMovement(window.getGlWindow(), &camera);
+        if(benchmark)
+        {
+            // Scripted camera replaces mouse and keyboard
+            BenchmarkCameraPose pose = benchmark->cameraPose();
+            camera.setPosition(pose.position);
+            camera.setYaw(pose.yaw);
+            camera.setPitch(pose.pitch);
+            camera.processMouseMovement(0.0f, 0.0f);
+        }
 
         // Clearing framebuffer
         // ------------------------------------------------------------
@@ -103,48 +130,59 @@ int main()
         // Calculating view and projection matrices
         view = camera.calculateLookAtMatrix(camera.getPosition(), camera.getPosition() + camera.getFront());
         projection = glm::perspective(camera.getFov(), width / height, 0.1f, 100.0f);
-        // Binding uniform buffer to make changes
-        glBindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
-        // Inserting view matrix to uniform block at offset 0 with size of glm::mat4 (matrix 4x4)
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(view));
-        // Inserting projection matrix to uniform block at offset sizeof(glm::mat4) with size of glm::mat4
-        glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(projection));
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, 2.0f, 0.0f));
-        shaderRed.use();
-        shaderRed.setMatrix4fv("model", 1, GL_FALSE, model);
-        shaderRed.setVec3("color", glm::value_ptr(glm::vec3(1.0f, 0.0f, 0.0f)));
+        // Write all of this frame's uniform data first
+        uniformBlocks.beginFrame();
+
+        CameraData cameraData;
+        cameraData.view = view;
+        cameraData.projection = projection;
+        uniformBlocks.setShared(cameraData);
+
+        FrameData frameData;
+        frameData.resolution = glm::vec2(width, height);
+        frameData.time = glfwGetTime();
+        frameData.deltaTime = deltaTime;
+        uniformBlocks.setShared(frameData);
+
+        // Every row of points has its own shader, offset and color
+        Shader* shaders[] = { &shaderRed, &shaderGreen, &shaderBlue, &shaderYellow };
+        const glm::vec3 offsets[] = { glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, -2.0f, 0.0f), glm::vec3(0.0f, -4.0f, 0.0f) };
+        const glm::vec4 colors[] = { glm::vec4(1.0f, 0.0f, 0.0f, 1.0f), glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), glm::vec4(0.0f, 1.0f, 1.0f, 1.0f) };
+
+        RingAllocation objectAllocations[4];
+        for(unsigned int i = 0; i < 4; i++)
+        {
+            ObjectData objectData;
+            objectData.model = glm::translate(glm::mat4(1.0f), offsets[i]);
+            objectData.color = colors[i];
+            objectAllocations[i] = uniformBlocks.write(objectData);
+        }
+
+        // Shared blocks get bound here, then only per-object offsets are bound while drawing
+        uniformBlocks.flush();
         glBindVertexArray(pointsVao);
-        glDrawArrays(GL_POINTS, 0, 3);
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-        shaderGreen.use();
-        shaderGreen.setMatrix4fv("model", 1, GL_FALSE, model);
-        shaderGreen.setVec3("color", glm::value_ptr(glm::vec3(0.0f, 1.0f, 0.0f)));
-        glDrawArrays(GL_POINTS, 0, 3);
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, -2.0f, 0.0f));
-        shaderBlue.use();
-        shaderBlue.setMatrix4fv("model", 1, GL_FALSE, model);
-        shaderBlue.setVec3("color", glm::value_ptr(glm::vec3(0.0f, 0.0f, 1.0f)));
-        glDrawArrays(GL_POINTS, 0, 3);
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, -4.0f, 0.0f));
-        shaderYellow.use();
-        shaderYellow.setMatrix4fv("model", 1, GL_FALSE, model);
-        shaderYellow.setVec3("color", glm::value_ptr(glm::vec3(0.0f, 1.0f, 1.0f)));
-        glDrawArrays(GL_POINTS, 0, 3);
-        
+        for(unsigned int i = 0; i < 4; i++)
+        {
+            shaders[i]->use();
+            uniformBlocks.bind<ObjectData>(objectAllocations[i]);
+            glDrawArrays(GL_POINTS, 0, 3);
+        }
+
         glBindVertexArray(0);
+
+        // Fence this frame's region of ring buffer
+        uniformBlocks.endFrame();
         
-        window.swapBuffers();
+        if(benchmark)
+            benchmark->endFrame();
+        else
+            window.swapBuffers();
         glfwPollEvents();
     }
 
+    if(benchmark)
+        benchmark->finish();
+
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,134 @@
+#include "ringBuffer.h"
+
+#include <cstring>
+
+// Timeout of a single fence wait, we keep waiting until GPU is done anyway
+constexpr GLuint64 FENCE_TIMEOUT = 1000000;    // 1ms in nanoseconds
+
+RingBuffer::RingBuffer(GLenum target, GLsizeiptr frameSize, GLint offsetAlignment)
+{
+    this->target = target;
+    frameIndex = 0;
+    head = 0;
+    mappedData = nullptr;
+    for(unsigned int i = 0; i < RING_BUFFER_FRAMES; i++)
+        fences[i] = 0;
+
+    if(offsetAlignment == 0)
+    {
+        offsetAlignment = 16;
+        if(target == GL_UNIFORM_BUFFER)
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    }
+    this->offsetAlignment = offsetAlignment;
+
+    // Round frame size up so every region starts aligned
+    this->frameSize = (frameSize + offsetAlignment - 1) / offsetAlignment * offsetAlignment;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+
+    persistent = GLEW_ARB_buffer_storage;
+    if(persistent)
+    {
+        // Immutable storage mapped once for the whole lifetime of buffer
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, this->frameSize * RING_BUFFER_FRAMES, nullptr, flags);
+        mappedData = static_cast<unsigned char*>(glMapBufferRange(target, 0, this->frameSize * RING_BUFFER_FRAMES, flags));
+        if(!mappedData)
+        {
+            std::cerr << "ERROR::RingBuffer::can't map buffer persistently, falling back to orphaning" << std::endl;
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(target, buffer);
+            persistent = false;
+        }
+    }
+
+    if(!persistent)
+    {
+        glBufferData(target, this->frameSize, nullptr, GL_STREAM_DRAW);
+        stagingData.resize(this->frameSize);
+    }
+
+    glBindBuffer(target, 0);
+}
+
+RingBuffer::~RingBuffer()
+{
+    for(unsigned int i = 0; i < RING_BUFFER_FRAMES; i++)
+    {
+        if(fences[i])
+            glDeleteSync(fences[i]);
+    }
+
+    if(persistent)
+    {
+        glBindBuffer(target, buffer);
+        glUnmapBuffer(target);
+        glBindBuffer(target, 0);
+    }
+    glDeleteBuffers(1, &buffer);
+}
+
+void RingBuffer::beginFrame()
+{
+    head = 0;
+
+    if(!persistent || !fences[frameIndex])
+        return;
+
+    // Wait until GPU finished reading this region, normally it already did RING_BUFFER_FRAMES - 1 frames ago
+    GLenum result = glClientWaitSync(fences[frameIndex], 0, 0);
+    while(result == GL_TIMEOUT_EXPIRED)
+        result = glClientWaitSync(fences[frameIndex], GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+
+    glDeleteSync(fences[frameIndex]);
+    fences[frameIndex] = 0;
+}
+
+RingAllocation RingBuffer::allocate(GLsizeiptr size)
+{
+    GLsizeiptr start = (head + offsetAlignment - 1) / offsetAlignment * offsetAlignment;
+    if(start + size > frameSize)
+    {
+        std::cerr << "ERROR::RingBuffer::allocate()::out of memory for this frame (" << frameSize << " bytes)" << std::endl;
+        return { nullptr, 0, 0 };
+    }
+    head = start + size;
+
+    if(persistent)
+    {
+        GLintptr offset = frameIndex * frameSize + start;
+        return { mappedData + offset, offset, size };
+    }
+
+    return { stagingData.data() + start, start, size };
+}
+
+void RingBuffer::flush()
+{
+    // Persistent mapping is coherent, writes are already visible to the GPU
+    if(persistent || head == 0)
+        return;
+
+    // Orphan buffer so driver hands us fresh storage instead of waiting for GPU, then upload frame in one call
+    glBindBuffer(target, buffer);
+    glBufferData(target, frameSize, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(target, 0, head, stagingData.data());
+    glBindBuffer(target, 0);
+}
+
+void RingBuffer::bindRange(GLuint index, const RingAllocation &allocation)
+{
+    glBindBufferRange(target, index, buffer, allocation.offset, allocation.size);
+}
+
+void RingBuffer::endFrame()
+{
+    if(persistent)
+    {
+        fences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        frameIndex = (frameIndex + 1) % RING_BUFFER_FRAMES;
+    }
+}
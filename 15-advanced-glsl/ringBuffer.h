@@ -0,0 +1,87 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+// Number of frames the CPU can write ahead of the GPU (triple buffering)
+constexpr unsigned int RING_BUFFER_FRAMES = 3;
+
+/**
+ * @brief Struct RingAllocation describes a block of memory handed out by RingBuffer for the current frame.
+*/
+struct RingAllocation
+{
+    void* data;             // Pointer to write data into (mapped GPU memory or staging memory)
+    GLintptr offset;        // Offset of block inside GL buffer, used when binding
+    GLsizeiptr size;        // Size of block in bytes
+};
+
+/**
+ * @brief Class RingBuffer streams per-frame dynamic data (uniforms, instances, vertices) to the GPU.
+ * With GL_ARB_buffer_storage the buffer is persistently mapped and split into RING_BUFFER_FRAMES regions,
+ * a fence guards every region so the CPU never overwrites data the GPU is still reading, and no driver copies happen.
+ * Without it (plain GL 3.3) writes go to a staging area and flush() orphans the buffer and uploads them in one call.
+ *
+ * Every frame: beginFrame(), allocate() and write all data, flush(), bind ranges and draw, endFrame().
+*/
+class RingBuffer
+{
+private:
+    GLuint buffer;
+    GLenum target;
+    GLsizeiptr frameSize;           // Bytes available to every frame
+    GLint offsetAlignment;          // Alignment of every allocation (e.g. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT)
+    bool persistent;                // Whether buffer is persistently mapped
+
+    unsigned int frameIndex;        // Region used by current frame
+    GLsizeiptr head;                // Bytes used in current frame
+
+    unsigned char* mappedData;      // Persistently mapped memory of all regions
+    GLsync fences[RING_BUFFER_FRAMES];
+
+    std::vector<unsigned char> stagingData;    // Fallback staging memory for a single frame
+
+public:
+    /**
+     * @brief Constructor to create ring buffer.
+     * @param target Buffer target (GL_UNIFORM_BUFFER, GL_ARRAY_BUFFER, etc.).
+     * @param frameSize Maximum number of bytes written per frame.
+     * @param offsetAlignment Alignment of allocations, 0 queries GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for uniform buffers and uses 16 otherwise.
+    */
+    RingBuffer(GLenum target, GLsizeiptr frameSize, GLint offsetAlignment = 0);
+    ~RingBuffer();
+
+    /**
+     * @brief Start writing a new frame, waits only if the GPU is still reading the region from RING_BUFFER_FRAMES frames ago.
+    */
+    void beginFrame();
+
+    /**
+     * @brief Allocate memory for current frame.
+     * @param size Number of bytes to allocate.
+    */
+    RingAllocation allocate(GLsizeiptr size);
+
+    /**
+     * @brief Make everything written this frame visible to the GPU, must be called before drawing with allocations.
+    */
+    void flush();
+
+    /**
+     * @brief Bind allocation to an indexed binding point (uniform buffer binding, etc.).
+     * @param index Binding point.
+     * @param allocation Allocation to bind.
+    */
+    void bindRange(GLuint index, const RingAllocation &allocation);
+
+    /**
+     * @brief Finish current frame, fences its region so it can be reused safely.
+    */
+    void endFrame();
+
+    GLuint getBuffer() const { return buffer; };
+    bool isPersistent() const { return persistent; };
+};
@@ -1,4 +1,5 @@
 #include "shader.h"
+#include "uniformBlock.h"
 
 Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
 {
@@ -58,6 +59,9 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geo
     glLinkProgram(ID);
     checkCompileErrors(ID, GL_PROGRAM);
 
+    // Bind every uniform block this program uses to its fixed binding point
+    UniformBlockRegistry::bindProgram(ID);
+
     glDeleteShader(vShader);
     glDeleteShader(fShader);
     if(geometryPath != nullptr)
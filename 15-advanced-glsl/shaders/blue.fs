@@ -2,9 +2,13 @@
 
 out vec4 fragColor;
 
-uniform vec3 color;
+layout (std140) uniform Object
+{
+    uniform mat4 model;
+    uniform vec4 color;
+};
 
 void main()
 {
-    fragColor = vec4(color, 1.0);
+    fragColor = vec4(color.rgb, 1.0);
 }
\ No newline at end of file
@@ -2,12 +2,16 @@
 
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 model;
-layout (std140, binding = 0) uniform Matrices
+layout (std140) uniform Matrices
 {
     uniform mat4 view;
     uniform mat4 projection;
 };
+layout (std140) uniform Object
+{
+    uniform mat4 model;
+    uniform vec4 color;
+};
 
 void main()
 {
@@ -0,0 +1,66 @@
+#include "uniformBlock.h"
+
+std::vector<std::pair<std::string, GLuint>>& UniformBlockRegistry::getBlocks()
+{
+    // Function local so blocks can register during static initialisation in any translation unit
+    static std::vector<std::pair<std::string, GLuint>> blocks;
+    return blocks;
+}
+
+bool UniformBlockRegistry::add(const char* name, GLuint binding)
+{
+    getBlocks().push_back({ name, binding });
+    return true;
+}
+
+void UniformBlockRegistry::bindProgram(GLuint program)
+{
+    for(const auto& block : getBlocks())
+    {
+        GLuint index = glGetUniformBlockIndex(program, block.first.c_str());
+        // Program doesn't use this block
+        if(index == GL_INVALID_INDEX)
+            continue;
+
+        glUniformBlockBinding(program, index, block.second);
+    }
+}
+
+UniformBlockManager::UniformBlockManager(GLsizeiptr frameSize) :
+ring(GL_UNIFORM_BUFFER, frameSize)
+{
+
+}
+
+UniformBlockManager::~UniformBlockManager()
+{
+
+}
+
+RingAllocation UniformBlockManager::writeBytes(const void* data, std::size_t size)
+{
+    RingAllocation allocation = ring.allocate(size);
+    if(allocation.data)
+        std::memcpy(allocation.data, data, size);
+
+    return allocation;
+}
+
+void UniformBlockManager::beginFrame()
+{
+    ring.beginFrame();
+    sharedBlocks.clear();
+}
+
+void UniformBlockManager::flush()
+{
+    ring.flush();
+
+    for(const auto& block : sharedBlocks)
+        ring.bindRange(block.first, block.second);
+}
+
+void UniformBlockManager::endFrame()
+{
+    ring.endFrame();
+}
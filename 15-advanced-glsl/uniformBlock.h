@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include <glm/glm.hpp>
+
+#include "ringBuffer.h"
+
+/**
+ * @brief Round value up to a multiple of alignment.
+*/
+constexpr std::size_t alignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Std140 base alignment and size of a C++ type used inside a uniform block.
+ * Types without a specialization (glm::mat3, bool, etc.) don't compile, they don't map to std140 one to one.
+*/
+template<typename T>
+struct Std140Traits;
+
+template<> struct Std140Traits<float>        { static constexpr std::size_t alignment = 4;  static constexpr std::size_t size = 4; };
+template<> struct Std140Traits<int>          { static constexpr std::size_t alignment = 4;  static constexpr std::size_t size = 4; };
+template<> struct Std140Traits<unsigned int> { static constexpr std::size_t alignment = 4;  static constexpr std::size_t size = 4; };
+template<> struct Std140Traits<glm::vec2>    { static constexpr std::size_t alignment = 8;  static constexpr std::size_t size = 8; };
+template<> struct Std140Traits<glm::vec3>    { static constexpr std::size_t alignment = 16; static constexpr std::size_t size = 12; };
+template<> struct Std140Traits<glm::vec4>    { static constexpr std::size_t alignment = 16; static constexpr std::size_t size = 16; };
+template<> struct Std140Traits<glm::mat4>    { static constexpr std::size_t alignment = 16; static constexpr std::size_t size = 64; };
+
+// Array elements are aligned to 16 bytes, so a C++ array only matches when its element size is already a multiple of 16
+template<typename T, std::size_t N>
+struct Std140Traits<T[N]>
+{
+    static_assert(sizeof(T) == alignUp(Std140Traits<T>::size, 16), "std140 array stride is 16 bytes, use vec4 (or padded struct) elements");
+    static constexpr std::size_t alignment = 16;
+    static constexpr std::size_t size = N * alignUp(Std140Traits<T>::size, 16);
+};
+
+/**
+ * @brief Offset of a member in C++ struct together with its std140 alignment and size.
+*/
+struct Std140Member
+{
+    std::size_t offset;
+    std::size_t alignment;
+    std::size_t size;
+};
+
+/**
+ * @brief Check at compile time that C++ offsets of members (in declaration order) equal their std140 offsets.
+ * @param members Members of struct in declaration order.
+*/
+template<typename Struct, std::size_t N>
+constexpr bool isStd140Layout(const Std140Member (&members)[N])
+{
+    std::size_t expected = 0;
+    for(std::size_t i = 0; i < N; i++)
+    {
+        expected = alignUp(expected, members[i].alignment);
+        if(members[i].offset != expected)
+            return false;
+        expected += members[i].size;
+    }
+
+    // Whole block is uploaded with sizeof(Struct), which must cover the block rounded to a vec4
+    return sizeof(Struct) == alignUp(expected, 16);
+}
+
+/**
+ * @brief Uniform block name and binding point of a C++ struct, specialized by UNIFORM_BLOCK.
+*/
+template<typename Struct>
+struct UniformBlockTraits;
+
+/**
+ * @brief Class UniformBlockRegistry remembers every declared block so each Shader binds them to their fixed binding points after linking.
+*/
+class UniformBlockRegistry
+{
+private:
+    static std::vector<std::pair<std::string, GLuint>>& getBlocks();
+
+public:
+    /**
+     * @brief Register uniform block.
+     * @param name Name of uniform block in GLSL.
+     * @param binding Binding point of block.
+    */
+    static bool add(const char* name, GLuint binding);
+
+    /**
+     * @brief Bind every registered block that program uses to its binding point.
+     * @param program Linked shader program.
+    */
+    static void bindProgram(GLuint program);
+};
+
+// Helper for UNIFORM_BLOCK member lists
+#define STD140_MEMBER(Struct, member) Std140Member{ offsetof(Struct, member), Std140Traits<decltype(Struct::member)>::alignment, Std140Traits<decltype(Struct::member)>::size }
+
+/**
+ * @brief Declare a C++ struct as the layout of a GLSL std140 uniform block.
+ * Fails to compile if struct layout differs from std140, and registers block so shaders bind it automatically.
+ * Usage: UNIFORM_BLOCK(CameraData, "Matrices", 0, STD140_MEMBER(CameraData, view), STD140_MEMBER(CameraData, projection));
+*/
+#define UNIFORM_BLOCK(Struct, blockName, bindingPoint, ...)                                                         \
+    template<> struct UniformBlockTraits<Struct>                                                                    \
+    {                                                                                                               \
+        static constexpr const char* name = blockName;                                                             \
+        static constexpr GLuint binding = bindingPoint;                                                            \
+        static constexpr Std140Member members[] = { __VA_ARGS__ };                                                 \
+    };                                                                                                              \
+    static_assert(isStd140Layout<Struct>(UniformBlockTraits<Struct>::members), #Struct " doesn't match std140 layout of " blockName); \
+    inline const bool Struct##Registered = UniformBlockRegistry::add(blockName, bindingPoint)
+
+/**
+ * @brief Class UniformBlockManager uploads shared per-frame blocks (camera, lights, frame data) once per frame for all programs,
+ * and streams per-draw blocks, through one RingBuffer.
+ *
+ * Every frame: beginFrame(), setShared() / write() all data, flush(), bind() per-draw blocks while drawing, endFrame().
+*/
+class UniformBlockManager
+{
+private:
+    RingBuffer ring;
+    std::vector<std::pair<GLuint, RingAllocation>> sharedBlocks;   // Blocks bound once per frame in flush()
+
+    RingAllocation writeBytes(const void* data, std::size_t size);
+
+public:
+    /**
+     * @brief Constructor to create manager.
+     * @param frameSize Maximum number of uniform bytes written per frame.
+    */
+    UniformBlockManager(GLsizeiptr frameSize);
+    ~UniformBlockManager();
+
+    void beginFrame();
+
+    /**
+     * @brief Write a block shared by all programs for this frame, it is bound to its binding point in flush().
+     * @param data Block data.
+    */
+    template<typename Struct>
+    void setShared(const Struct &data)
+    {
+        sharedBlocks.push_back({ UniformBlockTraits<Struct>::binding, writeBytes(&data, sizeof(Struct)) });
+    }
+
+    /**
+     * @brief Write a per-draw block, bind it with bind() before the draw that uses it.
+     * @param data Block data.
+    */
+    template<typename Struct>
+    RingAllocation write(const Struct &data)
+    {
+        return writeBytes(&data, sizeof(Struct));
+    }
+
+    /**
+     * @brief Bind a per-draw block written with write() to its binding point.
+     * @param allocation Allocation returned from write().
+    */
+    template<typename Struct>
+    void bind(const RingAllocation &allocation)
+    {
+        ring.bindRange(UniformBlockTraits<Struct>::binding, allocation);
+    }
+
+    /**
+     * @brief Make this frame's data visible to the GPU and bind all shared blocks.
+    */
+    void flush();
+
+    void endFrame();
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "uniformBlock.h"
+
+// Binding points of uniform blocks shared by all shaders
+constexpr GLuint MATRICES_BINDING = 0;
+constexpr GLuint OBJECT_BINDING = 1;
+constexpr GLuint FRAME_BINDING = 2;
+
+/**
+ * @brief Camera matrices, uploaded once per frame ("Matrices" block).
+*/
+struct CameraData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+};
+UNIFORM_BLOCK(CameraData, "Matrices", MATRICES_BINDING,
+    STD140_MEMBER(CameraData, view),
+    STD140_MEMBER(CameraData, projection));
+
+/**
+ * @brief Per-draw object data ("Object" block).
+*/
+struct ObjectData
+{
+    glm::mat4 model;
+    glm::vec4 color;
+};
+UNIFORM_BLOCK(ObjectData, "Object", OBJECT_BINDING,
+    STD140_MEMBER(ObjectData, model),
+    STD140_MEMBER(ObjectData, color));
+
+/**
+ * @brief Per-frame timing and viewport data, uploaded once per frame ("Frame" block).
+*/
+struct FrameData
+{
+    glm::vec2 resolution;
+    float time;
+    float deltaTime;
+};
+UNIFORM_BLOCK(FrameData, "Frame", FRAME_BINDING,
+    STD140_MEMBER(FrameData, resolution),
+    STD140_MEMBER(FrameData, time),
+    STD140_MEMBER(FrameData, deltaTime));
@@ -3,6 +3,7 @@
 #include "mesh.h"
 #include "camera.h"
 #include "texture.h"
+#include "benchmark.h"
 #include "stb_image.h"
 
 #include <glm/glm.hpp>
@@ -174,8 +175,19 @@ void processInput(GLFWwindow* window)
         exit(0);
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // Benchmark mode renders a scripted camera path without a visible window and reports frame timings
+    BenchmarkOptions benchmarkOptions;
+    if(!Benchmark::parseArguments(argc, argv, benchmarkOptions))
+        return -1;
+    if(benchmarkOptions.enabled)
+    {
+        width = benchmarkOptions.width;
+        height = benchmarkOptions.height;
+        Benchmark::prepareContext();
+    }
+
     glWindow window(title, width, height);
 
     glfwSetInputMode(window.getGlWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -215,11 +227,27 @@ int main()
     // Set uniform sampler2D "texture1" to texture unit 1
     shader.setInt("textures[1]", 1);
 
+    std::unique_ptr<Benchmark> benchmark;
+    if(benchmarkOptions.enabled)
+        benchmark.reset(new Benchmark(benchmarkOptions, "7-camera", glm::vec3(0.0f, 0.0f, -6.0f), 12.0f));
+
     // Main loop
     // Run until window should close
-    while (!window.isShouldClose())
+    while (!window.isShouldClose() && !(benchmark && benchmark->isDone()))
     {
+        if(benchmark)
+            benchmark->beginFrame();
+
         processInput(window.getGlWindow());
+        if(benchmark)
+        {
+            // Scripted camera replaces mouse and keyboard
+            BenchmarkCameraPose pose = benchmark->cameraPose();
+            camera.setPosition(pose.position);
+            camera.setYaw(pose.yaw);
+            camera.setPitch(pose.pitch);
+            camera.processMouseMovement(0.0f, 0.0f);
+        }
 
         // Clear window to black screen
         glClearColor(0, 0, 0, 1);
@@ -270,9 +298,15 @@ int main()
         mesh.render(GL_TRIANGLES, 36, GL_UNSIGNED_INT, nullptr);
         mesh.unbind();
 
-        window.swapBuffers();
+        if(benchmark)
+            benchmark->endFrame();
+        else
+            window.swapBuffers();
         glfwPollEvents();
     }
+
+    if(benchmark)
+        benchmark->finish();
     
     mesh.clear();
     shader.unbind();
@@ -6,6 +6,7 @@
 #include "directionalLight.h"
 #include "pointLight.h"
 #include "spotLight.h"
+#include "benchmark.h"
 
 #include <sstream>
 #include <vector>
@@ -296,8 +297,19 @@ glm::vec3 pointLightPositions[] = {
     glm::vec3( 10.0f, 5.0f, -10.0f)
 };  
 
-int main()
+int main(int argc, char** argv)
 {
+    // Benchmark mode renders a scripted camera path without a visible window and reports frame timings
+    BenchmarkOptions benchmarkOptions;
+    if(!Benchmark::parseArguments(argc, argv, benchmarkOptions))
+        return -1;
+    if(benchmarkOptions.enabled)
+    {
+        width = benchmarkOptions.width;
+        height = benchmarkOptions.height;
+        Benchmark::prepareContext();
+    }
+
     // Create window object
     GlWindow window(title, width, height, false);
 
@@ -355,11 +367,27 @@ int main()
     // Tell OpenGL to enable depth buffer, so we be able to perceive depth
     Shader::enableDepth();
 
+    std::unique_ptr<Benchmark> benchmark;
+    if(benchmarkOptions.enabled)
+        benchmark.reset(new Benchmark(benchmarkOptions, "8-light", glm::vec3(0.0f, 0.0f, -7.0f), 14.0f));
+
     // Main loop
     // Run until window should close
-    while (!window.isShouldClose())
+    while (!window.isShouldClose() && !(benchmark && benchmark->isDone()))
     {
+        if(benchmark)
+            benchmark->beginFrame();
+
         processMovement(window.getGlWindow(), &camera);
+        if(benchmark)
+        {
+            // Scripted camera replaces mouse and keyboard
+            BenchmarkCameraPose pose = benchmark->cameraPose();
+            camera.setPosition(pose.position);
+            camera.setYaw(pose.yaw);
+            camera.setPitch(pose.pitch);
+            camera.processMouseMovement(0.0f, 0.0f);
+        }
 
         // Clear window to black screen
         glClearColor(backgroundColor.x, backgroundColor.y, backgroundColor.z, backgroundColor.t);
@@ -448,9 +476,15 @@ int main()
         lightShader.unbind();
         mesh.unbind();
 
-        window.swapBuffers();
+        if(benchmark)
+            benchmark->endFrame();
+        else
+            window.swapBuffers();
         glfwPollEvents();
     }
+
+    if(benchmark)
+        benchmark->finish();
     
     mesh.clear();
     colorShader.clear();
@@ -0,0 +1,324 @@
+#include "assetArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+
+#include <zlib.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+uint64_t AssetArchive::hashName(const std::string &name)
+{
+    // 64-bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(unsigned char character : name)
+    {
+        hash ^= character;
+        hash *= 0x100000001b3ull;
+    }
+
+    // 0 marks empty buckets
+    return hash == 0 ? 1 : hash;
+}
+
+AssetArchive::AssetArchive()
+{
+    mapping = nullptr;
+    mappingSize = 0;
+    header = nullptr;
+    directory = nullptr;
+    names = nullptr;
+}
+
+AssetArchive::~AssetArchive()
+{
+    close();
+}
+
+bool AssetArchive::open(const std::string &path)
+{
+    close();
+
+#ifndef _WIN32
+    int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(file < 0)
+        return false;
+
+    struct stat status;
+    if(fstat(file, &status) != 0 || (size_t)status.st_size < sizeof(AssetArchiveHeader))
+    {
+        std::cerr << "ERROR::AssetArchive::" << path << " is too small to be an archive" << std::endl;
+        ::close(file);
+        return false;
+    }
+
+    void* address = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    // Mapping keeps file alive, descriptor is no longer needed
+    ::close(file);
+    if(address == MAP_FAILED)
+    {
+        std::cerr << "ERROR::AssetArchive::failed to map " << path << std::endl;
+        return false;
+    }
+
+    // Start reading the whole archive now, page faults during loading then hit the page cache instead of the disk
+    madvise(address, status.st_size, MADV_WILLNEED);
+
+    mapping = static_cast<const unsigned char*>(address);
+    mappingSize = status.st_size;
+#else
+    std::cerr << "ERROR::AssetArchive::archives need mmap, loose files are used" << std::endl;
+    return false;
+#endif
+
+    header = reinterpret_cast<const AssetArchiveHeader*>(mapping);
+    bool valid = header->magic == ASSET_ARCHIVE_MAGIC && header->version == ASSET_ARCHIVE_VERSION &&
+                 header->fileSize == mappingSize && header->bucketCount != 0 &&
+                 (header->bucketCount & (header->bucketCount - 1)) == 0 &&
+                 header->namesOffset + header->namesSize <= mappingSize &&
+                 header->directoryOffset % alignof(AssetArchiveEntry) == 0 &&
+                 header->directoryOffset + (uint64_t)header->bucketCount * sizeof(AssetArchiveEntry) <= mappingSize;
+    if(!valid)
+    {
+        std::cerr << "ERROR::AssetArchive::" << path << " is not a valid archive (version " << ASSET_ARCHIVE_VERSION << ")" << std::endl;
+        close();
+        return false;
+    }
+
+    directory = reinterpret_cast<const AssetArchiveEntry*>(mapping + header->directoryOffset);
+    names = reinterpret_cast<const char*>(mapping + header->namesOffset);
+    return true;
+}
+
+void AssetArchive::close()
+{
+#ifndef _WIN32
+    if(mapping != nullptr)
+        munmap(const_cast<unsigned char*>(mapping), mappingSize);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    header = nullptr;
+    directory = nullptr;
+    names = nullptr;
+}
+
+const AssetArchiveEntry* AssetArchive::find(const std::string &name) const
+{
+    if(!isOpen())
+        return nullptr;
+
+    uint64_t hash = hashName(name);
+    uint32_t mask = header->bucketCount - 1;
+    // Directory is at most half full, so an empty bucket always ends the probe
+    for(uint32_t bucket = hash & mask, probes = 0; probes < header->bucketCount; bucket = (bucket + 1) & mask, probes++)
+    {
+        const AssetArchiveEntry &entry = directory[bucket];
+        if(entry.hash == 0)
+            return nullptr;
+        if(entry.hash == hash && entry.nameLength == name.size() &&
+           entry.nameOffset + (uint64_t)entry.nameLength <= header->namesSize &&
+           std::memcmp(names + entry.nameOffset, name.data(), name.size()) == 0)
+            return &entry;
+    }
+    return nullptr;
+}
+
+bool AssetArchive::read(const std::string &name, AssetData &data) const
+{
+    const AssetArchiveEntry* entry = find(name);
+    if(entry == nullptr)
+        return false;
+
+    if(entry->offset + entry->storedSize > mappingSize)
+    {
+        std::cerr << "ERROR::AssetArchive::entry " << name << " is out of bounds" << std::endl;
+        return false;
+    }
+
+    const unsigned char* blob = mapping + entry->offset;
+    data.storage.clear();
+    if(entry->compression == ASSET_COMPRESSION_NONE)
+    {
+        data.data = blob;
+        data.size = entry->size;
+        return true;
+    }
+
+    if(entry->compression != ASSET_COMPRESSION_ZLIB)
+    {
+        std::cerr << "ERROR::AssetArchive::entry " << name << " has unknown compression " << entry->compression << std::endl;
+        return false;
+    }
+
+    data.storage.resize(entry->size);
+    uLongf size = entry->size;
+    if(uncompress(data.storage.data(), &size, blob, entry->storedSize) != Z_OK || size != entry->size)
+    {
+        std::cerr << "ERROR::AssetArchive::failed to decompress " << name << std::endl;
+        data.storage.clear();
+        return false;
+    }
+
+    data.data = data.storage.data();
+    data.size = data.storage.size();
+    return true;
+}
+
+bool AssetArchive::build(const std::string &path, const std::string &root, const std::vector<std::string> &directories)
+{
+    namespace fs = std::filesystem;
+
+    // Collect files first, sorted names make archive contents independent of directory iteration order
+    fs::path rootPath = fs::path(root).lexically_normal();
+    std::vector<std::string> files;
+    for(const std::string &directoryPath : directories)
+    {
+        std::error_code error;
+        for(fs::recursive_directory_iterator it(directoryPath, error), end; !error && it != end; it.increment(error))
+        {
+            if(!it->is_regular_file())
+                continue;
+
+            std::string name = it->path().lexically_normal().lexically_relative(rootPath).generic_string();
+            if(name.empty() || name.compare(0, 2, "..") == 0)
+            {
+                std::cerr << "ERROR::AssetArchive::" << it->path() << " is outside of " << root << ", skipped" << std::endl;
+                continue;
+            }
+            files.push_back(name);
+        }
+        if(error)
+        {
+            std::cerr << "ERROR::AssetArchive::failed to list " << directoryPath << ": " << error.message() << std::endl;
+            return false;
+        }
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+    if(!output.is_open())
+    {
+        std::cerr << "ERROR::AssetArchive::failed to create " << temporaryPath << std::endl;
+        return false;
+    }
+
+    uint64_t position = 0;
+    auto pad = [&output, &position](uint64_t alignment)
+    {
+        static const char zeros[ASSET_ARCHIVE_ALIGNMENT] = {};
+        uint64_t padding = (alignment - position % alignment) % alignment;
+        output.write(zeros, padding);
+        position += padding;
+    };
+
+    // Room for header, it is written last once offsets are known
+    AssetArchiveHeader header = {};
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    position += sizeof(header);
+
+    std::vector<AssetArchiveEntry> entries;
+    std::string namesBlock;
+    uint64_t totalSize = 0, totalStored = 0;
+    for(const std::string &name : files)
+    {
+        std::ifstream input(rootPath / name, std::ios::binary);
+        std::vector<unsigned char> contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        if(!input.good() && !input.eof())
+        {
+            std::cerr << "ERROR::AssetArchive::failed to read " << name << std::endl;
+            return false;
+        }
+
+        AssetArchiveEntry entry = {};
+        entry.hash = hashName(name);
+        entry.size = contents.size();
+        entry.nameOffset = namesBlock.size();
+        entry.nameLength = name.size();
+        entry.compression = ASSET_COMPRESSION_NONE;
+        namesBlock += name;
+
+        // Keep compressed copy only if it is worth decompressing
+        std::vector<unsigned char> compressed(compressBound(contents.size()));
+        uLongf compressedSize = compressed.size();
+        const std::vector<unsigned char>* blob = &contents;
+        if(!contents.empty() && compress2(compressed.data(), &compressedSize, contents.data(), contents.size(), Z_BEST_COMPRESSION) == Z_OK &&
+           compressedSize < contents.size() - contents.size() / 8)
+        {
+            compressed.resize(compressedSize);
+            blob = &compressed;
+            entry.compression = ASSET_COMPRESSION_ZLIB;
+        }
+
+        pad(ASSET_ARCHIVE_ALIGNMENT);
+        entry.offset = position;
+        entry.storedSize = blob->size();
+        output.write(reinterpret_cast<const char*>(blob->data()), blob->size());
+        position += blob->size();
+
+        totalSize += entry.size;
+        totalStored += entry.storedSize;
+        entries.push_back(entry);
+    }
+
+    header.magic = ASSET_ARCHIVE_MAGIC;
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.entryCount = entries.size();
+
+    header.namesOffset = position;
+    header.namesSize = namesBlock.size();
+    output.write(namesBlock.data(), namesBlock.size());
+    position += namesBlock.size();
+
+    // At most half full, keeps probes short
+    header.bucketCount = 16;
+    while(header.bucketCount < entries.size() * 2)
+        header.bucketCount *= 2;
+
+    std::vector<AssetArchiveEntry> buckets(header.bucketCount, AssetArchiveEntry{});
+    for(const AssetArchiveEntry &entry : entries)
+    {
+        uint32_t bucket = entry.hash & (header.bucketCount - 1);
+        while(buckets[bucket].hash != 0)
+            bucket = (bucket + 1) & (header.bucketCount - 1);
+        buckets[bucket] = entry;
+    }
+
+    pad(alignof(AssetArchiveEntry));
+    header.directoryOffset = position;
+    output.write(reinterpret_cast<const char*>(buckets.data()), buckets.size() * sizeof(AssetArchiveEntry));
+    position += buckets.size() * sizeof(AssetArchiveEntry);
+    header.fileSize = position;
+
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.close();
+    if(!output)
+    {
+        std::cerr << "ERROR::AssetArchive::failed to write " << temporaryPath << std::endl;
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    // Rename replaces old archive at once, a running program never maps a half written one
+    if(std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << "ERROR::AssetArchive::failed to move archive to " << path << std::endl;
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    std::cout << "Packed " << entries.size() << " files into " << path << " (" << totalSize / 1024 << " KiB, "
+              << totalStored / 1024 << " KiB stored)" << std::endl;
+    return true;
+}
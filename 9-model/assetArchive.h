@@ -0,0 +1,123 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+constexpr uint32_t ASSET_ARCHIVE_MAGIC = 0x4b504c47;    // "GLPK"
+constexpr uint32_t ASSET_ARCHIVE_VERSION = 1;
+// Blobs start on page boundaries, so a blob is never split across more pages than it needs and mapped data is aligned for any type
+constexpr uint64_t ASSET_ARCHIVE_ALIGNMENT = 4096;
+
+enum AssetCompression
+{
+    ASSET_COMPRESSION_NONE,
+    ASSET_COMPRESSION_ZLIB,
+};
+
+/**
+ * @brief Struct AssetArchiveHeader starts every archive. Layout: header, blobs, names, directory.
+*/
+struct AssetArchiveHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t bucketCount;       // Size of directory, power of two
+    uint64_t namesOffset;       // Names of all entries, not null terminated
+    uint64_t namesSize;
+    uint64_t directoryOffset;   // Hash table of bucketCount AssetArchiveEntry
+    uint64_t fileSize;          // Size of whole archive, catches truncated files
+};
+
+/**
+ * @brief Struct AssetArchiveEntry is one bucket of the directory, hash 0 marks an empty bucket.
+*/
+struct AssetArchiveEntry
+{
+    uint64_t hash;              // Hash of name, collisions are resolved by comparing names
+    uint64_t offset;            // Offset of blob in archive, aligned to ASSET_ARCHIVE_ALIGNMENT
+    uint64_t size;              // Size of file
+    uint64_t storedSize;        // Size of blob, smaller than size when compressed
+    uint32_t nameOffset;        // Offset of name in names block
+    uint32_t nameLength;
+    uint32_t compression;       // AssetCompression
+    uint32_t reserved;
+};
+
+/**
+ * @brief Struct AssetData holds the contents of one file. Data points into the mapped archive when the entry is stored
+ * uncompressed (no copy), otherwise into storage. Moving keeps data valid, copying is not allowed.
+*/
+struct AssetData
+{
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    std::vector<unsigned char> storage;
+
+    AssetData() = default;
+    AssetData(AssetData &&) = default;
+    AssetData& operator=(AssetData &&) = default;
+    AssetData(const AssetData &) = delete;
+    AssetData& operator=(const AssetData &) = delete;
+};
+
+/**
+ * @brief Class AssetArchive packs many files into one, read back through a memory mapping.
+ *
+ * Files are found through a hashed directory (open addressing, linear probing) keyed by their path relative to the
+ * archive root ("assets/backpack/backpack.obj"). Entries are compressed with zlib when that saves at least an eighth of
+ * their size, already compressed files (jpg, png) stay as they are and are returned without copying.
+*/
+class AssetArchive
+{
+private:
+    const unsigned char* mapping;
+    size_t mappingSize;
+    const AssetArchiveHeader* header;
+    const AssetArchiveEntry* directory;
+    const char* names;
+
+public:
+    AssetArchive();
+    ~AssetArchive();
+    AssetArchive(const AssetArchive &) = delete;
+    AssetArchive& operator=(const AssetArchive &) = delete;
+
+    /**
+     * @brief Map archive into memory and validate it, an archive already open is closed first.
+     * @return False if file is missing or isn't a valid archive.
+    */
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return mapping != nullptr; };
+
+    /**
+     * @brief Find entry by name.
+     * @param name Path relative to archive root, with '/' separators.
+     * @return Entry, or nullptr if archive has no such file.
+    */
+    const AssetArchiveEntry* find(const std::string &name) const;
+
+    /**
+     * @brief Read file, decompressing it if needed.
+     * @return False if archive has no such file or it is corrupt.
+    */
+    bool read(const std::string &name, AssetData &data) const;
+
+    unsigned int getEntryCount() const { return header ? header->entryCount : 0; };
+
+    /**
+     * @brief Pack every file under directories (recursively) into a new archive.
+     * @param path Archive to write, replaced only when writing succeeded.
+     * @param root Entry names are paths relative to this directory.
+     * @param directories Directories to pack, must be inside root.
+    */
+    static bool build(const std::string &path, const std::string &root, const std::vector<std::string> &directories);
+
+    /**
+     * @brief Hash of entry name used by directory, never 0.
+    */
+    static uint64_t hashName(const std::string &name);
+};
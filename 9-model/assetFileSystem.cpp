@@ -0,0 +1,117 @@
+#include "assetFileSystem.h"
+
+#include <fstream>
+#include <filesystem>
+
+AssetArchive& AssetFileSystem::getArchive()
+{
+    static AssetArchive archive;
+    return archive;
+}
+
+std::string& AssetFileSystem::getRoot()
+{
+    static std::string root;
+    return root;
+}
+
+bool& AssetFileSystem::getLooseFirst()
+{
+    static bool looseFirst = false;
+    return looseFirst;
+}
+
+bool AssetFileSystem::mount(const std::string &archivePath, const std::string &root)
+{
+    unmount();
+    if(!getArchive().open(archivePath))
+        return false;
+
+    // Trailing separator, so root "/a/b" doesn't match "/a/bc/file"
+    getRoot() = std::filesystem::path(root).lexically_normal().generic_string();
+    if(getRoot().empty() || getRoot().back() != '/')
+        getRoot() += '/';
+
+    std::cout << "Mounted " << archivePath << " (" << getArchive().getEntryCount() << " files)" << std::endl;
+    return true;
+}
+
+void AssetFileSystem::unmount()
+{
+    getArchive().close();
+    getRoot().clear();
+}
+
+bool AssetFileSystem::isMounted()
+{
+    return getArchive().isOpen();
+}
+
+void AssetFileSystem::setLooseFirst(bool looseFirst)
+{
+    getLooseFirst() = looseFirst;
+}
+
+std::string AssetFileSystem::archiveName(const std::string &path)
+{
+    const std::string &root = getRoot();
+    std::string normal = std::filesystem::path(path).lexically_normal().generic_string();
+    if(root.empty() || normal.compare(0, root.size(), root) != 0)
+        return "";
+    return normal.substr(root.size());
+}
+
+bool AssetFileSystem::readLoose(const std::string &path, AssetData &data)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+        return false;
+
+    std::streamsize size = file.tellg();
+    file.seekg(0);
+    data.storage.resize(size < 0 ? 0 : size);
+    if(!file.read(reinterpret_cast<char*>(data.storage.data()), data.storage.size()))
+        return false;
+
+    data.data = data.storage.data();
+    data.size = data.storage.size();
+    return true;
+}
+
+bool AssetFileSystem::read(const std::string &path, AssetData &data)
+{
+    if(getLooseFirst() && readLoose(path, data))
+        return true;
+
+    std::string name = archiveName(path);
+    if(!name.empty() && getArchive().read(name, data))
+        return true;
+
+    return !getLooseFirst() && readLoose(path, data);
+}
+
+bool AssetFileSystem::readText(const std::string &path, std::string &text)
+{
+    AssetData data;
+    if(!read(path, data))
+        return false;
+
+    text.assign(reinterpret_cast<const char*>(data.data), data.size);
+    return true;
+}
+
+bool AssetFileSystem::exists(const std::string &path)
+{
+    std::string name = archiveName(path);
+    if(!name.empty() && getArchive().find(name) != nullptr)
+        return true;
+
+    std::error_code error;
+    return std::filesystem::is_regular_file(path, error);
+}
+
+bool AssetFileSystem::isPacked(const std::string &path)
+{
+    std::string name = archiveName(path);
+    return !getLooseFirst() && !name.empty() && getArchive().find(name) != nullptr;
+}
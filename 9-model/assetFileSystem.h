@@ -0,0 +1,63 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+#include "assetArchive.h"
+
+/**
+ * @brief Class AssetFileSystem is the single place shaders, models and textures are read from.
+ *
+ * While an archive is mounted, files under its root are read from the archive, anything else (or anything the archive
+ * doesn't have) falls back to loose files, so the program runs the same with or without an archive.
+ * Paths are absolute paths to loose files, they are turned into archive names lexically, without touching the disk.
+*/
+class AssetFileSystem
+{
+private:
+    static AssetArchive& getArchive();
+    static std::string& getRoot();
+    static bool& getLooseFirst();
+
+    /**
+     * @brief Name of path inside archive, empty if path isn't under archive root.
+    */
+    static std::string archiveName(const std::string &path);
+
+    static bool readLoose(const std::string &path, AssetData &data);
+
+public:
+    /**
+     * @brief Mount archive, replacing archive mounted before.
+     * @param archivePath Archive built by AssetArchive::build().
+     * @param root Directory the archive was built from.
+     * @return False if archive can't be used, loose files are read then.
+    */
+    static bool mount(const std::string &archivePath, const std::string &root);
+    static void unmount();
+    static bool isMounted();
+
+    /**
+     * @brief Prefer loose files over archive (while editing files, e.g. during shader hot reload).
+    */
+    static void setLooseFirst(bool looseFirst);
+
+    /**
+     * @brief Read whole file.
+     * @return False if file doesn't exist in archive or on disk.
+    */
+    static bool read(const std::string &path, AssetData &data);
+
+    /**
+     * @brief Read whole file as text.
+     * @return False if file doesn't exist in archive or on disk.
+    */
+    static bool readText(const std::string &path, std::string &text);
+
+    static bool exists(const std::string &path);
+
+    /**
+     * @brief True if read() would return path from the archive (no file I/O, the archive is mapped).
+    */
+    static bool isPacked(const std::string &path);
+};
@@ -0,0 +1,79 @@
+#include "assetIOSystem.h"
+
+#include <cstring>
+#include <algorithm>
+
+AssetIOStream::AssetIOStream(AssetData &&data) : data(std::move(data))
+{
+    position = 0;
+}
+
+size_t AssetIOStream::Read(void* buffer, size_t size, size_t count)
+{
+    if(size == 0)
+        return 0;
+
+    // Like fread, only whole elements are read
+    size_t elements = std::min(count, (data.size - position) / size);
+    std::memcpy(buffer, data.data + position, elements * size);
+    position += elements * size;
+    return elements;
+}
+
+// Assets are read-only
+size_t AssetIOStream::Write(const void*, size_t, size_t)
+{
+    return 0;
+}
+
+aiReturn AssetIOStream::Seek(size_t offset, aiOrigin origin)
+{
+    size_t base = origin == aiOrigin_SET ? 0 : origin == aiOrigin_CUR ? position : data.size;
+    if(base + offset > data.size)
+        return aiReturn_FAILURE;
+
+    position = base + offset;
+    return aiReturn_SUCCESS;
+}
+
+size_t AssetIOStream::Tell() const
+{
+    return position;
+}
+
+size_t AssetIOStream::FileSize() const
+{
+    return data.size;
+}
+
+void AssetIOStream::Flush()
+{
+
+}
+
+bool AssetIOSystem::Exists(const char* path) const
+{
+    return AssetFileSystem::exists(path);
+}
+
+char AssetIOSystem::getOsSeparator() const
+{
+    return '/';
+}
+
+Assimp::IOStream* AssetIOSystem::Open(const char* path, const char* mode)
+{
+    // Archive is read-only
+    if(std::strchr(mode, 'w') != nullptr || std::strchr(mode, 'a') != nullptr)
+        return nullptr;
+
+    AssetData data;
+    if(!AssetFileSystem::read(path, data))
+        return nullptr;
+    return new AssetIOStream(std::move(data));
+}
+
+void AssetIOSystem::Close(Assimp::IOStream* stream)
+{
+    delete stream;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+
+#include "assetFileSystem.h"
+
+/**
+ * @brief Class AssetIOStream is a read-only assimp stream over a file read through AssetFileSystem.
+*/
+class AssetIOStream : public Assimp::IOStream
+{
+private:
+    AssetData data;
+    size_t position;
+
+public:
+    AssetIOStream(AssetData &&data);
+
+    size_t Read(void* buffer, size_t size, size_t count) override;
+    size_t Write(const void* buffer, size_t size, size_t count) override;
+    aiReturn Seek(size_t offset, aiOrigin origin) override;
+    size_t Tell() const override;
+    size_t FileSize() const override;
+    void Flush() override;
+};
+
+/**
+ * @brief Class AssetIOSystem lets assimp open models and the files they reference (.mtl) through AssetFileSystem.
+ * Importer takes ownership of it: Importer::SetIOHandler(new AssetIOSystem()).
+*/
+class AssetIOSystem : public Assimp::IOSystem
+{
+public:
+    bool Exists(const char* path) const override;
+    char getOsSeparator() const override;
+    Assimp::IOStream* Open(const char* path, const char* mode = "rb") override;
+    void Close(Assimp::IOStream* stream) override;
+};
@@ -0,0 +1,417 @@
+#include "asyncFileReader.h"
+#include "cpuProfiler.h"
+#include "assetFileSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#ifdef __linux__
+/**
+ * @brief Struct Ring is a minimal io_uring: one submission and one completion queue mapped from the kernel.
+ * Only the I/O thread touches it, so the queues need no locking, only ordering against the kernel.
+*/
+struct AsyncFileReader::Ring
+{
+    int descriptor = -1;
+    void* submissionMapping = MAP_FAILED;
+    size_t submissionSize = 0;
+    void* completionMapping = MAP_FAILED;
+    size_t completionSize = 0;
+    io_uring_sqe* entries = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t entriesSize = 0;
+
+    unsigned *submissionTail, *submissionMask, *submissionArray;
+    unsigned *completionHead, *completionTail, *completionMask;
+    io_uring_cqe* completions;
+    unsigned unsubmitted = 0;       // Entries written since last enter()
+    std::vector<std::unique_ptr<Request>> abandoned;   // Reads given up after enter() failed, kernel may still write their buffers
+
+    bool setup(unsigned depth)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        descriptor = syscall(__NR_io_uring_setup, depth, &params);
+        if(descriptor < 0)
+            return false;
+
+        // IORING_OP_READ came with 5.6, which is also when RW_CUR_POS was added
+        if(!(params.features & IORING_FEAT_RW_CUR_POS))
+            return false;
+
+        submissionSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        completionSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+        if(singleMapping)
+            submissionSize = completionSize = std::max(submissionSize, completionSize);
+
+        submissionMapping = mmap(nullptr, submissionSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor, IORING_OFF_SQ_RING);
+        if(submissionMapping == MAP_FAILED)
+            return false;
+        if(singleMapping)
+            completionMapping = submissionMapping;
+        else
+        {
+            completionMapping = mmap(nullptr, completionSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor, IORING_OFF_CQ_RING);
+            if(completionMapping == MAP_FAILED)
+                return false;
+        }
+
+        entriesSize = params.sq_entries * sizeof(io_uring_sqe);
+        entries = static_cast<io_uring_sqe*>(mmap(nullptr, entriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor, IORING_OFF_SQES));
+        if(entries == MAP_FAILED)
+            return false;
+
+        char* submission = static_cast<char*>(submissionMapping);
+        submissionTail = reinterpret_cast<unsigned*>(submission + params.sq_off.tail);
+        submissionMask = reinterpret_cast<unsigned*>(submission + params.sq_off.ring_mask);
+        submissionArray = reinterpret_cast<unsigned*>(submission + params.sq_off.array);
+
+        char* completion = static_cast<char*>(completionMapping);
+        completionHead = reinterpret_cast<unsigned*>(completion + params.cq_off.head);
+        completionTail = reinterpret_cast<unsigned*>(completion + params.cq_off.tail);
+        completionMask = reinterpret_cast<unsigned*>(completion + params.cq_off.ring_mask);
+        completions = reinterpret_cast<io_uring_cqe*>(completion + params.cq_off.cqes);
+        return true;
+    }
+
+    ~Ring()
+    {
+        if(entries != MAP_FAILED)
+            munmap(entries, entriesSize);
+        if(completionMapping != MAP_FAILED && completionMapping != submissionMapping)
+            munmap(completionMapping, completionSize);
+        if(submissionMapping != MAP_FAILED)
+            munmap(submissionMapping, submissionSize);
+        if(descriptor >= 0)
+            close(descriptor);
+    }
+
+    /**
+     * @brief Queue read of the rest of request's file, caller keeps in flight reads below queue depth.
+    */
+    void queueRead(Request* request)
+    {
+        unsigned tail = *submissionTail;
+        unsigned index = tail & *submissionMask;
+
+        io_uring_sqe &entry = entries[index];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.opcode = IORING_OP_READ;
+        entry.fd = request->file;
+        entry.addr = reinterpret_cast<uint64_t>(request->data.storage.data() + request->done);
+        entry.len = request->data.storage.size() - request->done;
+        entry.off = request->done;
+        entry.user_data = reinterpret_cast<uint64_t>(request);
+
+        submissionArray[index] = index;
+        // Kernel may read the entry as soon as it sees the new tail
+        __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+        unsubmitted++;
+    }
+
+    /**
+     * @brief Submit queued reads and wait for at least minimumComplete completions.
+    */
+    bool enter(unsigned minimumComplete)
+    {
+        while(true)
+        {
+            int submitted = syscall(__NR_io_uring_enter, descriptor, unsubmitted, minimumComplete, minimumComplete ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if(submitted >= 0)
+            {
+                unsubmitted -= submitted;
+                return true;
+            }
+            if(errno != EINTR)
+                return false;
+        }
+    }
+};
+#else
+struct AsyncFileReader::Ring
+{
+    bool setup(unsigned depth) { return false; }
+};
+#endif
+
+AsyncFileReader::AsyncFileReader(unsigned int decodeThreadCount)
+{
+    outstanding = 0;
+    stopping = false;
+
+    if(decodeThreadCount == 0)
+        decodeThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned int i = 0; i < decodeThreadCount; i++)
+        decoders.emplace_back(&AsyncFileReader::decodeLoop, this);
+
+    ring.reset(new Ring());
+    if(ring->setup(ASYNC_READ_QUEUE_DEPTH))
+    {
+        readers.emplace_back(&AsyncFileReader::ringLoop, this);
+        return;
+    }
+
+    std::cerr << "ERROR::AsyncFileReader::io_uring is not available, using " << BLOCKING_READ_THREADS << " blocking read threads" << std::endl;
+    ring.reset();
+    for(unsigned int i = 0; i < BLOCKING_READ_THREADS; i++)
+        readers.emplace_back(&AsyncFileReader::blockingLoop, this);
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    // Reads in flight write into requests' buffers, they have to land before anything is freed
+    wait();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    readCondition.notify_all();
+    decodeCondition.notify_all();
+
+    for(std::thread &reader : readers)
+        reader.join();
+    for(std::thread &decoder : decoders)
+        decoder.join();
+}
+
+void AsyncFileReader::read(const std::string &path, DecodeFunction decode)
+{
+    std::unique_ptr<Request> request(new Request());
+    request->path = path;
+    request->decode = std::move(decode);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        outstanding++;
+    }
+
+    // Packed files are already mapped, reading them is a lookup (and maybe a decompression, done on the worker)
+    if(AssetFileSystem::isPacked(path))
+    {
+        request->packed = true;
+        finishRead(std::move(request), true);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reads.push_back(std::move(request));
+    }
+    readCondition.notify_one();
+}
+
+void AsyncFileReader::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this]() { return outstanding == 0; });
+}
+
+bool AsyncFileReader::open(Request &request)
+{
+#ifdef __linux__
+    request.file = ::open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(request.file < 0)
+        return false;
+
+    struct stat status;
+    if(fstat(request.file, &status) != 0)
+        return false;
+
+    request.data.storage.resize(status.st_size);
+    request.data.data = request.data.storage.data();
+    request.data.size = request.data.storage.size();
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AsyncFileReader::finishRead(std::unique_ptr<Request> request, bool success)
+{
+#ifdef __linux__
+    if(request->file >= 0)
+        close(request->file);
+#endif
+    request->file = -1;
+
+    if(!success)
+    {
+        std::cerr << "ERROR::AsyncFileReader::failed to read " << request->path << std::endl;
+        request->data = AssetData();
+    }
+    request->success = success;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        decodes.push_back(std::move(request));
+    }
+    decodeCondition.notify_one();
+}
+
+void AsyncFileReader::ringLoop()
+{
+    CpuProfiler::setThreadName("File reader");
+#ifdef __linux__
+    std::unordered_set<Request*> inFlight;     // Queued in ring, owned by it until their completion is reaped
+    while(true)
+    {
+        // Take as many requests as there is room for, only sleep here when nothing is in flight
+        std::vector<std::unique_ptr<Request>> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if(inFlight.empty())
+                readCondition.wait(lock, [this]() { return stopping || !reads.empty(); });
+            if(stopping && inFlight.empty())
+                return;
+
+            while(!reads.empty() && inFlight.size() + batch.size() < ASYNC_READ_QUEUE_DEPTH)
+            {
+                batch.push_back(std::move(reads.front()));
+                reads.pop_front();
+            }
+        }
+
+        for(std::unique_ptr<Request> &request : batch)
+        {
+            if(!open(*request))
+                finishRead(std::move(request), false);
+            else if(request->data.size == 0)
+                finishRead(std::move(request), true);
+            else
+            {
+                inFlight.insert(request.get());
+                ring->queueRead(request.release());
+            }
+        }
+        if(inFlight.empty())
+            continue;
+
+        if(!ring->enter(1))
+        {
+            // EINTR is retried by enter(), EAGAIN and EBUSY mean kernel is short of resources (or completions) for now
+            if(errno == EAGAIN || errno == EBUSY)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+
+            std::cerr << "ERROR::AsyncFileReader::io_uring_enter failed: " << std::strerror(errno) << ", using " << BLOCKING_READ_THREADS
+                      << " blocking read threads" << std::endl;
+            // Blocking threads take over, they exist before any of the requests below can finish
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for(unsigned int i = 0; i < BLOCKING_READ_THREADS; i++)
+                    readers.emplace_back(&AsyncFileReader::blockingLoop, this);
+            }
+            // Reads in the ring are read again by blocking threads, old buffers stay with the ring in case the kernel still writes them
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for(Request* request : inFlight)
+                {
+                    std::unique_ptr<Request> retry(new Request());
+                    retry->path = request->path;
+                    retry->decode = std::move(request->decode);
+                    close(request->file);
+                    request->file = -1;
+                    ring->abandoned.emplace_back(request);
+                    reads.push_back(std::move(retry));
+                }
+            }
+            readCondition.notify_all();
+            return;
+        }
+
+        // Reap every completion that arrived, short reads are queued again for the rest of the file
+        unsigned head = *ring->completionHead;
+        unsigned tail = __atomic_load_n(ring->completionTail, __ATOMIC_ACQUIRE);
+        for(; head != tail; head++)
+        {
+            io_uring_cqe &completion = ring->completions[head & *ring->completionMask];
+            std::unique_ptr<Request> request(reinterpret_cast<Request*>(completion.user_data));
+            int result = completion.res;
+
+            if(result == -EINTR || result == -EAGAIN || (result > 0 && request->done + result < request->data.size))
+            {
+                request->done += result > 0 ? result : 0;
+                ring->queueRead(request.release());
+                continue;
+            }
+
+            inFlight.erase(request.get());
+            // 0 bytes before the end means file shrank while reading
+            finishRead(std::move(request), result > 0);
+        }
+        __atomic_store_n(ring->completionHead, head, __ATOMIC_RELEASE);
+    }
+#endif
+}
+
+void AsyncFileReader::blockingLoop()
+{
+    CpuProfiler::setThreadName("File reader");
+    while(true)
+    {
+        std::unique_ptr<Request> request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            readCondition.wait(lock, [this]() { return stopping || !reads.empty(); });
+            if(reads.empty())
+                return;
+            request = std::move(reads.front());
+            reads.pop_front();
+        }
+
+        bool success;
+        {
+            CPU_ZONE("read");
+            success = AssetFileSystem::read(request->path, request->data);
+        }
+        finishRead(std::move(request), success);
+    }
+}
+
+void AsyncFileReader::decodeLoop()
+{
+    CpuProfiler::setThreadName("Decoder");
+    while(true)
+    {
+        std::unique_ptr<Request> request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            decodeCondition.wait(lock, [this]() { return stopping || !decodes.empty(); });
+            if(decodes.empty())
+                return;
+            request = std::move(decodes.front());
+            decodes.pop_front();
+        }
+
+        {
+            CPU_ZONE("decode");
+            if(request->packed)
+                request->success = AssetFileSystem::read(request->path, request->data);
+            request->decode(request->data, request->success);
+            request.reset();
+        }
+
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = --outstanding == 0;
+        }
+        if(done)
+            doneCondition.notify_all();
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "assetArchive.h"
+
+constexpr unsigned int ASYNC_READ_QUEUE_DEPTH = 64;     // Reads in flight at once with io_uring
+constexpr unsigned int BLOCKING_READ_THREADS = 4;       // Threads reading at once without io_uring
+
+/**
+ * @brief Class AsyncFileReader reads many files at once and hands each one to a decode worker as soon as it arrives.
+ *
+ * Reads are batched through io_uring, so the disk sees up to ASYNC_READ_QUEUE_DEPTH requests instead of one blocking read
+ * after another. Where io_uring is unavailable (not Linux, old kernel, disabled by seccomp) a few threads do blocking reads.
+ * Files inside a mounted archive are already mapped, they skip I/O and go straight to a decode worker.
+ *
+ * Decode functions run on worker threads, they must not call GL. Results are collected by the caller after wait().
+*/
+class AsyncFileReader
+{
+public:
+    /**
+     * @brief Called on a decode worker with the contents of a file, success is false if it couldn't be read.
+    */
+    using DecodeFunction = std::function<void(AssetData &data, bool success)>;
+
+private:
+    struct Request
+    {
+        std::string path;
+        DecodeFunction decode;
+        AssetData data;
+        int file = -1;
+        size_t done = 0;                // Bytes read so far, reads may come back short
+        bool packed = false;            // In mounted archive, read on decode worker
+        bool success = false;
+    };
+
+    struct Ring;
+    std::unique_ptr<Ring> ring;         // nullptr when blocking threads are used
+
+    std::mutex mutex;
+    std::condition_variable readCondition;      // New requests or stopping
+    std::condition_variable decodeCondition;    // New decode jobs or stopping
+    std::condition_variable doneCondition;      // outstanding dropped to 0
+    std::deque<std::unique_ptr<Request>> reads;
+    std::deque<std::unique_ptr<Request>> decodes;
+    unsigned int outstanding;           // Requests not decoded yet
+    bool stopping;
+
+    std::vector<std::thread> readers;
+    std::vector<std::thread> decoders;
+
+    /**
+     * @brief Open file and size buffer for it, false if file can't be opened.
+    */
+    bool open(Request &request);
+
+    /**
+     * @brief Queue request for a decode worker, file was read (or failed) and is closed.
+    */
+    void finishRead(std::unique_ptr<Request> request, bool success);
+
+    void ringLoop();
+    void blockingLoop();
+    void decodeLoop();
+
+public:
+    /**
+     * @brief Start I/O and decode threads.
+     * @param decodeThreadCount Number of decode workers, 0 uses all hardware threads.
+    */
+    AsyncFileReader(unsigned int decodeThreadCount = 0);
+    ~AsyncFileReader();
+
+    /**
+     * @brief Queue read of whole file, decode is called on a worker once it is in memory.
+     * @param path Absolute path of loose file (or of a file in the mounted archive).
+    */
+    void read(const std::string &path, DecodeFunction decode);
+
+    /**
+     * @brief Block until every queued file is read and decoded.
+    */
+    void wait();
+
+    bool isUsingRing() const { return ring != nullptr; };
+};
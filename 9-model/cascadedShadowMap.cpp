@@ -0,0 +1,254 @@
+#include "cascadedShadowMap.h"
+
+#include <algorithm>
+#include <cmath>
+
+CascadedShadowMap::CascadedShadowMap(const std::string &shaderDirectory, unsigned int cascadeCount, unsigned int resolution, float shadowDistance, float splitLambda) :
+depthShader((shaderDirectory + "/shadowDepth.vs").c_str(), (shaderDirectory + "/shadowDepth.fs").c_str())
+{
+    if(cascadeCount < 2 || cascadeCount > MAX_SHADOW_CASCADES)
+    {
+        std::cerr << "ERROR::CascadedShadowMap::cascade count must be between 2 and " << MAX_SHADOW_CASCADES << ", using 3" << std::endl;
+        cascadeCount = 3;
+    }
+
+    this->cascadeCount = cascadeCount;
+    this->resolution = resolution;
+    this->shadowDistance = shadowDistance;
+    this->splitLambda = splitLambda;
+    // Far half of cascades changes least when camera moves, those are cached
+    cachedCascadeStart = cascadeCount - cascadeCount / 2;
+
+    lightDirection = glm::vec3(0.0f);
+    fov = aspect = nearPlane = 0.0f;
+    drawnMeshCount = 0;
+    for(unsigned int i = 0; i < MAX_SHADOW_CASCADES; i++)
+        cascades[i].staticValid = false;
+
+    depthArray = createDepthArray(cascadeCount, true);
+    staticDepthArray = createDepthArray(cascadeCount - cachedCascadeStart, false);
+
+    // Layers are attached per cascade while rendering, depth only framebuffers have no color buffers
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "ERROR::CascadedShadowMap::shadow framebuffer is not complete" << std::endl;
+
+    glGenFramebuffers(1, &staticFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, staticFramebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticDepthArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "ERROR::CascadedShadowMap::static shadow framebuffer is not complete" << std::endl;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+CascadedShadowMap::~CascadedShadowMap()
+{
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteFramebuffers(1, &staticFramebuffer);
+    glDeleteTextures(1, &depthArray);
+    glDeleteTextures(1, &staticDepthArray);
+}
+
+unsigned int CascadedShadowMap::createDepthArray(unsigned int layers, bool comparison)
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, layers, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+    if(comparison)
+    {
+        // Hardware depth comparison with bilinear filtering gives 2x2 PCF for every lookup
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    else
+    {
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    // Everything outside of a cascade is lit
+    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return texture;
+}
+
+void CascadedShadowMap::invalidateStatic()
+{
+    for(unsigned int i = 0; i < MAX_SHADOW_CASCADES; i++)
+        cascades[i].staticValid = false;
+}
+
+void CascadedShadowMap::drawCasters(const std::vector<ShadowCaster> &casters, const glm::mat4 &lightView, glm::vec3 center, float radius, bool isStatic)
+{
+    for(const ShadowCaster &caster : casters)
+    {
+        if(caster.isStatic != isStatic)
+            continue;
+
+        depthShader.setMatrix4fv("model", 1, GL_FALSE, caster.transform);
+        glm::mat4 lightModel = lightView * caster.transform;
+        float scale = std::max(glm::length(glm::vec3(caster.transform[0])), std::max(glm::length(glm::vec3(caster.transform[1])), glm::length(glm::vec3(caster.transform[2]))));
+
+        for(Mesh &mesh : caster.model->meshes)
+        {
+            glm::vec3 meshCenter = glm::vec3(lightModel * glm::vec4(mesh.boundsCenter, 1.0f));
+            float meshRadius = mesh.boundsRadius * scale;
+
+            // Outside of box sideways, or entirely behind it (casters in front still cast onto the box, depth clamp keeps them)
+            if(std::abs(meshCenter.x - center.x) > radius + meshRadius || std::abs(meshCenter.y - center.y) > radius + meshRadius)
+                continue;
+            if(meshCenter.z + meshRadius < center.z - radius)
+                continue;
+
+            mesh.drawPositions();
+            drawnMeshCount++;
+        }
+    }
+}
+
+void CascadedShadowMap::update(const glm::mat4 &view, float fov, float aspect, float nearPlane, glm::vec3 lightDirection, const std::vector<ShadowCaster> &casters)
+{
+    // Splits and light space both change, nothing cached is usable
+    if(lightDirection != this->lightDirection || fov != this->fov || aspect != this->aspect || nearPlane != this->nearPlane)
+        invalidateStatic();
+    this->lightDirection = lightDirection;
+    this->fov = fov;
+    this->aspect = aspect;
+    this->nearPlane = nearPlane;
+
+    // Light looks along its direction from origin, so light space only rotates and snapping in it is stable
+    glm::vec3 direction = glm::normalize(lightDirection);
+    glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), direction, up);
+
+    glm::mat4 inverseView = glm::inverse(view);
+    float tanY = std::tan(fov * 0.5f);
+    float tanX = tanY * aspect;
+    float diagonal = tanX * tanX + tanY * tanY;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glViewport(0, 0, resolution, resolution);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    // Casters between light and near plane of a cascade are clamped instead of clipped
+    glEnable(GL_DEPTH_CLAMP);
+    // Slope scaled bias against shadow acne
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+
+    depthShader.use();
+    drawnMeshCount = 0;
+
+    float splitNear = nearPlane;
+    for(unsigned int i = 0; i < cascadeCount; i++)
+    {
+        ShadowCascade &cascade = cascades[i];
+
+        // Practical split scheme
+        float ratio = float(i + 1) / cascadeCount;
+        float logarithmic = nearPlane * std::pow(shadowDistance / nearPlane, ratio);
+        float uniform = nearPlane + (shadowDistance - nearPlane) * ratio;
+        cascade.splitFar = splitLambda * logarithmic + (1.0f - splitLambda) * uniform;
+
+        // Smallest sphere around frustum slice lies on view axis, its size doesn't depend on camera orientation
+        float splitFar = cascade.splitFar;
+        float centerDepth = std::min(0.5f * (splitFar + splitNear) * (1.0f + diagonal), splitFar);
+        float radius = std::sqrt(splitFar * splitFar * diagonal + (splitFar - centerDepth) * (splitFar - centerDepth));
+        glm::vec3 center = glm::vec3(lightView * inverseView * glm::vec4(0.0f, 0.0f, -centerDepth, 1.0f));
+        splitNear = splitFar;
+
+        bool cached = i >= cachedCascadeStart;
+        if(cached)
+        {
+            // Move cached box only when slice sphere no longer fits inside it
+            if(!cascade.staticValid || glm::length(center - cascade.cachedCenter) + radius > cascade.cachedRadius)
+            {
+                cascade.cachedRadius = radius * SHADOW_CACHE_MARGIN;
+                cascade.texelSize = 2.0f * cascade.cachedRadius / resolution;
+                cascade.cachedCenter = glm::vec3(std::floor(center.x / cascade.texelSize) * cascade.texelSize, std::floor(center.y / cascade.texelSize) * cascade.texelSize, center.z);
+                cascade.staticValid = false;
+            }
+            center = cascade.cachedCenter;
+            radius = cascade.cachedRadius;
+        }
+        else
+        {
+            // Snap box to whole texels, so the same world position always falls on the same texel
+            cascade.texelSize = 2.0f * radius / resolution;
+            center.x = std::floor(center.x / cascade.texelSize) * cascade.texelSize;
+            center.y = std::floor(center.y / cascade.texelSize) * cascade.texelSize;
+        }
+
+        glm::mat4 lightProjection = glm::ortho(center.x - radius, center.x + radius, center.y - radius, center.y + radius, -center.z - radius, -center.z + radius);
+        cascade.lightSpaceMatrix = lightProjection * lightView;
+        depthShader.setMatrix4fv("lightSpaceMatrix", 1, GL_FALSE, cascade.lightSpaceMatrix);
+
+        if(cached)
+        {
+            unsigned int staticLayer = i - cachedCascadeStart;
+            glBindFramebuffer(GL_FRAMEBUFFER, staticFramebuffer);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticDepthArray, 0, staticLayer);
+
+            if(!cascade.staticValid)
+            {
+                glClear(GL_DEPTH_BUFFER_BIT);
+                drawCasters(casters, lightView, center, radius, true);
+                cascade.staticValid = true;
+            }
+
+            // Start from cached static depth, then add dynamic casters
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+            glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, i);
+            glBlitFramebuffer(0, 0, resolution, resolution, 0, 0, resolution, resolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            drawCasters(casters, lightView, center, radius, false);
+        }
+        else
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, i);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            drawCasters(casters, lightView, center, radius, true);
+            drawCasters(casters, lightView, center, radius, false);
+        }
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDisable(GL_DEPTH_CLAMP);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void CascadedShadowMap::bind(Shader &shader, unsigned int textureUnit)
+{
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.setInt("shadowMap", textureUnit);
+    shader.setInt("cascadeCount", cascadeCount);
+    for(unsigned int i = 0; i < cascadeCount; i++)
+    {
+        std::string index = "[" + std::to_string(i) + "]";
+        shader.setMatrix4fv("lightSpaceMatrices" + index, 1, GL_FALSE, cascades[i].lightSpaceMatrix);
+        shader.setFloat("cascadeSplits" + index, cascades[i].splitFar);
+        shader.setFloat("cascadeTexelSizes" + index, cascades[i].texelSize);
+    }
+}
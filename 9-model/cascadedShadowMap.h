@@ -0,0 +1,126 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "shader.h"
+#include "model.h"
+
+constexpr unsigned int MAX_SHADOW_CASCADES = 4;     // Injected into light.fs
+// Cached cascades cover this much more than they need, so they can stay in place (and keep their static depth) while camera moves
+constexpr float SHADOW_CACHE_MARGIN = 1.5f;
+
+/**
+ * @brief Struct ShadowCaster is a model instance drawn into shadow maps.
+ * Static casters are cached in far cascades, dynamic casters are redrawn every frame.
+*/
+struct ShadowCaster
+{
+    Model* model;
+    glm::mat4 transform;
+    bool isStatic;
+};
+
+/**
+ * @brief Struct ShadowCascade stores state of one cascade.
+*/
+struct ShadowCascade
+{
+    float splitFar;                 // View depth where cascade ends
+    glm::mat4 lightSpaceMatrix;     // World to light clip space
+    float texelSize;                // World size of one shadow map texel
+
+    // Cached cascades only
+    bool staticValid;               // Static depth layer matches current box
+    glm::vec3 cachedCenter;         // Light space center of cached box
+    float cachedRadius;             // Half size of cached box
+};
+
+/**
+ * @brief Class CascadedShadowMap renders directional light shadows into a depth array texture, one layer per cascade.
+ * View frustum up to shadowDistance is split with the practical split scheme (blend of logarithmic and uniform splits),
+ * every cascade is fit around its slice's bounding sphere and snapped to whole texels so shadows don't shimmer when camera moves.
+ *
+ * Far cascades keep static casters in a separate cached depth array that is only re-rendered when the light, the projection or
+ * static geometry changes, or camera leaves the (enlarged) cached box. Every frame those layers are just copied and dynamic casters drawn on top.
+ * Casters are culled per cascade and drawn with a position-only vertex stream.
+*/
+class CascadedShadowMap
+{
+private:
+    unsigned int cascadeCount;
+    unsigned int cachedCascadeStart;    // First cascade that caches static casters
+    unsigned int resolution;
+    float shadowDistance;
+    float splitLambda;
+
+    ShadowCascade cascades[MAX_SHADOW_CASCADES];
+
+    unsigned int depthArray;            // Sampled by lighting, cascadeCount layers
+    unsigned int staticDepthArray;      // Cached static depth of cached cascades
+    unsigned int framebuffer;
+    unsigned int staticFramebuffer;
+
+    Shader depthShader;
+
+    // Inputs of last update, cache is dropped when any changes
+    glm::vec3 lightDirection;
+    float fov, aspect, nearPlane;
+
+    unsigned int drawnMeshCount;        // Meshes drawn into shadow maps in last update
+
+    unsigned int createDepthArray(unsigned int layers, bool comparison);
+
+    /**
+     * @brief Draw meshes of casters that touch cascade's box into currently bound layer.
+     * @param center Light space center of box.
+     * @param radius Half size of box.
+     * @param isStatic Whether to draw static or dynamic casters.
+    */
+    void drawCasters(const std::vector<ShadowCaster> &casters, const glm::mat4 &lightView, glm::vec3 center, float radius, bool isStatic);
+
+public:
+    /**
+     * @brief Constructor to create shadow map arrays.
+     * @param shaderDirectory Directory with shadowDepth shaders.
+     * @param cascadeCount Number of cascades (2 to MAX_SHADOW_CASCADES).
+     * @param resolution Width and height of every cascade.
+     * @param shadowDistance View depth where shadows end.
+     * @param splitLambda 0 gives uniform splits, 1 logarithmic splits.
+    */
+    CascadedShadowMap(const std::string &shaderDirectory, unsigned int cascadeCount = 3, unsigned int resolution = 2048, float shadowDistance = 50.0f, float splitLambda = 0.75f);
+    ~CascadedShadowMap();
+
+    /**
+     * @brief Fit cascades to camera and render casters, changes viewport and framebuffer binding and restores them.
+     * @param view View matrix of camera.
+     * @param fov Vertical field of view in radians.
+     * @param aspect Aspect ratio of viewport.
+     * @param nearPlane Camera near plane.
+     * @param lightDirection Direction directional light shines in.
+     * @param casters All shadow casters.
+    */
+    void update(const glm::mat4 &view, float fov, float aspect, float nearPlane, glm::vec3 lightDirection, const std::vector<ShadowCaster> &casters);
+
+    /**
+     * @brief Bind shadow map and set cascade uniforms of shader.
+     * @param shader Lighting shader, must be in use.
+     * @param textureUnit Texture unit to bind shadow map to.
+    */
+    void bind(Shader &shader, unsigned int textureUnit);
+
+    /**
+     * @brief Re-render cached cascades on next update, call when static geometry changes.
+    */
+    void invalidateStatic();
+
+    unsigned int getDrawnMeshCount() const { return drawnMeshCount; };
+};
@@ -0,0 +1,265 @@
+#include "clusteredLighting.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+ClusteredLighting::ClusteredLighting()
+{
+    nearPlane = 0.1f;
+    farPlane = 100.0f;
+    lightCount = 0;
+
+    boundsMinX.resize(CLUSTER_COUNT);
+    boundsMinY.resize(CLUSTER_COUNT);
+    boundsMaxX.resize(CLUSTER_COUNT);
+    boundsMaxY.resize(CLUSTER_COUNT);
+    clusterGrid.resize(CLUSTER_COUNT * 2);
+    sliceThread.resize(CLUSTER_Z);
+
+    threadIndices.resize(threadPool.getThreadCount());
+    tileLights.resize(threadPool.getThreadCount(), std::vector<std::vector<uint32_t>>(CLUSTER_TILES));
+
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexelCount);
+
+    createBufferTexture(lightBuffer, lightTexture, GL_RGBA32F);
+    createBufferTexture(gridBuffer, gridTexture, GL_RG32UI);
+    createBufferTexture(indexBuffer, indexTexture, GL_R32UI);
+
+    setProjection(glm::radians(45.0f), 800.0f / 600.0f, nearPlane, farPlane);
+}
+
+ClusteredLighting::~ClusteredLighting()
+{
+    glDeleteTextures(1, &lightTexture);
+    glDeleteTextures(1, &gridTexture);
+    glDeleteTextures(1, &indexTexture);
+    glDeleteBuffers(1, &lightBuffer);
+    glDeleteBuffers(1, &gridBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+}
+
+void ClusteredLighting::createBufferTexture(GLuint &buffer, GLuint &texture, GLenum internalFormat)
+{
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    // Buffer texture can't be empty, start with a single texel
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, buffer);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLighting::setProjection(float fov, float aspect, float nearPlane, float farPlane)
+{
+    this->nearPlane = nearPlane;
+    this->farPlane = farPlane;
+
+    float tanY = std::tan(fov * 0.5f);
+    float tanX = tanY * aspect;
+
+    for(unsigned int z = 0; z < CLUSTER_Z; z++)
+    {
+        // Exponential slicing keeps froxels roughly cubic, near slices are thin and far slices thick
+        sliceNear[z] = nearPlane * std::pow(farPlane / nearPlane, float(z) / CLUSTER_Z);
+        sliceFar[z] = nearPlane * std::pow(farPlane / nearPlane, float(z + 1) / CLUSTER_Z);
+
+        for(unsigned int y = 0; y < CLUSTER_Y; y++)
+        {
+            float bottom = (-1.0f + 2.0f * y / CLUSTER_Y) * tanY;
+            float top = (-1.0f + 2.0f * (y + 1) / CLUSTER_Y) * tanY;
+
+            for(unsigned int x = 0; x < CLUSTER_X; x++)
+            {
+                float left = (-1.0f + 2.0f * x / CLUSTER_X) * tanX;
+                float right = (-1.0f + 2.0f * (x + 1) / CLUSTER_X) * tanX;
+
+                // Tile edges are planes through the eye, so the AABB spans both ends of slice
+                unsigned int cluster = z * CLUSTER_TILES + y * CLUSTER_X + x;
+                boundsMinX[cluster] = std::min(left * sliceNear[z], left * sliceFar[z]);
+                boundsMaxX[cluster] = std::max(right * sliceNear[z], right * sliceFar[z]);
+                boundsMinY[cluster] = std::min(bottom * sliceNear[z], bottom * sliceFar[z]);
+                boundsMaxY[cluster] = std::max(top * sliceNear[z], top * sliceFar[z]);
+            }
+        }
+    }
+}
+
+void ClusteredLighting::assignSlices(unsigned int begin, unsigned int end, unsigned int threadIndex)
+{
+    std::vector<uint32_t> &indices = threadIndices[threadIndex];
+    std::vector<std::vector<uint32_t>> &tiles = tileLights[threadIndex];
+    indices.clear();
+
+    for(unsigned int z = begin; z < end; z++)
+    {
+        sliceThread[z] = threadIndex;
+        for(unsigned int tile = 0; tile < CLUSTER_TILES; tile++)
+            tiles[tile].clear();
+
+        const float* minX = &boundsMinX[z * CLUSTER_TILES];
+        const float* maxX = &boundsMaxX[z * CLUSTER_TILES];
+        const float* minY = &boundsMinY[z * CLUSTER_TILES];
+        const float* maxY = &boundsMaxY[z * CLUSTER_TILES];
+
+        for(unsigned int light = 0; light < lightCount; light++)
+        {
+            const glm::vec4 &sphere = viewSpheres[light];
+
+            // Distance along depth is the same for the whole slice, reject slice before touching tiles
+            float depth = -sphere.z;
+            float dz = std::max(std::max(sliceNear[z] - depth, depth - sliceFar[z]), 0.0f);
+            float remaining = sphere.w * sphere.w - dz * dz;
+            if(remaining < 0.0f)
+                continue;
+
+            unsigned int tile = 0;
+#ifdef __SSE2__
+            // Squared distance from sphere center to 4 tile AABBs at once
+            __m128 centerX = _mm_set1_ps(sphere.x);
+            __m128 centerY = _mm_set1_ps(sphere.y);
+            __m128 radius = _mm_set1_ps(remaining);
+            __m128 zero = _mm_setzero_ps();
+            for(; tile + 4 <= CLUSTER_TILES; tile += 4)
+            {
+                __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(minX + tile), centerX), _mm_sub_ps(centerX, _mm_loadu_ps(maxX + tile))), zero);
+                __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(minY + tile), centerY), _mm_sub_ps(centerY, _mm_loadu_ps(maxY + tile))), zero);
+                __m128 distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+                int mask = _mm_movemask_ps(_mm_cmple_ps(distance, radius));
+                if(mask == 0)
+                    continue;
+
+                for(unsigned int i = 0; i < 4; i++)
+                {
+                    if(mask & (1 << i))
+                        tiles[tile + i].push_back(light);
+                }
+            }
+#endif
+            for(; tile < CLUSTER_TILES; tile++)
+            {
+                float dx = std::max(std::max(minX[tile] - sphere.x, sphere.x - maxX[tile]), 0.0f);
+                float dy = std::max(std::max(minY[tile] - sphere.y, sphere.y - maxY[tile]), 0.0f);
+                if(dx * dx + dy * dy <= remaining)
+                    tiles[tile].push_back(light);
+            }
+        }
+
+        // Offsets are local to this thread, update() shifts them once all threads are done
+        for(unsigned int tile = 0; tile < CLUSTER_TILES; tile++)
+        {
+            unsigned int cluster = z * CLUSTER_TILES + tile;
+            clusterGrid[cluster * 2] = indices.size();
+            clusterGrid[cluster * 2 + 1] = tiles[tile].size();
+            indices.insert(indices.end(), tiles[tile].begin(), tiles[tile].end());
+        }
+    }
+}
+
+void ClusteredLighting::update(const glm::mat4 &view, const std::vector<PointLight> &pointLights, unsigned int pointLightCount, const std::vector<SpotLight> &spotLights, unsigned int spotLightCount)
+{
+    pointLightCount = std::min<unsigned int>(pointLightCount, pointLights.size());
+    spotLightCount = std::min<unsigned int>(spotLightCount, spotLights.size());
+
+    lightCount = pointLightCount + spotLightCount;
+    if(lightCount * LIGHT_TEXELS > (unsigned int)maxTexelCount)
+    {
+        std::cerr << "ERROR::ClusteredLighting::update()::too many lights for texture buffer, extra lights are ignored" << std::endl;
+        lightCount = maxTexelCount / LIGHT_TEXELS;
+    }
+
+    packedLights.resize(lightCount * LIGHT_TEXELS);
+    viewSpheres.resize(lightCount);
+
+    for(unsigned int i = 0; i < lightCount; i++)
+    {
+        glm::vec4* texels = &packedLights[i * LIGHT_TEXELS];
+        if(i < pointLightCount)
+            pointLights[i].pack(texels);
+        else
+            spotLights[i - pointLightCount].pack(texels);
+
+        // Spot lights are culled as spheres, the cone only trims shading in the fragment shader
+        viewSpheres[i] = glm::vec4(glm::vec3(view * glm::vec4(glm::vec3(texels[0]), 1.0f)), texels[0].w);
+    }
+
+    threadPool.parallelFor(CLUSTER_Z, [this](unsigned int begin, unsigned int end, unsigned int threadIndex)
+    {
+        assignSlices(begin, end, threadIndex);
+    });
+
+    // Threads handle increasing ranges of slices, so their lists are concatenated in thread order
+    std::vector<uint32_t> threadOffsets(threadIndices.size(), 0);
+    unsigned int indexCount = 0;
+    for(unsigned int i = 0; i < threadIndices.size(); i++)
+    {
+        threadOffsets[i] = indexCount;
+        indexCount += threadIndices[i].size();
+    }
+
+    if(indexCount > (unsigned int)maxTexelCount)
+        std::cerr << "ERROR::ClusteredLighting::update()::light index list doesn't fit texture buffer, some lights are dropped" << std::endl;
+
+    for(unsigned int cluster = 0; cluster < CLUSTER_COUNT; cluster++)
+    {
+        uint32_t &offset = clusterGrid[cluster * 2];
+        uint32_t &count = clusterGrid[cluster * 2 + 1];
+        offset += threadOffsets[sliceThread[cluster / CLUSTER_TILES]];
+        if(offset >= (uint32_t)maxTexelCount)
+            count = 0;
+        else
+            count = std::min(count, (uint32_t)maxTexelCount - offset);
+    }
+
+    // Orphan and refill every buffer, texture buffers keep pointing at the same buffer names
+    glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, std::max<std::size_t>(packedLights.size(), 1) * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    if(!packedLights.empty())
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, packedLights.size() * sizeof(glm::vec4), packedLights.data());
+
+    glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, clusterGrid.size() * sizeof(uint32_t), clusterGrid.data(), GL_STREAM_DRAW);
+
+    indexCount = std::min(indexCount, (unsigned int)maxTexelCount);
+    glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, std::max(indexCount, 1u) * sizeof(uint32_t), nullptr, GL_STREAM_DRAW);
+    GLintptr writeOffset = 0;
+    for(unsigned int i = 0; i < threadIndices.size() && (unsigned int)writeOffset < indexCount; i++)
+    {
+        GLsizeiptr writeCount = std::min<GLsizeiptr>(threadIndices[i].size(), indexCount - writeOffset);
+        if(writeCount > 0)
+            glBufferSubData(GL_TEXTURE_BUFFER, writeOffset * sizeof(uint32_t), writeCount * sizeof(uint32_t), threadIndices[i].data());
+        writeOffset += writeCount;
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLighting::bind(Shader &shader, float screenWidth, float screenHeight)
+{
+    glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+    glActiveTexture(GL_TEXTURE0 + CLUSTER_GRID_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+    glActiveTexture(GL_TEXTURE0 + LIGHT_INDEX_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.setInt("lightData", LIGHT_DATA_TEXTURE_UNIT);
+    shader.setInt("clusterGrid", CLUSTER_GRID_TEXTURE_UNIT);
+    shader.setInt("lightIndices", LIGHT_INDEX_TEXTURE_UNIT);
+
+    // slice = log(depth) * scale + bias, the inverse of exponential slicing in setProjection()
+    float logRatio = std::log(farPlane / nearPlane);
+    shader.setFloat("clusterScale", CLUSTER_Z / logRatio);
+    shader.setFloat("clusterBias", -(CLUSTER_Z * std::log(nearPlane)) / logRatio);
+    glm::vec2 tileSize(screenWidth / CLUSTER_X, screenHeight / CLUSTER_Y);
+    shader.setVec2("clusterTileSize", glm::value_ptr(tileSize));
+}
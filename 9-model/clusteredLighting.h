@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "shader.h"
+#include "pointLight.h"
+#include "spotLight.h"
+#include "threadPool.h"
+
+// Froxel grid dimensions (screen tiles on X and Y, exponential depth slices on Z)
+constexpr unsigned int CLUSTER_X = 16;
+constexpr unsigned int CLUSTER_Y = 9;
+constexpr unsigned int CLUSTER_Z = 24;
+constexpr unsigned int CLUSTER_TILES = CLUSTER_X * CLUSTER_Y;
+constexpr unsigned int CLUSTER_COUNT = CLUSTER_TILES * CLUSTER_Z;
+
+// Texture units used for light buffers, kept high so they never collide with material textures
+constexpr unsigned int LIGHT_DATA_TEXTURE_UNIT = 13;
+constexpr unsigned int CLUSTER_GRID_TEXTURE_UNIT = 14;
+constexpr unsigned int LIGHT_INDEX_TEXTURE_UNIT = 15;
+
+/**
+ * @brief Class ClusteredLighting implements clustered forward shading.
+ * View frustum is split into a 3D grid of froxels, every frame lights are assigned to the froxels they touch on the CPU
+ * (sphere vs. froxel bounds, 4 froxels per SIMD test, depth slices spread over threads) and uploaded as texture buffers:
+ * packed light data, per-froxel (offset, count) and a flat light index list. Fragment shader only loops over lights of its own froxel,
+ * so cost per fragment depends on lights nearby instead of the total number of lights.
+*/
+class ClusteredLighting
+{
+private:
+    ThreadPool threadPool;
+
+    float nearPlane, farPlane;
+    // View space bounds of every froxel, stored as separate arrays (slice major, then tile) so 4 tiles are tested at once
+    std::vector<float> boundsMinX, boundsMinY, boundsMaxX, boundsMaxY;
+    // View space depth range of every slice (positive distances)
+    float sliceNear[CLUSTER_Z], sliceFar[CLUSTER_Z];
+
+    unsigned int lightCount;
+    std::vector<glm::vec4> packedLights;        // LIGHT_TEXELS texels per light
+    std::vector<glm::vec4> viewSpheres;         // View space position (xyz) and range (w) per light
+
+    // Per-thread assignment results, thread i handles a contiguous range of slices
+    std::vector<std::vector<uint32_t>> threadIndices;           // Light indices in froxel order
+    std::vector<std::vector<std::vector<uint32_t>>> tileLights; // Scratch lists of every tile of current slice
+    std::vector<unsigned int> sliceThread;                      // Thread that handled each slice
+    std::vector<uint32_t> clusterGrid;                          // (offset, count) of every froxel
+
+    GLint maxTexelCount;
+    GLuint lightBuffer, lightTexture;
+    GLuint gridBuffer, gridTexture;
+    GLuint indexBuffer, indexTexture;
+
+    /**
+     * @brief Create a buffer texture.
+     * @param buffer Buffer object that stores texels.
+     * @param texture Texture object that views buffer.
+     * @param internalFormat Format of texels.
+    */
+    void createBufferTexture(GLuint &buffer, GLuint &texture, GLenum internalFormat);
+
+    /**
+     * @brief Assign lights to froxels of slices [begin, end).
+     * @param begin First slice.
+     * @param end One past last slice.
+     * @param threadIndex Thread running the assignment.
+    */
+    void assignSlices(unsigned int begin, unsigned int end, unsigned int threadIndex);
+
+public:
+    ClusteredLighting();
+    ~ClusteredLighting();
+
+    /**
+     * @brief Rebuild froxel bounds, must be called whenever projection changes.
+     * @param fov Vertical field of view in radians.
+     * @param aspect Aspect ratio of viewport.
+     * @param nearPlane Distance of near plane.
+     * @param farPlane Distance of far plane.
+    */
+    void setProjection(float fov, float aspect, float nearPlane, float farPlane);
+
+    /**
+     * @brief Pack lights, assign them to froxels and upload buffers.
+     * @param view View matrix of camera.
+     * @param pointLights Point lights in scene.
+     * @param pointLightCount Number of point lights used, starting from the first one.
+     * @param spotLights Spot lights in scene.
+     * @param spotLightCount Number of spot lights used, starting from the first one.
+    */
+    void update(const glm::mat4 &view, const std::vector<PointLight> &pointLights, unsigned int pointLightCount, const std::vector<SpotLight> &spotLights, unsigned int spotLightCount);
+
+    /**
+     * @brief Bind light buffers and set cluster uniforms of shader.
+     * @param shader Shader that uses clustered lighting, must be in use.
+     * @param screenWidth Width of framebuffer.
+     * @param screenHeight Height of framebuffer.
+    */
+    void bind(Shader &shader, float screenWidth, float screenHeight);
+
+    unsigned int getLightCount() const { return lightCount; };
+};
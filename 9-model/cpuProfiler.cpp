@@ -0,0 +1,174 @@
+#include "cpuProfiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <iomanip>
+
+std::atomic<bool> CpuProfiler::capturing(false);
+
+// Events that started before this belong to an earlier capture
+static std::atomic<uint64_t> captureStart(0);
+
+std::mutex& CpuProfiler::registryMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::vector<CpuThreadEvents*>& CpuProfiler::registry()
+{
+    // Rings are never freed, a thread's events outlive it
+    static std::vector<CpuThreadEvents*> threads;
+    return threads;
+}
+
+std::vector<CpuCounter>& CpuProfiler::counters()
+{
+    static std::vector<CpuCounter> samples;
+    return samples;
+}
+
+// Ring of calling thread (nullptr until its first event) and the name it gets once the ring exists
+static thread_local CpuThreadEvents* currentThread = nullptr;
+static thread_local std::string currentThreadName;
+
+CpuThreadEvents& CpuProfiler::threadEvents()
+{
+    if(currentThread == nullptr)
+    {
+        currentThread = new CpuThreadEvents();
+        currentThread->count = 0;
+
+        std::lock_guard<std::mutex> lock(registryMutex());
+        currentThread->threadId = registry().size() + 1;
+        currentThread->threadName = currentThreadName.empty() ? "Thread " + std::to_string(currentThread->threadId) : currentThreadName;
+        registry().push_back(currentThread);
+    }
+    return *currentThread;
+}
+
+uint64_t CpuProfiler::now()
+{
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    // Never 0, CpuZone uses 0 for zones started while not capturing
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count() + 1;
+}
+
+void CpuProfiler::setThreadName(const std::string &name)
+{
+    // Threads that never record a zone never get a ring, the name waits for the first one
+    currentThreadName = name;
+    if(currentThread == nullptr)
+        return;
+    std::lock_guard<std::mutex> lock(registryMutex());
+    currentThread->threadName = name;
+}
+
+void CpuProfiler::counter(const char* name, double value)
+{
+    if(!isCapturing())
+        return;
+    uint64_t time = now();
+    std::lock_guard<std::mutex> lock(registryMutex());
+    counters().push_back({ name, time, value });
+}
+
+void CpuProfiler::beginCapture()
+{
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        counters().clear();
+    }
+    captureStart = now();
+    capturing = true;
+}
+
+// Minimal JSON string escaping, zone and thread names are plain identifiers in practice
+static void writeJsonString(std::ostream &stream, const std::string &text)
+{
+    stream << '"';
+    for(char c : text)
+    {
+        if(c == '"' || c == '\\')
+            stream << '\\' << c;
+        else if((unsigned char)c < 0x20)
+            stream << ' ';
+        else
+            stream << c;
+    }
+    stream << '"';
+}
+
+bool CpuProfiler::endCapture(const std::string &path)
+{
+    capturing = false;
+    uint64_t start = captureStart;
+
+    std::ofstream file(path);
+    if(!file)
+    {
+        std::cerr << "ERROR::CpuProfiler::can't write trace to " << path << std::endl;
+        return false;
+    }
+
+    std::vector<CpuThreadEvents*> threads;
+    std::vector<std::string> names;
+    std::vector<CpuCounter> samples;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        threads = registry();
+        for(CpuThreadEvents* thread : threads)
+            names.push_back(thread->threadName);
+        samples.swap(counters());
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::vector<CpuEvent> events;
+    for(unsigned int i = 0; i < threads.size(); i++)
+    {
+        CpuThreadEvents &thread = *threads[i];
+        file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.threadId << ",\"args\":{\"name\":";
+        writeJsonString(file, names[i]);
+        file << "}}";
+        first = false;
+
+        // Zones that were open when capture stopped may still be written, the ring is copied and then validated
+        uint64_t end = thread.count.load(std::memory_order_acquire);
+        uint64_t begin = end > CPU_PROFILER_RING_SIZE ? end - CPU_PROFILER_RING_SIZE : 0;
+        events.clear();
+        for(uint64_t index = begin; index < end; index++)
+            events.push_back(thread.events[index % CPU_PROFILER_RING_SIZE]);
+
+        // Once the ring is full, whatever the owner wrote meanwhile (plus one event in progress) replaced the oldest copies
+        uint64_t overwrittenEnd = thread.count.load(std::memory_order_acquire) + 1;
+        size_t skip = overwrittenEnd > begin + CPU_PROFILER_RING_SIZE ? std::min<uint64_t>(overwrittenEnd - begin - CPU_PROFILER_RING_SIZE, events.size()) : 0;
+
+        for(size_t j = skip; j < events.size(); j++)
+        {
+            const CpuEvent &event = events[j];
+            if(event.start < start)
+                continue;
+
+            file << ",\n{\"name\":";
+            writeJsonString(file, event.name);
+            // Trace timestamps are microseconds
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.threadId << ",\"ts\":" << event.start / 1000.0
+                 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+        }
+    }
+
+    // Counter events belong to the process, every name is its own track
+    for(const CpuCounter &sample : samples)
+    {
+        file << (first ? "" : ",") << "\n{\"name\":";
+        writeJsonString(file, sample.name);
+        file << ",\"ph\":\"C\",\"pid\":1,\"ts\":" << sample.time / 1000.0 << ",\"args\":{\"value\":" << sample.value << "}}";
+        first = false;
+    }
+    file << "\n]}\n";
+
+    return true;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+constexpr size_t CPU_PROFILER_RING_SIZE = 1 << 16;     // Events kept per thread, older ones are overwritten
+
+/**
+ * @brief Struct CpuEvent stores one finished zone.
+*/
+struct CpuEvent
+{
+    const char* name;       // String literal, never copied
+    uint64_t start;         // Nanoseconds since profiler start
+    uint64_t end;
+};
+
+/**
+ * @brief Struct CpuCounter stores one sample of a named value.
+*/
+struct CpuCounter
+{
+    const char* name;       // String literal, never copied
+    uint64_t time;          // Nanoseconds since profiler start
+    double value;
+};
+
+/**
+ * @brief Struct CpuThreadEvents is the event ring of one thread.
+ *
+ * Only the owning thread writes events and count, readers copy events and then check count again to drop the ones
+ * that were overwritten meanwhile, so neither side locks.
+*/
+struct CpuThreadEvents
+{
+    std::array<CpuEvent, CPU_PROFILER_RING_SIZE> events;
+    std::atomic<uint64_t> count;        // Events ever written, next one goes to count % CPU_PROFILER_RING_SIZE
+    unsigned int threadId;
+    std::string threadName;             // Guarded by registry mutex
+};
+
+/**
+ * @brief Class CpuProfiler records named CPU zones of every thread into per-thread rings and writes them as a Chrome trace.
+ *
+ * Zones are recorded while capturing, otherwise a zone costs one relaxed atomic load. A thread's ring is allocated on its
+ * first event and kept until exit, so threads that already finished still show up in the trace. The trace is Chrome's
+ * JSON trace event format, chrome://tracing and ui.perfetto.dev both open it.
+ *
+ * Counters (per-frame values like GL call counts) are samples in one shared list behind the registry mutex, each name
+ * becomes a graph in the trace. They are meant for a few samples per frame, not for hot paths.
+*/
+class CpuProfiler
+{
+private:
+    static std::atomic<bool> capturing;
+
+    static std::mutex& registryMutex();
+    static std::vector<CpuThreadEvents*>& registry();
+    static std::vector<CpuCounter>& counters();      // Guarded by registry mutex
+
+public:
+    /**
+     * @brief Ring of calling thread, created on first use.
+    */
+    static CpuThreadEvents& threadEvents();
+
+    /**
+     * @brief Nanoseconds since first call.
+    */
+    static uint64_t now();
+
+    /**
+     * @brief Record a finished zone on calling thread, prefer CPU_ZONE over calling this directly.
+    */
+    static void record(const char* name, uint64_t start, uint64_t end)
+    {
+        CpuThreadEvents &thread = threadEvents();
+        uint64_t index = thread.count.load(std::memory_order_relaxed);
+        thread.events[index % CPU_PROFILER_RING_SIZE] = { name, start, end };
+        thread.count.store(index + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Record a sample of a counter while capturing, name must be a string literal.
+    */
+    static void counter(const char* name, double value);
+
+    /**
+     * @brief Name calling thread in traces, threads are numbered otherwise. Doesn't allocate a ring, only recording does.
+    */
+    static void setThreadName(const std::string &name);
+
+    /**
+     * @brief Start recording zones, events of earlier captures are dropped.
+    */
+    static void beginCapture();
+
+    /**
+     * @brief Stop recording and write everything recorded since beginCapture() to a Chrome trace file.
+     * @return False if file can't be written.
+    */
+    static bool endCapture(const std::string &path);
+
+    static bool isCapturing() { return capturing.load(std::memory_order_relaxed); };
+};
+
+/**
+ * @brief Class CpuZone records the time between its construction and destruction as a zone.
+*/
+class CpuZone
+{
+private:
+    const char* name;
+    uint64_t start;
+
+public:
+    CpuZone(const char* name) : name(name), start(CpuProfiler::isCapturing() ? CpuProfiler::now() : 0) {}
+    ~CpuZone()
+    {
+        if(start != 0)
+            CpuProfiler::record(name, start, CpuProfiler::now());
+    }
+    CpuZone(const CpuZone &) = delete;
+    CpuZone& operator=(const CpuZone &) = delete;
+};
+
+// Define CPU_PROFILER_DISABLED to compile zones out entirely
+#ifndef CPU_PROFILER_DISABLED
+#define CPU_ZONE_CONCAT_INNER(a, b) a##b
+#define CPU_ZONE_CONCAT(a, b) CPU_ZONE_CONCAT_INNER(a, b)
+/**
+ * @brief Record a zone from here to end of enclosing scope, name must be a string literal.
+*/
+#define CPU_ZONE(name) CpuZone CPU_ZONE_CONCAT(cpuZone, __LINE__)(name)
+#else
+#define CPU_ZONE(name)
+#endif
@@ -58,7 +58,13 @@ int glWindow::initialise()
 
     // Initialize GLEW
     glewExperimental = GL_TRUE;
-    if(glewInit() != GLEW_OK)
+    GLenum glewStatus = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLEW built for GLX finds no display on surfaceless EGL contexts (headless benchmark), functions still load
+    if(glewStatus == GLEW_ERROR_NO_GLX_DISPLAY)
+        glewStatus = GLEW_OK;
+#endif
+    if(glewStatus != GLEW_OK)
     {
         std::cerr << "Failed to initialize GLEW" << std::endl;
         glfwDestroyWindow(window);
@@ -85,3 +91,16 @@ void glWindow::frameBufferSizeCallback(GLFWwindow* window, int width, int height
 {
     glViewport(0, 0, width, height);
 }
+
+GLFWwindow* glWindow::createSharedContext()
+{
+    // Window hints from initialise() still apply, so context version and profile match
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* shared = glfwCreateWindow(1, 1, "", nullptr, window);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if(!shared)
+        std::cerr << "ERROR::glWindow::failed to create shared context" << std::endl;
+
+    return shared;
+}
@@ -46,6 +46,12 @@ public:
 
     GLFWwindow* getGlWindow() { return window; }
 
+    /**
+     * @brief Create hidden 1x1 window whose context shares objects with this window's context, call on main thread.
+     * @return Hidden window, nullptr on failure.
+    */
+    GLFWwindow* createSharedContext();
+
     GLfloat getBufferWidth() { return bufferWidth; }
     GLfloat getBufferHeight() { return bufferHeight; }
 
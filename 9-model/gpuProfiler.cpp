@@ -0,0 +1,131 @@
+#include "gpuProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+GpuProfiler::GpuProfiler()
+{
+    frame = 0;
+    enabled = true;
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    for(Scope &scope : scopes)
+        glDeleteQueries(GPU_PROFILER_LATENCY * 2, &scope.queries[0][0]);
+}
+
+void GpuProfiler::collect(Scope &scope, unsigned int slot)
+{
+    if(!scope.issued[slot])
+        return;
+    scope.issued[slot] = false;
+
+    // End timestamp is written last, when it is available so is start. Start is asked too (never blocks either), so GL call
+    // counters see both result reads as non-blocking
+    GLint available = 0;
+    glGetQueryObjectiv(scope.queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available)
+        return;
+    glGetQueryObjectiv(scope.queries[slot][0], GL_QUERY_RESULT_AVAILABLE, &available);
+
+    GLuint64 start, end;
+    glGetQueryObjectui64v(scope.queries[slot][0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(scope.queries[slot][1], GL_QUERY_RESULT, &end);
+
+    float milliseconds = (end - start) / 1000000.0f;
+    if(scope.history.size() < GPU_PROFILER_HISTORY)
+        scope.history.push_back(milliseconds);
+    else
+        scope.history[scope.nextSample] = milliseconds;
+    scope.nextSample = (scope.nextSample + 1) % GPU_PROFILER_HISTORY;
+}
+
+void GpuProfiler::beginFrame()
+{
+    frame++;
+    unsigned int slot = frame % GPU_PROFILER_LATENCY;
+    for(Scope &scope : scopes)
+        collect(scope, slot);
+}
+
+int GpuProfiler::begin(const std::string &name)
+{
+    if(!enabled)
+        return -1;
+
+    auto found = scopeIndices.find(name);
+    unsigned int index;
+    if(found != scopeIndices.end())
+        index = found->second;
+    else
+    {
+        index = scopes.size();
+        scopeIndices[name] = index;
+        scopes.emplace_back();
+        Scope &scope = scopes.back();
+        scope.name = name;
+        glGenQueries(GPU_PROFILER_LATENCY * 2, &scope.queries[0][0]);
+        std::fill(scope.issued, scope.issued + GPU_PROFILER_LATENCY, false);
+        scope.history.reserve(GPU_PROFILER_HISTORY);
+        scope.nextSample = 0;
+    }
+
+    Scope &scope = scopes[index];
+    unsigned int slot = frame % GPU_PROFILER_LATENCY;
+    if(scope.issued[slot])
+    {
+        std::cerr << "ERROR::GpuProfiler::scope \"" << name << "\" measured twice in one frame" << std::endl;
+        return -1;
+    }
+
+    glQueryCounter(scope.queries[slot][0], GL_TIMESTAMP);
+    return index;
+}
+
+void GpuProfiler::end(int scope)
+{
+    if(scope < 0)
+        return;
+
+    unsigned int slot = frame % GPU_PROFILER_LATENCY;
+    glQueryCounter(scopes[scope].queries[slot][1], GL_TIMESTAMP);
+    scopes[scope].issued[slot] = true;
+}
+
+GpuScopeStats GpuProfiler::getStats(const std::string &name) const
+{
+    GpuScopeStats stats;
+    auto found = scopeIndices.find(name);
+    if(found == scopeIndices.end() || scopes[found->second].history.empty())
+        return stats;
+
+    std::vector<float> samples = scopes[found->second].history;
+    stats.samples = samples.size();
+    stats.min = *std::min_element(samples.begin(), samples.end());
+    float sum = 0.0f;
+    for(float sample : samples)
+        sum += sample;
+    stats.average = sum / samples.size();
+
+    // Smallest sample at least 99% of samples don't exceed
+    size_t rank = std::min(samples.size() - 1, (size_t)std::ceil(samples.size() * 0.99f) - 1);
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    stats.p99 = samples[rank];
+    return stats;
+}
+
+void GpuProfiler::report(std::ostream &stream) const
+{
+    std::ios::fmtflags flags = stream.flags();
+    std::streamsize precision = stream.precision();
+    for(const Scope &scope : scopes)
+    {
+        GpuScopeStats stats = getStats(scope.name);
+        stream << "GPU " << std::left << std::setw(16) << scope.name << std::right << std::fixed << std::setprecision(3)
+               << " min " << stats.min << " | avg " << stats.average << " | p99 " << stats.p99 << " ms" << std::endl;
+    }
+    stream.flags(flags);
+    stream.precision(precision);
+}
@@ -0,0 +1,275 @@
+#include "inputRecorder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+InputRecorder* InputRecorder::active = nullptr;
+
+InputRecorder::InputRecorder()
+{
+    window = nullptr;
+    cursorCallback = nullptr;
+    scrollCallback = nullptr;
+    keyCallback = nullptr;
+    nextEvent = 0;
+    frame = 0;
+    frameTime = 0.0;
+    std::fill(keys, keys + GLFW_KEY_LAST + 1, false);
+}
+
+InputRecorder::~InputRecorder()
+{
+    stop();
+}
+
+bool InputRecorder::parseArguments(int &argc, char** argv, InputOptions &options)
+{
+    int kept = 1;
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if((argument == "--record" || argument == "--replay") && hasValue)
+        {
+            options.mode = argument == "--record" ? INPUT_RECORD : INPUT_REPLAY;
+            options.path = argv[++i];
+        }
+        else if(argument == "--replay-step" && hasValue)
+        {
+            char* end;
+            options.timeStep = std::strtod(argv[++i], &end);
+            if(*end != '\0' || options.timeStep < 0.0)
+            {
+                std::cerr << "ERROR::InputRecorder::replay step has to be seconds >= 0, got " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else
+            argv[kept++] = argv[i];
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    return true;
+}
+
+bool InputRecorder::start(GLFWwindow* window, const InputOptions &options, GLFWcursorposfun cursorCallback, GLFWscrollfun scrollCallback, GLFWkeyfun keyCallback)
+{
+    this->window = window;
+    this->options = options;
+    this->cursorCallback = cursorCallback;
+    this->scrollCallback = scrollCallback;
+    this->keyCallback = keyCallback;
+
+    if(options.mode == INPUT_RECORD)
+    {
+        file.open(options.path);
+        if(!file)
+        {
+            std::cerr << "ERROR::InputRecorder::can't write recording to " << options.path << std::endl;
+            return false;
+        }
+        // Enough digits to read back the same doubles
+        file << std::setprecision(17);
+        file << "inputRecording " << INPUT_RECORDING_VERSION << "\n";
+    }
+    else if(options.mode == INPUT_REPLAY && !load())
+        return false;
+
+    active = this;
+    glfwSetCursorPosCallback(window, cursorPositionCallback);
+    glfwSetScrollCallback(window, mouseScrollCallback);
+    glfwSetKeyCallback(window, keyboardCallback);
+    return true;
+}
+
+bool InputRecorder::load()
+{
+    std::ifstream input(options.path);
+    if(!input)
+    {
+        std::cerr << "ERROR::InputRecorder::can't read recording " << options.path << std::endl;
+        return false;
+    }
+
+    std::string line, type;
+    int version = 0;
+    if(!std::getline(input, line) || !(std::istringstream(line) >> type >> version) || type != "inputRecording" || version != INPUT_RECORDING_VERSION)
+    {
+        std::cerr << "ERROR::InputRecorder::" << options.path << " isn't an input recording of version " << INPUT_RECORDING_VERSION << std::endl;
+        return false;
+    }
+
+    unsigned int lineNumber = 1;
+    while(std::getline(input, line))
+    {
+        lineNumber++;
+        std::istringstream stream(line);
+        InputEvent event = {};
+        bool valid;
+        if(!(stream >> type >> event.time))
+            valid = false;
+        else if(type == "frame")
+        {
+            frameTimes.push_back(event.time);
+            continue;
+        }
+        else if(type == "cursor" || type == "scroll")
+        {
+            event.type = type == "cursor" ? INPUT_EVENT_CURSOR : INPUT_EVENT_SCROLL;
+            valid = (bool)(stream >> event.x >> event.y);
+        }
+        else if(type == "key")
+        {
+            event.type = INPUT_EVENT_KEY;
+            valid = (bool)(stream >> event.key >> event.scancode >> event.action >> event.mods);
+        }
+        else
+            valid = false;
+
+        if(!valid)
+        {
+            std::cerr << "ERROR::InputRecorder::" << options.path << ":" << lineNumber << " malformed event" << std::endl;
+            return false;
+        }
+        events.push_back(event);
+    }
+
+    if(frameTimes.empty())
+    {
+        std::cerr << "ERROR::InputRecorder::" << options.path << " has no frames" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void InputRecorder::write(const InputEvent &event)
+{
+    switch(event.type)
+    {
+        case INPUT_EVENT_CURSOR:
+            file << "cursor " << event.time << " " << event.x << " " << event.y << "\n";
+            break;
+        case INPUT_EVENT_SCROLL:
+            file << "scroll " << event.time << " " << event.x << " " << event.y << "\n";
+            break;
+        case INPUT_EVENT_KEY:
+            file << "key " << event.time << " " << event.key << " " << event.scancode << " " << event.action << " " << event.mods << "\n";
+            break;
+    }
+}
+
+void InputRecorder::dispatch(GLFWwindow* window, const InputEvent &event)
+{
+    switch(event.type)
+    {
+        case INPUT_EVENT_CURSOR:
+            if(cursorCallback)
+                cursorCallback(window, event.x, event.y);
+            break;
+        case INPUT_EVENT_SCROLL:
+            if(scrollCallback)
+                scrollCallback(window, event.x, event.y);
+            break;
+        case INPUT_EVENT_KEY:
+            if(event.key >= 0 && event.key <= GLFW_KEY_LAST)
+                keys[event.key] = event.action != GLFW_RELEASE;
+            if(keyCallback)
+                keyCallback(window, event.key, event.scancode, event.action, event.mods);
+            break;
+    }
+}
+
+void InputRecorder::cursorPositionCallback(GLFWwindow* window, double x, double y)
+{
+    if(active->options.mode == INPUT_REPLAY)
+        return;
+    if(active->options.mode == INPUT_RECORD)
+        active->write({ INPUT_EVENT_CURSOR, glfwGetTime(), x, y, 0, 0, 0, 0 });
+    if(active->cursorCallback)
+        active->cursorCallback(window, x, y);
+}
+
+void InputRecorder::mouseScrollCallback(GLFWwindow* window, double x, double y)
+{
+    if(active->options.mode == INPUT_REPLAY)
+        return;
+    if(active->options.mode == INPUT_RECORD)
+        active->write({ INPUT_EVENT_SCROLL, glfwGetTime(), x, y, 0, 0, 0, 0 });
+    if(active->scrollCallback)
+        active->scrollCallback(window, x, y);
+}
+
+void InputRecorder::keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if(active->options.mode == INPUT_REPLAY)
+        return;
+    if(active->options.mode == INPUT_RECORD)
+    {
+        active->write({ INPUT_EVENT_KEY, glfwGetTime(), 0.0, 0.0, key, scancode, action, mods });
+        // Held keys follow recorded events only, so replay sees exactly what recording saw
+        if(key >= 0 && key <= GLFW_KEY_LAST)
+            active->keys[key] = action != GLFW_RELEASE;
+    }
+    if(active->keyCallback)
+        active->keyCallback(window, key, scancode, action, mods);
+}
+
+double InputRecorder::replayTime(unsigned int frame) const
+{
+    if(options.timeStep > 0.0)
+        return frameTimes.front() + frame * options.timeStep;
+    return frameTimes[std::min<size_t>(frame, frameTimes.size() - 1)];
+}
+
+bool InputRecorder::isDone() const
+{
+    if(options.mode != INPUT_REPLAY)
+        return false;
+    if(options.timeStep > 0.0)
+        return replayTime(frame) > frameTimes.back();
+    return frame >= frameTimes.size();
+}
+
+void InputRecorder::beginFrame(GLFWwindow* window)
+{
+    if(options.mode == INPUT_REPLAY)
+    {
+        frameTime = replayTime(frame);
+        glfwSetTime(frameTime);
+        // Events that arrived before this frame started, GLFW delivered them in the previous frame's glfwPollEvents()
+        while(nextEvent < events.size() && events[nextEvent].time <= frameTime)
+            dispatch(window, events[nextEvent++]);
+    }
+    else
+    {
+        frameTime = glfwGetTime();
+        if(options.mode == INPUT_RECORD)
+            file << "frame " << frameTime << "\n";
+    }
+    frame++;
+}
+
+bool InputRecorder::isKeyPressed(GLFWwindow* window, int key) const
+{
+    if(options.mode == INPUT_LIVE)
+        return glfwGetKey(window, key) == GLFW_PRESS;
+    return key >= 0 && key <= GLFW_KEY_LAST && keys[key];
+}
+
+void InputRecorder::stop()
+{
+    if(active == this)
+    {
+        glfwSetCursorPosCallback(window, cursorCallback);
+        glfwSetScrollCallback(window, scrollCallback);
+        glfwSetKeyCallback(window, keyCallback);
+        active = nullptr;
+    }
+    if(file.is_open())
+    {
+        file.close();
+        std::cout << "Input recorded to " << options.path << std::endl;
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <GLFW/glfw3.h>
+
+constexpr double INPUT_REPLAY_TIME_STEP = 1.0 / 60.0;     // Default simulation step of a replay, seconds
+constexpr int INPUT_RECORDING_VERSION = 1;
+
+enum InputMode
+{
+    INPUT_LIVE,         // Input straight from GLFW
+    INPUT_RECORD,       // Input from GLFW, written to file
+    INPUT_REPLAY,       // Input from file, GLFW input is ignored
+};
+
+enum InputEventType
+{
+    INPUT_EVENT_CURSOR,
+    INPUT_EVENT_SCROLL,
+    INPUT_EVENT_KEY,
+};
+
+/**
+ * @brief Struct InputOptions stores command line options of input recording and replay.
+*/
+struct InputOptions
+{
+    InputMode mode = INPUT_LIVE;
+    std::string path;
+    double timeStep = INPUT_REPLAY_TIME_STEP;     // 0 replays recorded frame times instead of a fixed step
+};
+
+/**
+ * @brief Struct InputEvent stores one GLFW callback invocation.
+*/
+struct InputEvent
+{
+    InputEventType type;
+    double time;            // glfwGetTime() when event arrived
+    double x, y;            // Cursor position or scroll offset
+    int key, scancode, action, mods;
+};
+
+/**
+ * @brief Class InputRecorder sits between GLFW's input callbacks and the chapter's, so a session can be recorded and
+ * replayed frame by frame.
+ *
+ * start() registers its own cursor, scroll and key callbacks and forwards to the chapter's. While recording every event
+ * and every frame's start time go to a text file. While replaying GLFW input is dropped, beginFrame() sets GLFW's clock
+ * to the frame's time and calls the chapter's callbacks with the recorded events up to it.
+ *
+ * Frame code reads time with getTime() and held keys with isKeyPressed() instead of glfwGetTime() and glfwGetKey(),
+ * both are fixed for the whole frame and in record and replay come from the recorded events only, so a replay sees the
+ * same input as the recorded session did. Replay runs on a fixed time step by default, camera path and animation are
+ * then the same on every machine and build; with step 0 it uses the recorded frame times to reproduce a session's
+ * frames exactly, slow ones included.
+*/
+class InputRecorder
+{
+private:
+    static InputRecorder* active;       // Receives GLFW callbacks
+
+    InputOptions options;
+    GLFWwindow* window;
+    GLFWcursorposfun cursorCallback;
+    GLFWscrollfun scrollCallback;
+    GLFWkeyfun keyCallback;
+
+    std::ofstream file;
+    std::vector<double> frameTimes;     // Replay: start time of every recorded frame
+    std::vector<InputEvent> events;     // Replay: recorded events in order
+    size_t nextEvent;
+
+    unsigned int frame;
+    double frameTime;
+    bool keys[GLFW_KEY_LAST + 1];
+
+    static void cursorPositionCallback(GLFWwindow* window, double x, double y);
+    static void mouseScrollCallback(GLFWwindow* window, double x, double y);
+    static void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+    bool load();
+    void write(const InputEvent &event);
+    void dispatch(GLFWwindow* window, const InputEvent &event);
+    double replayTime(unsigned int frame) const;
+
+public:
+    InputRecorder();
+    ~InputRecorder();
+
+    /**
+     * @brief Parse "--record file", "--replay file" and "--replay-step seconds", they are removed from argv.
+     * @return False on malformed arguments.
+    */
+    static bool parseArguments(int &argc, char** argv, InputOptions &options);
+
+    /**
+     * @brief Open recording and take over window's input callbacks.
+     * @return False if recording can't be opened.
+    */
+    bool start(GLFWwindow* window, const InputOptions &options, GLFWcursorposfun cursorCallback, GLFWscrollfun scrollCallback, GLFWkeyfun keyCallback);
+
+    /**
+     * @brief Fix frame's time, when replaying also set GLFW's clock and deliver recorded events. Call first in a frame.
+    */
+    void beginFrame(GLFWwindow* window);
+
+    /**
+     * @brief Time of current frame, replaces glfwGetTime() in frame code.
+    */
+    double getTime() const { return frameTime; };
+
+    /**
+     * @brief Whether key is held, replaces glfwGetKey() in frame code.
+    */
+    bool isKeyPressed(GLFWwindow* window, int key) const;
+
+    bool isReplaying() const { return options.mode == INPUT_REPLAY; };
+
+    /**
+     * @brief Whether replay has delivered its last frame.
+    */
+    bool isDone() const;
+
+    /**
+     * @brief Finish recording file and give callbacks back to the chapter.
+    */
+    void stop();
+};
@@ -2,6 +2,9 @@
 
 #include <iostream>
 #include <map>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include <GL/glew.h>
 #include <GL/gl.h>
@@ -13,6 +16,17 @@ constexpr glm::vec3 DEFAULT_AMBIENT_LIGHT = glm::vec3(0.1f);
 constexpr glm::vec3 DEFAULT_DIFFUSE_LIGHT = glm::vec3(0.5f);
 constexpr glm::vec3 DEFAULT_SPECULAR_LIGHT = glm::vec3(0.8f);
 
+// Packed light layout used by clustered lighting, every light takes LIGHT_TEXELS RGBA32F texels:
+// 0: position.xyz, range           1: ambient.rgb, constant        2: diffuse.rgb, linear
+// 3: specular.rgb, quadratic       4: direction.xyz, cos(cutOff)   5: cos(outerCutOff), type, shadow slot, 0
+constexpr unsigned int LIGHT_TEXELS = 6;
+
+enum LightTypes
+{
+    LIGHT_POINT,
+    LIGHT_SPOT,
+};
+
 class Light
 {
 protected:
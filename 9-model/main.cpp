@@ -4,8 +4,26 @@
 #include "camera.h"
 #include "directionalLight.h"
 #include "pointLight.h"
+#include "spotLight.h"
+#include "clusteredLighting.h"
+#include "cascadedShadowMap.h"
+#include "pointShadowAtlas.h"
+#include "programCache.h"
+#include "shaderVariants.h"
+#include "shaderCompiler.h"
+#include "shaderReloader.h"
+#include "assetFileSystem.h"
+#include "gpuProfiler.h"
+#include "cpuProfiler.h"
+#include "benchmark.h"
+#include "glCounters.h"
+#include "inputRecorder.h"
 #include "stb_image.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <memory>
 #include <sstream>
 #include <vector>
 
@@ -53,6 +71,25 @@ const float OUTER_CUT_OFF = 17.0f;
 
 const glm::vec3 DEFAULT_LIGHT_COLOR = glm::vec3(1.0f, 1.0f, 1.0f);   // White
 
+// Small animated lights used to stress clustered lighting
+const unsigned int DYNAMIC_LIGHT_COUNT = 1024;
+const float DYNAMIC_LIGHT_AREA = 20.0f;     // Lights move inside a DYNAMIC_LIGHT_AREA wide square around the model
+const float DYNAMIC_LIGHT_LINEAR = 0.7f;
+const float DYNAMIC_LIGHT_QUADRATIC = 1.8f;
+
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
+
+// Shadows
+const unsigned int SHADOW_TEXTURE_UNIT = 12;        // Below clustered lighting units
+const unsigned int POINT_SHADOW_TEXTURE_UNIT = 11;
+const unsigned int SHADOWED_DYNAMIC_LIGHT_COUNT = 16;   // First dynamic lights compete for point shadow slots
+const float ORBIT_RADIUS = 4.0f;                    // Distance of dynamic (orbiting) backpack from the static one
+const size_t DEFAULT_TEXTURE_BUDGET = 256 * 1024 * 1024;   // GPU bytes for model textures, least recently drawn are downgraded past it
+const float PROFILER_REPORT_INTERVAL = 2.0f;                // Seconds between GPU timing reports
+const float GL_COUNTER_INTERVAL = 0.5f;                     // Seconds between GL call counter updates in window title
+const unsigned int GL_CALL_SITE_COUNT = 10;                 // Busiest GL call sites listed when counters are switched off
+
 // Window configuration
 GLfloat width = 800.0f, height = 600.0f;
 std::string title = "Main Window";
@@ -66,6 +103,9 @@ std::string meshVShaderPath = pwd + "/../shaders/mesh.vs";
 std::string meshFShaderPath = pwd + "/../shaders/mesh.fs";
 std::string modelPath = pwd + "/../../assets/backpack/backpack.obj";
 std::string cubePath = pwd + "/../../assets/cube/cube.obj";
+// Packed assets and shaders, built with "./main.o --pack", loose files are used while it doesn't exist
+std::string archivePath = pwd + "/assets.pak";
+std::string archiveRoot = pwd + "/../..";
 
 // Model transformation matrix
 glm::mat4 model;
@@ -78,6 +118,8 @@ glm::vec3 translationVec(0.0f);
 
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
+// Every input callback and frame time goes through it, "--record file" and "--replay file" use it
+InputRecorder inputRecorder;
 
 // Create Camera object with starting location
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
@@ -116,6 +158,25 @@ float lightAlpha = 1.0f;
 glm::vec4 backgroundColor = DEFAULT_BACKGROUND_COLOR;
 glm::vec3 lightColor = DEFAULT_LIGHT_COLOR;
 
+// Toggle animated dynamic lights with "L" key
+bool useDynamicLights = false;
+// Toggle directional and point light shadows with "K" key
+bool useShadows = true;
+// Toggle shader hot reload (rebuild shaders when files in shaders/ change) with "R" key
+bool useHotReload = false;
+// Toggle texture mip streaming (off streams every texture to full resolution) with "T" key
+bool useTextureStreaming = true;
+// Halve/double texture memory budget with "[" and "]" keys
+size_t textureBudget = DEFAULT_TEXTURE_BUDGET;
+// Toggle GPU pass timing reports with "P" key
+bool useGpuProfiler = false;
+// Start/stop CPU trace capture with "C" key, written to traceOutputPath when stopped
+bool captureCpuTrace = false;
+std::string traceOutputPath = pwd + "/trace.json";
+// Toggle GL call counters with "G" key, per-frame averages go to window title (and CPU trace while capturing),
+// switching them off lists the busiest call sites
+bool useGlCounters = false;
+
 glm::vec3 pointLightPositions[] = 
 {
 	glm::vec3( 0.7f,  0.2f,  7.0f),
@@ -138,52 +199,242 @@ glm::vec3 colors[] =
     glm::vec3(0.8f, 0.6f, 0.7f)      // Violet
 };
 
-int main()
+int main(int argc, char** argv)
 {
+    CpuProfiler::setThreadName("Main");
+
+    // Pack assets and shaders into one archive and exit
+    if(argc > 1 && std::string(argv[1]) == "--pack")
+        return AssetArchive::build(archivePath, archiveRoot, { archiveRoot + "/assets", pwd + "/../shaders" }) ? 0 : -1;
+
+    // Input recording and replay, takes its arguments out before benchmark sees them
+    InputOptions inputOptions;
+    if(!InputRecorder::parseArguments(argc, argv, inputOptions))
+        return -1;
+
+    // Benchmark mode renders a scripted camera path without a visible window and reports frame timings
+    BenchmarkOptions benchmarkOptions;
+    if(!Benchmark::parseArguments(argc, argv, benchmarkOptions))
+        return -1;
+    if(benchmarkOptions.enabled)
+    {
+        width = benchmarkOptions.width;
+        height = benchmarkOptions.height;
+        Benchmark::prepareContext();
+    }
+
+    // Read assets from archive when there is one, mapped archive replaces hundreds of opens with a few large reads
+    AssetFileSystem::mount(archivePath, archiveRoot);
+
     // Create window object
     glWindow window(title, width, height);
 
     // Set callback function to capture cursor (focus on window)
     glfwSetInputMode(window.getGlWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-    // Set callback function to capture mouse movement
-    glfwSetCursorPosCallback(window.getGlWindow(), mouse_callback);
-    // Set callback function to capture mouse scrolling
-    glfwSetScrollCallback(window.getGlWindow(), scroll_callback);
-    glfwSetKeyCallback(window.getGlWindow(), key_callback);
+    // Set callback functions to capture mouse movement, mouse scrolling and keyboard, recorder forwards them
+    if(!inputRecorder.start(window.getGlWindow(), inputOptions, mouse_callback, scroll_callback, key_callback))
+        return -1;
 
     // Tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
     stbi_set_flip_vertically_on_load(true);
 
-    // Build and compile shaders
-    // -------------------------
+    // Build and compile shaders, linked programs are cached next to the executable
+    // Compiles are only submitted here and finished after models are loaded, so driver compiles while assimp loads
+    // ---------------------------------------------------------------------------------------------------------------
+    ProgramCache::setDirectory(pwd + "/shaderCache");
+    ShaderCompiler::begin();
     Shader meshShader(meshVShaderPath.c_str(), meshFShaderPath.c_str());
-    Shader lightShader(lightVShaderPath.c_str(), lightFShaderPath.c_str());
+
+    // Light shader is specialized per feature set, constants it shares with C++ are injected instead of repeated in GLSL
+    std::string lightDefines = ShaderPreprocessor::define("LIGHT_TEXELS", std::to_string(LIGHT_TEXELS)) +
+                               ShaderPreprocessor::define("LIGHT_SPOT", std::to_string(LIGHT_SPOT)) +
+                               ShaderPreprocessor::define("CLUSTER_X", std::to_string(CLUSTER_X)) +
+                               ShaderPreprocessor::define("CLUSTER_Y", std::to_string(CLUSTER_Y)) +
+                               ShaderPreprocessor::define("CLUSTER_Z", std::to_string(CLUSTER_Z)) +
+                               ShaderPreprocessor::define("MAX_SHADOW_CASCADES", std::to_string(MAX_SHADOW_CASCADES)) +
+                               ShaderPreprocessor::define("CUBE_FACES", std::to_string(CUBE_FACES));
+    ShaderVariants lightVariants(lightVShaderPath, lightFShaderPath, "", { { "USE_SHADOWS", 1 } }, lightDefines);
+    const unsigned int LIGHT_VARIANT_SHADOWS = 1u << lightVariants.getShift("USE_SHADOWS");
+    // Both variants are used at run time (K key), build them with the rest instead of on first toggle
+    lightVariants.get(0);
+    lightVariants.get(LIGHT_VARIANT_SHADOWS);
+
+    // Directional light shadows, the centre backpack never moves so far cascades keep it cached
+    CascadedShadowMap shadowMap(pwd + "/../shaders");
+    // Point light shadows, scene lights never move and are rendered once (and again when the orbiting backpack is near them),
+    // shadowed dynamic lights share the per frame budget
+    PointShadowAtlas pointShadows(pwd + "/../shaders");
 
     Shader::enableDepth();
 
-    // Load models
-    // -----------
-    Model backpack(modelPath.c_str());
-    Model cube(cubePath.c_str());
+    // Load models, each model's textures are read together (io_uring when available) and decoded on all cores
+    // ----------------------------------------------------------------------------------------------------------
+    // Only mip tails are uploaded here, finer levels stream in once meshes are on screen
+    // Mesh buffers are filled on a loader thread with its own shared context, meshes are drawn once they are on the GPU
+    AsyncFileReader assetReader;
+    TextureStreamer textureStreamer;
+    ResourceUploader resourceUploader(window.createSharedContext());
+    Model backpack(modelPath.c_str(), &assetReader, &textureStreamer, &resourceUploader);
+    Model cube(cubePath.c_str(), &assetReader, &textureStreamer, &resourceUploader);
+
+    ShaderCompiler::end();
 
     // Uncomment to render models in wireframe
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    // Lights are created once and only updated every frame, clustered lighting packs them into buffers
+    // ------------------------------------------------------------------------------------------------
+    ClusteredLighting clusteredLighting;
+    float clusterFov = 0.0f, clusterAspect = 0.0f;
+
+    std::vector<PointLight> pointLights;
+    for(unsigned int i = 0; i < 5; i++)
+        pointLights.push_back(PointLight(pointLightPositions[i], constant, linear, quadratic, pointLightAmbient, pointLightDiffuse, pointLightSpecular));
+
+    // Dynamic lights follow their own circle, starting phase and height are spread with a fixed pattern
+    std::vector<glm::vec4> dynamicLightPaths;
+    for(unsigned int i = 0; i < DYNAMIC_LIGHT_COUNT; i++)
+    {
+        float x = (std::fmod(i * 0.618034f, 1.0f) - 0.5f) * DYNAMIC_LIGHT_AREA;
+        float z = (std::fmod(i * 0.754878f, 1.0f) - 0.5f) * DYNAMIC_LIGHT_AREA;
+        float y = (std::fmod(i * 0.569840f, 1.0f) - 0.5f) * 6.0f;
+        dynamicLightPaths.push_back(glm::vec4(x, y, z, i * 0.1f));
+
+        glm::vec3 color = colors[2 + i % 7];
+        pointLights.push_back(PointLight(glm::vec3(x, y, z), CONSTANT, DYNAMIC_LIGHT_LINEAR, DYNAMIC_LIGHT_QUADRATIC, color * 0.05f, color, color));
+    }
+
+    // Centre backpack is static, orbiting one is dynamic
+    std::vector<ShadowCaster> shadowCasters =
+    {
+        { &backpack, glm::mat4(1.0f), true },
+        { &backpack, glm::mat4(1.0f), false },
+    };
+
+    // Scene lights are static, first dynamic lights compete for the rest of the atlas
+    std::vector<ShadowedPointLight> staticShadowedLights;
+    for(unsigned int i = 0; i < 5; i++)
+        staticShadowedLights.push_back({ &pointLights[i], true });
+    std::vector<ShadowedPointLight> allShadowedLights = staticShadowedLights;
+    for(unsigned int i = 0; i < SHADOWED_DYNAMIC_LIGHT_COUNT; i++)
+        allShadowedLights.push_back({ &pointLights[5 + i], false });
+
+    // Flashlight attached to camera
+    std::vector<SpotLight> spotLights;
+    spotLights.push_back(SpotLight(camera.getPosition(), camera.getFront(), cutOff, outerCutOff, constant, linear, quadratic, spotLightAmbient, spotLightDiffuse, spotLightSpecular));
+
+    // Only exists while hot reload is on
+    std::unique_ptr<ShaderReloader> shaderReloader;
+
+    // GPU time of every pass, read back a few frames late so it never waits for the GPU
+    GpuProfiler gpuProfiler;
+    double profilerReportStart = glfwGetTime();
+
+    // GL calls summed since last title update
+    GlFrameCounters glCounterSum;
+    unsigned int glCounterFrames = 0;
+    double glCounterStart = glfwGetTime();
+
+    std::unique_ptr<Benchmark> benchmark;
+    if(benchmarkOptions.enabled)
+        benchmark.reset(new Benchmark(benchmarkOptions, "9-model", glm::vec3(0.0f), 8.0f));
+
     // Render loop
     // -----------
-    while (!window.isShouldClose())
+    while (!window.isShouldClose() && !(benchmark && benchmark->isDone()) && !inputRecorder.isDone())
     {
+        CPU_ZONE("frame");
+
+        if(benchmark)
+            benchmark->beginFrame();
+        // Replay sets frame time after benchmark and delivers this frame's recorded input
+        inputRecorder.beginFrame(window.getGlWindow());
+
+        // CPU trace capture follows "C" key
+        if(captureCpuTrace != CpuProfiler::isCapturing())
+        {
+            if(captureCpuTrace)
+                CpuProfiler::beginCapture();
+            else if(CpuProfiler::endCapture(traceOutputPath))
+                std::cout << "CPU trace written to " << traceOutputPath << std::endl;
+        }
+
+        // Finished uploads, meshes that became drawable change cached shadows
+        // ---------------------------------------------------------------------
+        bool uploading = !resourceUploader.isIdle();
+        if(uploading && resourceUploader.poll() == 0)
+        {
+            shadowMap.invalidateStatic();
+            pointShadows.invalidateStatic();
+        }
+
+        // Shader hot reload, rebuilt programs are swapped in between frames
+        // -----------------------------------------------------------------
+        if(useHotReload && !shaderReloader)
+            shaderReloader.reset(new ShaderReloader({ pwd + "/../shaders" }));
+        else if(!useHotReload && shaderReloader)
+            shaderReloader.reset();
+        if(shaderReloader)
+            shaderReloader->update();
+
         // Process input
         // -------------
-        processMovement(window.getGlWindow(), &camera);
+        {
+            CPU_ZONE("input");
+            processMovement(window.getGlWindow(), &camera);
+        }
+        if(benchmark && !inputRecorder.isReplaying())
+        {
+            // Scripted camera replaces mouse and keyboard, a replay brings its own camera path
+            BenchmarkCameraPose pose = benchmark->cameraPose();
+            camera.setPosition(pose.position);
+            camera.setYaw(pose.yaw);
+            camera.setPitch(pose.pitch);
+            camera.processMouseMovement(0.0f, 0.0f);
+        }
+
+        gpuProfiler.setEnabled(useGpuProfiler);
+        gpuProfiler.beginFrame();
+
+        // Transformations for view and projection
+        // ---------------------------------------
+        glm::mat4 projection = glm::perspective(glm::radians(camera.getFov()), width / height, NEAR_PLANE, FAR_PLANE);
+        glm::mat4 view = camera.calculateLookAtMatrix(camera.getPosition(), camera.getPosition() + camera.getFront(), camera.getUp());
+
+        // Shadow pass
+        // -----------
+        float time = inputRecorder.getTime();
+        glm::mat4 orbitModel = glm::translate(glm::mat4(1.0f), glm::vec3(std::cos(time * 0.5f) * ORBIT_RADIUS, 0.0f, std::sin(time * 0.5f) * ORBIT_RADIUS));
+        orbitModel = glm::rotate(orbitModel, time, glm::vec3(0.0f, 1.0f, 0.0f));
+        orbitModel = glm::scale(orbitModel, glm::vec3(0.5f));
+        shadowCasters[1].transform = orbitModel;
+
+        // Texture streaming, both backpacks report which mip levels they need from their screen-space UV density
+        // ---------------------------------------------------------------------------------------------------------
+        float pixelsPerUnit = height / (2.0f * std::tan(glm::radians(camera.getFov()) * 0.5f));
+        backpack.requestTextures(textureStreamer, glm::mat4(1.0f), camera.getPosition(), pixelsPerUnit);
+        backpack.requestTextures(textureStreamer, orbitModel, camera.getPosition(), pixelsPerUnit);
+        textureStreamer.setEnabled(useTextureStreaming);
+        textureStreamer.setBudget(textureBudget);
+        {
+            GpuScope scope(gpuProfiler, "textureUpload");
+            textureStreamer.update(deltaTime);
+        }
+
+        if(useShadows)
+        {
+            GpuScope scope(gpuProfiler, "cascades");
+            shadowMap.update(view, glm::radians(camera.getFov()), width / height, NEAR_PLANE, lightDirection, shadowCasters);
+        }
 
         // Set background color and clear color buffer and depth buffer
         // ------------------------------------------------------------
         glClearColor(backgroundColor.x, backgroundColor.y, backgroundColor.z, backgroundColor.t);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Enabling our shader before using it's uniforms
-        // ----------------------------------------------
+        // Enabling our shader before using it's uniforms, variant without shadows has no shadow code at all
+        // -------------------------------------------------------------------------------------------------
+        Shader &lightShader = lightVariants.get(useShadows ? LIGHT_VARIANT_SHADOWS : 0);
         lightShader.use();
 
         lightShader.setFloat("material.shininess", specularIntensity);
@@ -193,22 +444,65 @@ int main()
         DirectionalLight directionalLight(lightDirection, directionalAmbient, directionalDiffuse, directionalSpecular);
         directionalLight.load(lightShader.getID());
 
-        // Point lights creation
-        // ---------------------
-        std::vector<PointLight> pointLights;
+        lightShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
+        lightShader.setMatrix4fv("view", 1, GL_FALSE, view);
+        lightShader.setVec3("viewPosition", glm::value_ptr(camera.getPosition()));
+
+        if(useShadows)
+            shadowMap.bind(lightShader, SHADOW_TEXTURE_UNIT);
+
+        // Point and spot lights update
+        // ----------------------------
         for(unsigned int i = 0; i < 5; i++)
         {
-            pointLights.push_back(PointLight(pointLightPositions[i], constant, linear, quadratic, pointLightAmbient, pointLightDiffuse, pointLightSpecular));
-            pointLights[i].injectIndex(i);
-            pointLights[i].load(lightShader.getID());
+            pointLights[i].setAttenuation(constant, linear, quadratic);
+            pointLights[i].setAmbient(pointLightAmbient);
+            pointLights[i].setDiffuse(pointLightDiffuse);
+            pointLights[i].setSpecular(pointLightSpecular);
         }
 
-        // Transformations for view and projection
-        // ---------------------------------------
-        glm::mat4 projection = glm::perspective(glm::radians(camera.getFov()), width / height, 0.1f, 100.0f);
-        glm::mat4 view = camera.calculateLookAtMatrix(camera.getPosition(), camera.getPosition() + camera.getFront(), camera.getUp());
-        lightShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
-        lightShader.setMatrix4fv("view", 1, GL_FALSE, view);
+        for(unsigned int i = 0; i < DYNAMIC_LIGHT_COUNT; i++)
+        {
+            const glm::vec4 &path = dynamicLightPaths[i];
+            glm::vec3 offset(std::cos(time + path.w), 0.0f, std::sin(time + path.w));
+            pointLights[5 + i].setPosition(glm::vec3(path) + offset);
+        }
+
+        spotLights[0].setPosition(camera.getPosition());
+        spotLights[0].setDirection(camera.getFront());
+        spotLights[0].setCutOff(cutOff, outerCutOff);
+        spotLights[0].setAttenuation(constant, linear, quadratic);
+        spotLights[0].setAmbient(spotLightAmbient);
+        spotLights[0].setDiffuse(spotLightDiffuse);
+        spotLights[0].setSpecular(spotLightSpecular);
+
+        // Point light shadows need this frame's light positions and have to run before lights are packed, they store slots in lights
+        const std::vector<ShadowedPointLight> noShadowedLights;
+        {
+            GpuScope scope(gpuProfiler, "pointShadows");
+            pointShadows.update(useShadows ? (useDynamicLights ? allShadowedLights : staticShadowedLights) : noShadowedLights, camera.getPosition(), shadowCasters);
+        }
+        lightShader.use();
+        if(useShadows)
+            pointShadows.bind(lightShader, POINT_SHADOW_TEXTURE_UNIT);
+
+        // Froxel bounds only change with projection
+        if(camera.getFov() != clusterFov || width / height != clusterAspect)
+        {
+            clusterFov = camera.getFov();
+            clusterAspect = width / height;
+            clusteredLighting.setProjection(glm::radians(clusterFov), clusterAspect, NEAR_PLANE, FAR_PLANE);
+        }
+
+        // Only the 5 scene lights are used unless dynamic lights are on, flashlight is off when cutOff is 0
+        unsigned int activePointLights = useDynamicLights ? pointLights.size() : 5;
+        unsigned int activeSpotLights = cutOff > 0 ? spotLights.size() : 0;
+        {
+            CPU_ZONE("lightUpload");
+            GpuScope scope(gpuProfiler, "lightUpload");
+            clusteredLighting.update(view, pointLights, activePointLights, spotLights, activeSpotLights);
+            clusteredLighting.bind(lightShader, width, height);
+        }
 
         // Transformations for model
         // -------------------------
@@ -220,30 +514,103 @@ int main()
 
         // Render model
         // ------------
-        backpack.draw(lightShader);
+        {
+            GpuScope scope(gpuProfiler, "models");
+            backpack.draw(lightShader);
+
+            // Orbiting backpack is a dynamic shadow caster
+            lightShader.setMatrix3fv("normalMatrix", 1, GL_TRUE, glm::mat3(glm::inverse(orbitModel)));
+            lightShader.setMatrix4fv("model", 1, GL_FALSE, orbitModel);
+            backpack.draw(lightShader);
+        }
         lightShader.unbind();
 
         // Light cubes creation
         // --------------------
-        meshShader.use();
-        meshShader.setVec3("color", glm::value_ptr(lightColor));
-        meshShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
-        meshShader.setMatrix4fv("view", 1, GL_FALSE, view);
+        {
+            GpuScope scope(gpuProfiler, "lightCubes");
+            meshShader.use();
+            meshShader.setVec3("color", glm::value_ptr(lightColor));
+            meshShader.setMatrix4fv("projection", 1, GL_FALSE, projection);
+            meshShader.setMatrix4fv("view", 1, GL_FALSE, view);
+
+            for(unsigned int i = 0; i < 5; i++)
+            {
+                model = glm::mat4(1.0f);
+                model = glm::translate(model, pointLightPositions[i]);
+                model = glm::scale(model, glm::vec3(0.01f));
+                meshShader.setMatrix4fv("model", 1, GL_FALSE, model);
+                cube.draw(meshShader);
+            }
+            meshShader.unbind();
+        }
 
-        for(unsigned int i = 0; i < 5; i++)
+        // GPU timing report
+        // -----------------
+        if(useGpuProfiler && glfwGetTime() - profilerReportStart >= PROFILER_REPORT_INTERVAL)
         {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, pointLightPositions[i]);
-            model = glm::scale(model, glm::vec3(0.01f));
-            meshShader.setMatrix4fv("model", 1, GL_FALSE, model);
-            cube.draw(meshShader);
+            gpuProfiler.report(std::cout);
+            profilerReportStart = glfwGetTime();
         }
-        meshShader.unbind();
 
-        window.swapBuffers();
-        glfwPollEvents();
+        // GL call counters, benchmark takes them itself
+        // ---------------------------------------------
+        if(useGlCounters && !benchmark)
+        {
+            GlFrameCounters glFrame = GlCounters::takeFrame();
+            CpuProfiler::counter("GL draw calls", glFrame.drawCalls);
+            CpuProfiler::counter("GL state changes", glFrame.stateChanges);
+            CpuProfiler::counter("GL program binds", glFrame.programBinds);
+            CpuProfiler::counter("GL texture binds", glFrame.textureBinds);
+            CpuProfiler::counter("GL bytes uploaded", glFrame.bytesUploaded);
+            CpuProfiler::counter("GL uniform location queries", glFrame.uniformLocationQueries);
+            CpuProfiler::counter("GL sync points", glFrame.syncPoints);
+            glCounterSum += glFrame;
+            glCounterFrames++;
+
+            // No text rendering here, the window title is the overlay
+            if(glfwGetTime() - glCounterStart >= GL_COUNTER_INTERVAL)
+            {
+                std::ostringstream overlay;
+                overlay << std::fixed << std::setprecision(0) << title
+                        << " | draws " << double(glCounterSum.drawCalls) / glCounterFrames
+                        << " | state " << double(glCounterSum.stateChanges) / glCounterFrames
+                        << " | programs " << double(glCounterSum.programBinds) / glCounterFrames
+                        << " | textures " << double(glCounterSum.textureBinds) / glCounterFrames
+                        << " | uniform lookups " << double(glCounterSum.uniformLocationQueries) / glCounterFrames
+                        << " | syncs " << double(glCounterSum.syncPoints) / glCounterFrames
+                        << " | upload " << double(glCounterSum.bytesUploaded) / glCounterFrames / 1024.0 << " KiB";
+                glfwSetWindowTitle(window.getGlWindow(), overlay.str().c_str());
+                glCounterSum = GlFrameCounters();
+                glCounterFrames = 0;
+                glCounterStart = glfwGetTime();
+            }
+        }
+        else if(glCounterFrames != 0)
+        {
+            glCounterSum = GlFrameCounters();
+            glCounterFrames = 0;
+        }
+
+        {
+            CPU_ZONE("swap");
+            if(benchmark)
+                benchmark->endFrame();
+            else
+                window.swapBuffers();
+        }
+        {
+            CPU_ZONE("input");
+            glfwPollEvents();
+        }
     }
 
+    if(benchmark)
+        benchmark->finish();
+
+    inputRecorder.stop();
+    // Shared context has to go before GLFW does
+    resourceUploader.stop();
     glfwTerminate();
     return 0;
 }
@@ -275,28 +642,28 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 
 void processMovement(GLFWwindow* window, Camera* camera)
 {
-    float currentFrame = glfwGetTime();
+    float currentFrame = inputRecorder.getTime();
     deltaTime = currentFrame - lastFrame;
     lastFrame = currentFrame;
 
     // If user presses "W" key - move up the y axis
-    if(glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    if(inputRecorder.isKeyPressed(window, GLFW_KEY_W))
         camera->processKeyboard(FORWARD, deltaTime);
 
     // If user presses "S" key - move down the y axis
-    if(glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    if(inputRecorder.isKeyPressed(window, GLFW_KEY_S))
         camera->processKeyboard(BACKWARD, deltaTime);
 
     // If user presses "A" key - move up x axis (move right)
-    if(glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+    if(inputRecorder.isKeyPressed(window, GLFW_KEY_A))
         camera->processKeyboard(LEFT, deltaTime);
 
     // If user presses "D" key - move down x axis (move left)
-    if(glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+    if(inputRecorder.isKeyPressed(window, GLFW_KEY_D))
         camera->processKeyboard(RIGHT, deltaTime);
     
     // If user presses LEFT_SHIFT key - increase camera movement
-    if(glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+    if(inputRecorder.isKeyPressed(window, GLFW_KEY_LEFT_SHIFT))
         camera->setMovementSpeed(SPEED * 5.0f);
     // Otherwise normal camera speed
     else
@@ -320,6 +687,81 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         }
     }
 
+    // Toggle dynamic lights when user presses "L" key
+    if(key == GLFW_KEY_L && action == GLFW_PRESS)
+    {
+        useDynamicLights = !useDynamicLights;
+        std::cout << "Dynamic lights: " << (useDynamicLights ? "on" : "off") << std::endl;
+    }
+
+    // Toggle directional light shadows when user presses "K" key
+    if(key == GLFW_KEY_K && action == GLFW_PRESS)
+    {
+        useShadows = !useShadows;
+        std::cout << "Shadows: " << (useShadows ? "on" : "off") << std::endl;
+    }
+
+    // Toggle shader hot reload when user presses "R" key
+    if(key == GLFW_KEY_R && action == GLFW_PRESS)
+    {
+        useHotReload = !useHotReload;
+        // Edited files are on disk, archive would return the packed ones
+        AssetFileSystem::setLooseFirst(useHotReload);
+        std::cout << "Shader hot reload: " << (useHotReload ? "on" : "off") << std::endl;
+    }
+
+    // Toggle texture streaming when user presses "T" key
+    if(key == GLFW_KEY_T && action == GLFW_PRESS)
+    {
+        useTextureStreaming = !useTextureStreaming;
+        std::cout << "Texture streaming: " << (useTextureStreaming ? "on" : "off") << std::endl;
+    }
+
+    // If user presses "P" key - switch GPU pass timing reports on and off
+    if(key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        useGpuProfiler = !useGpuProfiler;
+        std::cout << "GPU profiler: " << (useGpuProfiler ? "on" : "off") << std::endl;
+    }
+
+    // If user presses "C" key - start CPU trace capture, pressing again writes it (open in chrome://tracing or ui.perfetto.dev)
+    if(key == GLFW_KEY_C && action == GLFW_PRESS)
+    {
+        captureCpuTrace = !captureCpuTrace;
+        std::cout << "CPU trace capture: " << (captureCpuTrace ? "on" : "off") << std::endl;
+    }
+
+    // If user presses "G" key - count GL calls per frame, pressing again lists the busiest call sites since then
+    if(key == GLFW_KEY_G && action == GLFW_PRESS)
+    {
+        useGlCounters = !useGlCounters;
+        std::cout << "GL call counters: " << (useGlCounters ? "on" : "off") << std::endl;
+        if(useGlCounters)
+        {
+            GlCounters::install();
+            GlCounters::takeFrame();
+            GlCounters::setCallSiteTracking(true);
+        }
+        else
+        {
+            std::vector<GlCallSite> callSites = GlCounters::takeCallSites(GL_CALL_SITE_COUNT);
+            for(const GlCallSite &callSite : callSites)
+                std::cout << std::setw(10) << callSite.calls << "  " << callSite.function << "  " << callSite.location << std::endl;
+            GlCounters::setCallSiteTracking(false);
+            glfwSetWindowTitle(window, title.c_str());
+        }
+    }
+
+    // Change texture budget when user presses "[" or "]" key
+    if((key == GLFW_KEY_LEFT_BRACKET || key == GLFW_KEY_RIGHT_BRACKET) && action == GLFW_PRESS)
+    {
+        if(key == GLFW_KEY_LEFT_BRACKET)
+            textureBudget = std::max<size_t>(textureBudget / 2, 1024 * 1024);
+        else
+            textureBudget *= 2;
+        std::cout << "Texture budget: " << textureBudget / (1024 * 1024) << " MiB" << std::endl;
+    }
+
     // Default light set-up when user presses "0" key
     if(key == GLFW_KEY_0 && action == GLFW_PRESS)
     {
@@ -1,12 +1,19 @@
 #include "mesh.h"
+#include "cpuProfiler.h"
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, bool setup)
 {
     this->vertices = vertices;
     this->indices = indices;
     this->textures = textures;
+    ready = false;
 
-    setupMesh();
+    if(setup)
+        setupMesh();
 }
 
 Mesh::~Mesh()
@@ -16,19 +23,74 @@ Mesh::~Mesh()
 
 void Mesh::setupMesh()
 {
-    // Generate arrays and buffers
-    glGenVertexArrays(1, &vertexArray);
+    computeBounds();
+    createBuffers();
+    createVertexArrays();
+}
+
+void Mesh::setupMeshAsync(ResourceUploader &uploader)
+{
+    computeBounds();
+    // Buffers are shared between contexts, vertex arrays aren't, so they are made on render thread once buffers are filled
+    uploader.submit([this]() { createBuffers(); }, [this]() { createVertexArrays(); });
+}
+
+void Mesh::computeBounds()
+{
+    glm::vec3 boundsMin(std::numeric_limits<float>::max()), boundsMax(-std::numeric_limits<float>::max());
+    for(unsigned int i = 0; i < vertices.size(); i++)
+    {
+        boundsMin = glm::min(boundsMin, vertices[i].position);
+        boundsMax = glm::max(boundsMax, vertices[i].position);
+    }
+
+    boundsCenter = (boundsMin + boundsMax) * 0.5f;
+    boundsRadius = 0.0f;
+    for(unsigned int i = 0; i < vertices.size(); i++)
+        boundsRadius = std::max(boundsRadius, glm::length(vertices[i].position - boundsCenter));
+
+    // Ratio of surface area to UV area over all triangles, a single number per mesh is enough to choose a mip level
+    float worldArea = 0.0f, uvArea = 0.0f;
+    for(unsigned int i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const Vertex &a = vertices[indices[i]], &b = vertices[indices[i + 1]], &c = vertices[indices[i + 2]];
+        worldArea += glm::length(glm::cross(b.position - a.position, c.position - a.position));
+        glm::vec2 uvB = b.textureCoordinates - a.textureCoordinates, uvC = c.textureCoordinates - a.textureCoordinates;
+        uvArea += std::abs(uvB.x * uvC.y - uvB.y * uvC.x);
+    }
+    worldPerUv = uvArea > 0.0f ? std::sqrt(worldArea / uvArea) : 0.0f;
+}
+
+void Mesh::createBuffers()
+{
     glGenBuffers(1, &vertexBuffer);
     glGenBuffers(1, &elementBuffer);
+    glGenBuffers(1, &positionBuffer);
 
-    glBindVertexArray(vertexArray);
     // Load data into vertex buffer
     glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
 
-    // Load data into element buffer
+    // Load data into element buffer, bound as array buffer since there may be no vertex array to bind it to on this thread
+    glBindBuffer(GL_ARRAY_BUFFER, elementBuffer);
+    glBufferData(GL_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+
+    // Tightly packed position-only stream
+    std::vector<glm::vec3> positions(vertices.size());
+    for(unsigned int i = 0; i < vertices.size(); i++)
+        positions[i] = vertices[i].position;
+    glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::createVertexArrays()
+{
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
 
     // Vertex positions
     glEnableVertexAttribArray(0);
@@ -58,11 +120,38 @@ void Mesh::setupMesh()
     glEnableVertexAttribArray(6);
     glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, boneWeights));
 
+    // Position-only stream sharing element buffer with full vertex array
+    glGenVertexArrays(1, &positionVertexArray);
+    glBindVertexArray(positionVertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+
+    glBindVertexArray(0);
+    ready = true;
+}
+
+void Mesh::drawPositions(unsigned int instanceCount)
+{
+    if(!ready)
+        return;
+
+    glBindVertexArray(positionVertexArray);
+    if(instanceCount > 1)
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0, instanceCount);
+    else
+        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
 }
 
 void Mesh::draw(Shader &shader)
 {
+    CPU_ZONE("Mesh::draw");
+    // Buffers may still be uploading on loader thread
+    if(!ready)
+        return;
 
     // bind appropriate textures
 	unsigned int diffuseNr  = 1;
@@ -10,6 +10,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "shader.h"
+#include "resourceUploader.h"
 
 constexpr int MAX_BONE_INFLUENCE = 4;
 
@@ -50,16 +51,48 @@ class Mesh
     private:
         // Render data
         unsigned int vertexBuffer, elementBuffer;
+        // Tightly packed positions for depth-only passes, they only fetch 12 bytes per vertex instead of a whole Vertex
+        unsigned int positionBuffer;
         void setupMesh();
+        void computeBounds();
+        // Safe on any thread with a context shared with render context
+        void createBuffers();
+        // Render thread only, vertex arrays aren't shared between contexts
+        void createVertexArrays();
 
     public:
         // Mesh data
         unsigned int vertexArray;
+        unsigned int positionVertexArray;
         std::vector<Vertex> vertices;
         std::vector<unsigned int> indices;
         std::vector<Texture> textures;
 
-        Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
+        // Bounding sphere in model space, used for culling
+        glm::vec3 boundsCenter;
+        float boundsRadius;
+        // Model space units one UV unit covers on average (0 without texture coordinates), used to pick texture mip levels
+        float worldPerUv;
+
+        // False until buffers and vertex arrays exist, draws are skipped until then
+        bool ready;
+
+        /**
+         * @brief Constructor.
+         * @param setup Create GL objects now, otherwise call setupMeshAsync() once mesh is at its final address.
+        */
+        Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, bool setup = true);
         ~Mesh();
         void draw(Shader &shader);
+
+        /**
+         * @brief Create buffers on uploader's loader thread and vertex arrays once they are filled.
+        */
+        void setupMeshAsync(ResourceUploader &uploader);
+
+        /**
+         * @brief Draw mesh with position-only vertex stream and no textures (shadow and depth passes).
+         * @param instanceCount Number of instances, shaders tell them apart with gl_InstanceID.
+        */
+        void drawPositions(unsigned int instanceCount = 1);
 };
\ No newline at end of file
@@ -1,14 +1,55 @@
 #include "model.h"
+#include "assetIOSystem.h"
+#include "cpuProfiler.h"
 #include "stb_image.h"
 
-Model::Model(const char* path)
-{ 
+Model::Model(const char* path, AsyncFileReader *reader, TextureStreamer *streamer, ResourceUploader *uploader)
+{
+    std::unique_ptr<AsyncFileReader> ownReader;
+    if(reader == nullptr)
+    {
+        ownReader.reset(new AsyncFileReader());
+        reader = ownReader.get();
+    }
+    this->reader = reader;
+    this->streamer = streamer;
+    this->uploader = uploader;
+
     loadModel(path);
+
+    this->reader = nullptr;
+    this->uploader = nullptr;
 }
 
-Model::~Model()
+Model::Model(const aiScene *scene, const std::string &directory, AsyncFileReader *reader, TextureStreamer *streamer, ResourceUploader *uploader)
 {
+    std::unique_ptr<AsyncFileReader> ownReader;
+    if(reader == nullptr)
+    {
+        ownReader.reset(new AsyncFileReader());
+        reader = ownReader.get();
+    }
+    this->reader = reader;
+    this->streamer = streamer;
+    this->uploader = uploader;
+    this->directory = directory;
+
+    loadScene(scene);
+
+    this->reader = nullptr;
+    this->uploader = nullptr;
+}
 
+Model::~Model()
+{
+    // Streamed textures are deleted by streamer, which also stops accounting for them
+    for(unsigned int i = 0; i < texturesLoaded.size(); i++)
+    {
+        if(streamer != nullptr)
+            streamer->remove(texturesLoaded[i].id);
+        else
+            glDeleteTextures(1, &texturesLoaded[i].id);
+    }
 }
 
 void Model::draw(Shader &shader)
@@ -18,10 +59,19 @@ void Model::draw(Shader &shader)
         meshes[i].draw(shader);
 }
 
+void Model::requestTextures(TextureStreamer &streamer, const glm::mat4 &model, const glm::vec3 &cameraPosition, float pixelsPerUnit)
+{
+    for(unsigned int i = 0; i < meshes.size(); i++)
+        streamer.request(meshes[i], model, cameraPosition, pixelsPerUnit);
+}
+
 void Model::loadModel(std::string path)
 {
+	CPU_ZONE("Model::loadModel");
 	// read file via ASSIMP
 	Assimp::Importer importer;
+	// models and their material files are read through AssetFileSystem (archive or loose files), importer owns the handler
+	importer.SetIOHandler(new AssetIOSystem());
 	const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
 	// check for errors
 	if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
@@ -32,8 +82,24 @@ void Model::loadModel(std::string path)
 	// retrieve the directory path of the filepath
 	directory = path.substr(0, path.find_last_of('/'));
 
-	// process ASSIMP's root node recursively
+	loadScene(scene);
+}
+
+void Model::loadScene(const aiScene *scene)
+{
+	// process ASSIMP's root node recursively, textures are only queued for reading
 	processNode(scene->mRootNode, scene);
+
+	// meshes won't move anymore, their buffers can be created on uploader's thread
+	if(uploader != nullptr)
+	{
+		for(unsigned int i = 0; i < meshes.size(); i++)
+			meshes[i].setupMeshAsync(*uploader);
+	}
+
+	// all texture reads were issued at once, wait for them to be read and decoded, then upload
+	reader->wait();
+	uploadTextures();
 }
 
 void Model::processNode(aiNode *node, const aiScene *scene)
@@ -55,6 +121,7 @@ void Model::processNode(aiNode *node, const aiScene *scene)
 
 Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
 {
+    CPU_ZONE("Model::processMesh");
     // data to fill
 	std::vector<Vertex> vertices;
 	std::vector<unsigned int> indices;
@@ -134,7 +201,7 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
 	textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
 	
 	// return a mesh object created from the extracted mesh data
-	return Mesh(vertices, indices, textures);
+	return Mesh(vertices, indices, textures, uploader == nullptr);
 }
 
 std::vector<Texture> Model::loadMaterialTextures(aiMaterial *material, aiTextureType type, std::string typeName)
@@ -176,34 +243,74 @@ unsigned int Model::textureFromFile(const char *path, const std::string &directo
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
+    // Read and decode on reader's threads, GL upload happens in uploadTextures()
+    decodedImages.emplace_back(new DecodedImage());
+    DecodedImage *image = decodedImages.back().get();
+    image->textureId = textureID;
+    image->path = path;
+    bool streamed = streamer != nullptr;
+    reader->read(filename, [image, streamed](AssetData &data, bool success)
     {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
+        if(success)
+            image->pixels = stbi_load_from_memory(data.data, data.size, &image->width, &image->height, &image->nrComponents, 0);
+
+        // Mip chain for streaming is built here too, keeping the box filter off the GL thread
+        if(image->pixels && streamed)
+        {
+            image->chain = TextureStreamer::buildMipChain(image->pixels, image->width, image->height, image->nrComponents);
+            stbi_image_free(image->pixels);
+            image->pixels = nullptr;
+        }
+    });
 
     return textureID;
-}
\ No newline at end of file
+}
+
+void Model::uploadTextures()
+{
+    for(std::unique_ptr<DecodedImage> &image : decodedImages)
+    {
+        if (!image->chain.levels.empty())
+            streamer->add(image->textureId, std::move(image->chain));
+        else if (image->pixels)
+        {
+            GLenum format;
+            if (image->nrComponents == 1)
+                format = GL_RED;
+            else if (image->nrComponents == 3)
+                format = GL_RGB;
+            else if (image->nrComponents == 4)
+                format = GL_RGBA;
+
+            // Texture names are shared, so the loader thread fills the one mesh textures already refer to
+            unsigned int textureId = image->textureId;
+            unsigned char *pixels = image->pixels;
+            int width = image->width, height = image->height;
+            auto upload = [textureId, pixels, width, height, format]()
+            {
+                glBindTexture(GL_TEXTURE_2D, textureId);
+                glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+                glGenerateMipmap(GL_TEXTURE_2D);
+
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glBindTexture(GL_TEXTURE_2D, 0);
+            };
+
+            if (uploader != nullptr)
+                uploader->submit(upload, [pixels]() { stbi_image_free(pixels); });
+            else
+            {
+                upload();
+                stbi_image_free(pixels);
+            }
+        }
+        else
+        {
+            std::cout << "Texture failed to load at path: " << image->path << std::endl;
+        }
+    }
+    decodedImages.clear();
+}
@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <memory>
 
 #include <GL/glew.h>
 #include <GL/gl.h>
@@ -12,6 +13,9 @@
 #include <assimp/postprocess.h>
 
 #include "mesh.h"
+#include "asyncFileReader.h"
+#include "textureStreamer.h"
+#include "resourceUploader.h"
 
 class Model
 {
@@ -21,12 +25,52 @@ class Model
         std::string directory;
         bool gammaCorrection;
 
-        Model(const char *path);
+        /**
+         * @brief Load model and its textures.
+         * @param reader Reads and decodes textures in parallel, a temporary one is used if nullptr.
+         * @param streamer Streams texture mip levels by visibility, textures are fully uploaded if nullptr.
+         * @param uploader Creates mesh buffers and non-streamed textures on its loader thread, meshes are drawn once
+         *                 ResourceUploader::poll() completed them. Everything is created here if nullptr.
+        */
+        Model(const char *path, AsyncFileReader *reader = nullptr, TextureStreamer *streamer = nullptr, ResourceUploader *uploader = nullptr);
+
+        /**
+         * @brief Build model from a scene imported or generated elsewhere, same as loading a file otherwise.
+         * @param directory Texture paths of materials are relative to it.
+        */
+        Model(const aiScene *scene, const std::string &directory, AsyncFileReader *reader = nullptr, TextureStreamer *streamer = nullptr, ResourceUploader *uploader = nullptr);
         ~Model();
+        // Model owns its textures
+        Model(const Model &) = delete;
+        Model& operator=(const Model &) = delete;
         void draw(Shader &shader);
+
+        /**
+         * @brief Tell streamer this model is drawn with model matrix this frame (see TextureStreamer::request()).
+        */
+        void requestTextures(TextureStreamer &streamer, const glm::mat4 &model, const glm::vec3 &cameraPosition, float pixelsPerUnit);
     
     private:
+        // Micro benchmarks (benchmark/micro) time single loading steps on synthetic scenes
+        friend class ModelBenchmark;
+
+        // Texture decoded on a reader worker, uploaded on GL thread once all are read
+        struct DecodedImage
+        {
+            unsigned int textureId;
+            std::string path;
+            unsigned char *pixels = nullptr;
+            int width = 0, height = 0, nrComponents = 0;
+            MipChain chain;             // Replaces pixels when texture is streamed
+        };
+        std::vector<std::unique_ptr<DecodedImage>> decodedImages;
+        AsyncFileReader *reader;
+        TextureStreamer *streamer;
+        ResourceUploader *uploader;
+
         void loadModel(std::string path);
+        void loadScene(const aiScene *scene);
+        void uploadTextures();
         void processNode(aiNode *node, const aiScene *scene);
         Mesh processMesh(aiMesh *mesh, const aiScene *scene);
         void processMaterials(const aiScene *scene);
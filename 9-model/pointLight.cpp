@@ -20,6 +20,7 @@ PointLight::PointLight()
     ambient = DEFAULT_AMBIENT_LIGHT;
     diffuse = DEFAULT_DIFFUSE_LIGHT;
     specular = DEFAULT_SPECULAR_LIGHT;
+    shadowSlot = -1;
 }
 
 PointLight::PointLight(glm::vec3 position, float constant, float linear, float quadratic, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular)
@@ -31,6 +32,7 @@ PointLight::PointLight(glm::vec3 position, float constant, float linear, float q
     this->ambient = ambient;
     this->diffuse = diffuse;
     this->specular = specular;
+    shadowSlot = -1;
 }
 
 PointLight::~PointLight()
@@ -59,3 +61,30 @@ void PointLight::injectIndex(unsigned int index)
     for (auto& entry : pointLightPropsMap) 
         std::sprintf(&entry.second[0], entry.second.c_str(), index);    // Using std::sprintf to inject the index into the existing string
 }
+
+float PointLight::getRange() const
+{
+    // Solve constant + linear * d + quadratic * d^2 = maxIntensity / LIGHT_CUTOFF_INTENSITY for d
+    float maxIntensity = std::max(std::max(diffuse.x, diffuse.y), std::max(diffuse.z, std::max(std::max(specular.x, specular.y), specular.z)));
+    float target = std::max(maxIntensity, std::max(std::max(ambient.x, ambient.y), ambient.z)) / LIGHT_CUTOFF_INTENSITY;
+    if(target <= constant)
+        return 0.0f;
+
+    if(quadratic > 0.0f)
+        return (-linear + std::sqrt(linear * linear - 4.0f * quadratic * (constant - target))) / (2.0f * quadratic);
+    if(linear > 0.0f)
+        return (target - constant) / linear;
+
+    // Light never attenuates
+    return std::numeric_limits<float>::max();
+}
+
+void PointLight::pack(glm::vec4* texels) const
+{
+    texels[0] = glm::vec4(position, getRange());
+    texels[1] = glm::vec4(ambient, constant);
+    texels[2] = glm::vec4(diffuse, linear);
+    texels[3] = glm::vec4(specular, quadratic);
+    texels[4] = glm::vec4(0.0f);
+    texels[5] = glm::vec4(0.0f, float(LIGHT_POINT), float(shadowSlot), 0.0f);
+}
@@ -6,6 +6,8 @@ const glm::vec3 DEFAULT_POSITION = glm::vec3(0.0f);
 constexpr float DEFAULT_CONSTANT = 1.0f;
 constexpr float DEFAULT_LINEAR = 0.1f;
 constexpr float DEFAULT_QUADRATIC = 0.032f;
+// Light contribution below this fraction of its brightest component is treated as zero when computing light's range
+constexpr float LIGHT_CUTOFF_INTENSITY = 5.0f / 256.0f;
 
 enum PointLightProperties
 {
@@ -25,6 +27,7 @@ protected:
     float constant;
     float linear;
     float quadratic;
+    int shadowSlot;     // Slot in point shadow atlas, -1 when light casts no shadow
 
     std::map<int, std::string> pointLightPropsMap = 
     {
@@ -45,4 +48,27 @@ public:
     void load(GLuint shaderId);
     void clear();
     void injectIndex(unsigned int index);
+
+    /**
+     * @brief Distance at which attenuation makes light too dark to notice, used to cull light against clusters.
+    */
+    float getRange() const;
+
+    /**
+     * @brief Write light into LIGHT_TEXELS texels of packed light buffer (layout is described in light.h).
+     * @param texels Destination texels.
+    */
+    void pack(glm::vec4* texels) const;
+
+    using Light::setAmbient;
+    using Light::setDiffuse;
+    using Light::setSpecular;
+
+    void setPosition(glm::vec3 position) { this->position = position; };
+    glm::vec3 getPosition() const { return position; };
+
+    void setAttenuation(float constant, float linear, float quadratic) { this->constant = constant; this->linear = linear; this->quadratic = quadratic; };
+
+    void setShadowSlot(int shadowSlot) { this->shadowSlot = shadowSlot; };
+    int getShadowSlot() const { return shadowSlot; };
 };
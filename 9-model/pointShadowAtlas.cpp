@@ -0,0 +1,279 @@
+#include "pointShadowAtlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Cube map face order: +X, -X, +Y, -Y, +Z, -Z
+static const glm::vec3 FACE_DIRECTIONS[CUBE_FACES] =
+{
+    glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(-1.0f,  0.0f,  0.0f),
+    glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3( 0.0f, -1.0f,  0.0f),
+    glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3( 0.0f,  0.0f, -1.0f),
+};
+static const glm::vec3 FACE_UPS[CUBE_FACES] =
+{
+    glm::vec3(0.0f, -1.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f),
+    glm::vec3(0.0f,  0.0f,  1.0f), glm::vec3(0.0f,  0.0f, -1.0f),
+    glm::vec3(0.0f, -1.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f),
+};
+
+bool PointShadowAtlas::hasVertexLayer()
+{
+    return GLEW_ARB_shader_viewport_layer_array || GLEW_AMD_vertex_shader_layer;
+}
+
+PointShadowAtlas::PointShadowAtlas(const std::string &shaderDirectory, unsigned int slotCount, unsigned int resolution, unsigned int updateBudget) :
+vertexLayer(hasVertexLayer()),
+depthShader((shaderDirectory + (vertexLayer ? "/pointShadowLayer.vs" : "/pointShadow.vs")).c_str(), (shaderDirectory + "/pointShadow.fs").c_str(),
+            vertexLayer ? nullptr : (shaderDirectory + "/pointShadow.gs").c_str(), ShaderPreprocessor::define("CUBE_FACES", std::to_string(CUBE_FACES)))
+{
+    GLint maxLayers;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if(slotCount == 0 || slotCount * CUBE_FACES > (unsigned int)maxLayers)
+    {
+        std::cerr << "ERROR::PointShadowAtlas::slot count must be between 1 and " << maxLayers / CUBE_FACES << ", using 1" << std::endl;
+        slotCount = 1;
+    }
+
+    this->slotCount = slotCount;
+    this->resolution = resolution;
+    this->updateBudget = std::max(updateBudget, 1u);
+    frame = 0;
+    renderedLightCount = 0;
+    drawnMeshCount = 0;
+    slots.assign(slotCount, PointShadowSlot{ nullptr, false, 0, glm::vec3(0.0f), 0.0f });
+
+    // Only x and y of face clip space are used for lookups, so near and far don't matter here
+    glm::mat4 faceProjection = glm::perspective(glm::radians(90.0f), 1.0f, POINT_SHADOW_NEAR, 1.0f);
+    for(unsigned int i = 0; i < CUBE_FACES; i++)
+        faceRotations[i] = faceProjection * glm::lookAt(glm::vec3(0.0f), FACE_DIRECTIONS[i], FACE_UPS[i]);
+
+    glGenTextures(1, &depthArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, slotCount * CUBE_FACES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    // Hardware depth comparison with bilinear filtering gives 2x2 PCF for every lookup
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Faces don't filter across their edges, clamping keeps taps inside the face
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // Attaching the whole array makes framebuffer layered, gl_Layer selects face
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "ERROR::PointShadowAtlas::layered framebuffer is not complete" << std::endl;
+
+    // Clearing a layered framebuffer clears every layer, slots are cleared one layer at a time through this one
+    glGenFramebuffers(1, &clearFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, clearFramebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "ERROR::PointShadowAtlas::clear framebuffer is not complete" << std::endl;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+PointShadowAtlas::~PointShadowAtlas()
+{
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteFramebuffers(1, &clearFramebuffer);
+    glDeleteTextures(1, &depthArray);
+}
+
+bool PointShadowAtlas::hasDynamicCasterInRange(glm::vec3 position, float range, const std::vector<ShadowCaster> &casters) const
+{
+    for(const ShadowCaster &caster : casters)
+    {
+        if(caster.isStatic)
+            continue;
+
+        float scale = std::max(glm::length(glm::vec3(caster.transform[0])), std::max(glm::length(glm::vec3(caster.transform[1])), glm::length(glm::vec3(caster.transform[2]))));
+        for(Mesh &mesh : caster.model->meshes)
+        {
+            glm::vec3 meshCenter = glm::vec3(caster.transform * glm::vec4(mesh.boundsCenter, 1.0f));
+            if(glm::length(meshCenter - position) < range + mesh.boundsRadius * scale)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void PointShadowAtlas::renderSlot(unsigned int slotIndex, const std::vector<ShadowCaster> &casters)
+{
+    PointShadowSlot &slot = slots[slotIndex];
+    unsigned int baseLayer = slotIndex * CUBE_FACES;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, clearFramebuffer);
+    for(unsigned int i = 0; i < CUBE_FACES; i++)
+    {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, baseLayer + i);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, POINT_SHADOW_NEAR, slot.range);
+    for(unsigned int i = 0; i < CUBE_FACES; i++)
+        depthShader.setMatrix4fv("faceMatrices[" + std::to_string(i) + "]", 1, GL_FALSE, projection * glm::lookAt(slot.position, slot.position + FACE_DIRECTIONS[i], FACE_UPS[i]));
+    depthShader.setVec3("lightPosition", glm::value_ptr(slot.position));
+    depthShader.setFloat("lightRange", slot.range);
+    depthShader.setInt("baseLayer", baseLayer);
+
+    for(const ShadowCaster &caster : casters)
+    {
+        depthShader.setMatrix4fv("model", 1, GL_FALSE, caster.transform);
+        float scale = std::max(glm::length(glm::vec3(caster.transform[0])), std::max(glm::length(glm::vec3(caster.transform[1])), glm::length(glm::vec3(caster.transform[2]))));
+
+        for(Mesh &mesh : caster.model->meshes)
+        {
+            glm::vec3 meshCenter = glm::vec3(caster.transform * glm::vec4(mesh.boundsCenter, 1.0f));
+            if(glm::length(meshCenter - slot.position) > slot.range + mesh.boundsRadius * scale)
+                continue;
+
+            mesh.drawPositions(vertexLayer ? CUBE_FACES : 1);
+            drawnMeshCount++;
+        }
+    }
+
+    slot.valid = true;
+    slot.lastUpdate = frame;
+}
+
+void PointShadowAtlas::update(const std::vector<ShadowedPointLight> &lights, glm::vec3 cameraPosition, const std::vector<ShadowCaster> &casters)
+{
+    frame++;
+    renderedLightCount = 0;
+    drawnMeshCount = 0;
+
+    // Slots are written back at the end, lights that lose their slot (or are no longer listed) end up unshadowed
+    for(PointShadowSlot &slot : slots)
+    {
+        if(slot.owner != nullptr)
+            slot.owner->setShadowSlot(-1);
+    }
+
+    // Importance is roughly how big light is on screen
+    std::vector<std::pair<float, unsigned int>> ranked;
+    for(unsigned int i = 0; i < lights.size(); i++)
+    {
+        PointLight* light = lights[i].light;
+        float range = light->getRange();
+        // Lights that never attenuate have no far plane to render with
+        if(range <= 0.0f || range == std::numeric_limits<float>::max())
+            continue;
+        ranked.push_back({ range / std::max(glm::length(light->getPosition() - cameraPosition), 1.0f), i });
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const std::pair<float, unsigned int> &a, const std::pair<float, unsigned int> &b) { return a.first > b.first; });
+    if(ranked.size() > slotCount)
+        ranked.resize(slotCount);
+
+    // Lights that keep their slot keep their map, slots of lights that dropped out are freed
+    std::vector<int> lightSlots(ranked.size(), -1);
+    for(PointShadowSlot &slot : slots)
+    {
+        bool kept = false;
+        for(unsigned int i = 0; i < ranked.size() && !kept; i++)
+        {
+            if(slot.owner == lights[ranked[i].second].light)
+            {
+                lightSlots[i] = &slot - &slots[0];
+                kept = true;
+            }
+        }
+        if(!kept)
+        {
+            slot.owner = nullptr;
+            slot.valid = false;
+        }
+    }
+
+    for(unsigned int i = 0, free = 0; i < ranked.size(); i++)
+    {
+        if(lightSlots[i] >= 0)
+            continue;
+        while(slots[free].owner != nullptr)
+            free++;
+        slots[free].owner = lights[ranked[i].second].light;
+        slots[free].valid = false;
+        lightSlots[i] = free;
+    }
+
+    // Pick lights to render this update: missing maps first, then stale maps by importance and age
+    std::vector<std::pair<float, unsigned int>> pending;
+    for(unsigned int i = 0; i < ranked.size(); i++)
+    {
+        const ShadowedPointLight &shadowed = lights[ranked[i].second];
+        PointShadowSlot &slot = slots[lightSlots[i]];
+        glm::vec3 position = shadowed.light->getPosition();
+        float range = shadowed.light->getRange();
+
+        float priority;
+        if(!slot.valid)
+            priority = std::numeric_limits<float>::max();
+        else if(!shadowed.isStatic || position != slot.position || range != slot.range || hasDynamicCasterInRange(position, range, casters))
+            priority = ranked[i].first * float(frame - slot.lastUpdate);
+        else
+            continue;
+
+        pending.push_back({ priority, i });
+    }
+    std::sort(pending.begin(), pending.end(), [](const std::pair<float, unsigned int> &a, const std::pair<float, unsigned int> &b) { return a.first > b.first; });
+    if(pending.size() > updateBudget)
+        pending.resize(updateBudget);
+
+    if(!pending.empty())
+    {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glViewport(0, 0, resolution, resolution);
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_TRUE);
+
+        depthShader.use();
+        for(const std::pair<float, unsigned int> &entry : pending)
+        {
+            PointShadowSlot &slot = slots[lightSlots[entry.second]];
+            slot.position = slot.owner->getPosition();
+            slot.range = slot.owner->getRange();
+            renderSlot(lightSlots[entry.second], casters);
+            renderedLightCount++;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+    // Lights still waiting for their first map stay unshadowed
+    for(unsigned int i = 0; i < ranked.size(); i++)
+    {
+        if(slots[lightSlots[i]].valid)
+            lights[ranked[i].second].light->setShadowSlot(lightSlots[i]);
+    }
+}
+
+void PointShadowAtlas::invalidateStatic()
+{
+    for(PointShadowSlot &slot : slots)
+        slot.valid = false;
+}
+
+void PointShadowAtlas::bind(Shader &shader, unsigned int textureUnit)
+{
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.setInt("pointShadowAtlas", textureUnit);
+    for(unsigned int i = 0; i < CUBE_FACES; i++)
+        shader.setMatrix4fv("pointShadowFaces[" + std::to_string(i) + "]", 1, GL_FALSE, faceRotations[i]);
+}
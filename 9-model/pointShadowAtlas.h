@@ -0,0 +1,128 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "shader.h"
+#include "shaderPreprocessor.h"
+#include "model.h"
+#include "pointLight.h"
+#include "cascadedShadowMap.h"
+
+constexpr unsigned int CUBE_FACES = 6;       // Injected into shaders
+constexpr float POINT_SHADOW_NEAR = 0.05f;
+
+/**
+ * @brief Struct ShadowedPointLight is a point light that may get a slot in the point shadow atlas.
+ * Static lights never move, their map is rendered once and kept until a dynamic caster comes into range.
+*/
+struct ShadowedPointLight
+{
+    PointLight* light;
+    bool isStatic;
+};
+
+/**
+ * @brief Struct PointShadowSlot stores state of one cube map in the atlas.
+*/
+struct PointShadowSlot
+{
+    PointLight* owner;              // Light using slot, nullptr when free
+    bool valid;                     // Slot holds a rendered map of owner
+    unsigned long lastUpdate;       // Frame slot was last rendered in
+    glm::vec3 position;             // Light position it was rendered from
+    float range;                    // Light range it was rendered with
+};
+
+/**
+ * @brief Class PointShadowAtlas renders omnidirectional point light shadows into one depth array texture,
+ * every slot takes CUBE_FACES consecutive layers. Every face stores linear distance to light divided by light's range.
+ *
+ * A light is rendered in a single pass: geometry shader routes every triangle to the faces it touches with gl_Layer,
+ * or, when ARB_shader_viewport_layer_array / AMD_vertex_shader_layer is available, every mesh is drawn with
+ * CUBE_FACES instances and vertex shader picks the layer, skipping the geometry shader stage.
+ *
+ * Slots go to the most important lights (range over distance to camera). Only updateBudget lights are rendered per frame:
+ * lights without a valid map first, then moving lights and lights with moving casters in range, ordered by importance
+ * times frames since their last update, so every one of them gets its turn. Unchanged static lights are never re-rendered.
+*/
+class PointShadowAtlas
+{
+private:
+    unsigned int slotCount;
+    unsigned int resolution;
+    unsigned int updateBudget;
+    bool vertexLayer;                   // Layer is picked in vertex shader, no geometry shader
+
+    std::vector<PointShadowSlot> slots;
+    unsigned long frame;
+
+    unsigned int depthArray;            // slotCount * CUBE_FACES layers
+    unsigned int framebuffer;           // Whole array attached, layer picked by shaders
+    unsigned int clearFramebuffer;      // Single layer attached, to clear one slot
+
+    Shader depthShader;
+
+    glm::mat4 faceRotations[CUBE_FACES];    // Light space to face clip space, light at origin
+
+    unsigned int renderedLightCount;    // Lights rendered in last update
+    unsigned int drawnMeshCount;        // Meshes drawn in last update
+
+    /**
+     * @brief Check for an extension that allows writing gl_Layer in vertex shader.
+    */
+    static bool hasVertexLayer();
+
+    /**
+     * @brief Clear slot's layers and draw casters in light's range into them.
+    */
+    void renderSlot(unsigned int slotIndex, const std::vector<ShadowCaster> &casters);
+
+    /**
+     * @brief Check if any dynamic caster has a mesh within range of position.
+    */
+    bool hasDynamicCasterInRange(glm::vec3 position, float range, const std::vector<ShadowCaster> &casters) const;
+
+public:
+    /**
+     * @brief Constructor to create shadow atlas.
+     * @param shaderDirectory Directory with pointShadow shaders.
+     * @param slotCount Number of lights that can have shadows at once.
+     * @param resolution Width and height of every cube face.
+     * @param updateBudget Number of lights rendered per update.
+    */
+    PointShadowAtlas(const std::string &shaderDirectory, unsigned int slotCount = 8, unsigned int resolution = 512, unsigned int updateBudget = 2);
+    ~PointShadowAtlas();
+
+    /**
+     * @brief Assign slots to lights, render lights that need it within budget and write slots back into lights (-1 for no shadow).
+     * Changes viewport and framebuffer binding and restores them.
+     * @param lights Lights that can cast shadows, lights must not move in memory between updates. Empty list frees all slots.
+     * @param cameraPosition Position of camera, nearby lights are more important.
+     * @param casters All shadow casters.
+    */
+    void update(const std::vector<ShadowedPointLight> &lights, glm::vec3 cameraPosition, const std::vector<ShadowCaster> &casters);
+
+    /**
+     * @brief Bind atlas and set face uniforms of shader.
+     * @param shader Lighting shader, must be in use.
+     * @param textureUnit Texture unit to bind atlas to.
+    */
+    void bind(Shader &shader, unsigned int textureUnit);
+
+    /**
+     * @brief Re-render every map within update budgets, call when static geometry changes.
+    */
+    void invalidateStatic();
+
+    unsigned int getRenderedLightCount() const { return renderedLightCount; };
+    unsigned int getDrawnMeshCount() const { return drawnMeshCount; };
+};
@@ -0,0 +1,157 @@
+#include "programCache.h"
+
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+
+// 64-bit FNV-1a, continues from hash so several strings can be chained
+static uint64_t hashString(const std::string &text, uint64_t hash)
+{
+    for(unsigned char character : text)
+    {
+        hash ^= character;
+        hash *= 0x100000001b3ull;
+    }
+
+    // Separator, so ("ab", "c") and ("a", "bc") hash differently
+    hash ^= 0xff;
+    hash *= 0x100000001b3ull;
+    return hash;
+}
+
+std::string& ProgramCache::getDirectory()
+{
+    static std::string directory;
+    return directory;
+}
+
+std::string ProgramCache::getPath(uint64_t key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return getDirectory() + "/" + name;
+}
+
+void ProgramCache::setDirectory(const std::string &directory)
+{
+    getDirectory().clear();
+    if(directory.empty())
+        return;
+
+    if(!GLEW_ARB_get_program_binary)
+    {
+        std::cerr << "ERROR::ProgramCache::ARB_get_program_binary is not supported, shaders are compiled every run" << std::endl;
+        return;
+    }
+
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if(formatCount == 0)
+    {
+        std::cerr << "ERROR::ProgramCache::driver has no program binary formats, shaders are compiled every run" << std::endl;
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if(error)
+    {
+        std::cerr << "ERROR::ProgramCache::failed to create " << directory << ": " << error.message() << std::endl;
+        return;
+    }
+
+    getDirectory() = directory;
+}
+
+bool ProgramCache::isEnabled()
+{
+    return !getDirectory().empty();
+}
+
+uint64_t ProgramCache::makeKey(const std::vector<std::string> &sources, const std::string &defines)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(const std::string &source : sources)
+        hash = hashString(source, hash);
+    hash = hashString(defines, hash);
+
+    // Binaries are only valid for the driver that produced them
+    const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+    for(GLenum name : driverStrings)
+    {
+        const GLubyte* value = glGetString(name);
+        hash = hashString(value != nullptr ? reinterpret_cast<const char*>(value) : "", hash);
+    }
+
+    return hash;
+}
+
+bool ProgramCache::load(GLuint program, uint64_t key)
+{
+    if(!isEnabled())
+        return false;
+
+    std::ifstream file(getPath(key), std::ios::binary);
+    if(!file.is_open())
+        return false;
+
+    ProgramCacheHeader header;
+    if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != PROGRAM_CACHE_MAGIC || header.version != PROGRAM_CACHE_VERSION || header.key != key)
+        return false;
+
+    std::vector<char> binary(header.length);
+    if(!file.read(binary.data(), header.length))
+        return false;
+
+    glProgramBinary(program, header.format, binary.data(), header.length);
+
+    // Driver rejects binaries it can no longer use by failing link status
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success == GL_TRUE;
+}
+
+void ProgramCache::prepare(GLuint program)
+{
+    if(isEnabled())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramCache::store(GLuint program, uint64_t key)
+{
+    if(!isEnabled())
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0)
+        return;
+
+    ProgramCacheHeader header;
+    header.magic = PROGRAM_CACHE_MAGIC;
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key;
+
+    std::vector<char> binary(length);
+    GLenum format;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+    header.format = format;
+    header.length = length;
+
+    // Write next to final file and rename, so a crash or a second instance never leaves a half written binary
+    std::string path = getPath(key);
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if(!file.is_open() || !file.write(reinterpret_cast<const char*>(&header), sizeof(header)) || !file.write(binary.data(), length))
+        {
+            std::cerr << "ERROR::ProgramCache::failed to write " << temporaryPath << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if(error)
+        std::cerr << "ERROR::ProgramCache::failed to write " << path << ": " << error.message() << std::endl;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+constexpr uint32_t PROGRAM_CACHE_MAGIC = 0x42504c47;    // "GLPB"
+constexpr uint32_t PROGRAM_CACHE_VERSION = 1;
+
+/**
+ * @brief Struct ProgramCacheHeader starts every cache file, program binary follows it.
+*/
+struct ProgramCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;           // Repeated so a renamed or truncated file is never loaded for a different program
+    uint32_t format;        // Binary format returned by glGetProgramBinary
+    uint32_t length;        // Size of binary in bytes
+};
+
+/**
+ * @brief Class ProgramCache stores linked shader programs on disk with glGetProgramBinary and loads them back with glProgramBinary,
+ * so later runs skip compiling and linking.
+ *
+ * A program's key hashes its sources, defines and driver vendor, renderer and version, so any change in them misses the cache.
+ * Driver may still reject a stored binary (it is allowed to after any update), then Shader compiles normally and replaces the file.
+ * Cache is off until setDirectory() is called, and stays off without ARB_get_program_binary.
+*/
+class ProgramCache
+{
+private:
+    static std::string& getDirectory();
+
+    /**
+     * @brief Path of cache file for key.
+    */
+    static std::string getPath(uint64_t key);
+
+public:
+    /**
+     * @brief Enable cache, must be called after GLEW is initialised.
+     * @param directory Directory to store binaries in, created if missing. Empty string disables cache.
+    */
+    static void setDirectory(const std::string &directory);
+
+    static bool isEnabled();
+
+    /**
+     * @brief Compute cache key of a program.
+     * @param sources Source of every shader stage, in a fixed stage order.
+     * @param defines Defines injected into sources (empty if none).
+    */
+    static uint64_t makeKey(const std::vector<std::string> &sources, const std::string &defines);
+
+    /**
+     * @brief Load cached binary into program.
+     * @param program Created, not yet linked program.
+     * @return True if binary was found and driver accepted it, program is linked then.
+    */
+    static bool load(GLuint program, uint64_t key);
+
+    /**
+     * @brief Prepare program to be linked, driver only keeps a retrievable binary when asked before linking.
+    */
+    static void prepare(GLuint program);
+
+    /**
+     * @brief Store binary of linked program.
+    */
+    static void store(GLuint program, uint64_t key);
+};
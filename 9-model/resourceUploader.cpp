@@ -0,0 +1,125 @@
+#include "resourceUploader.h"
+#include "cpuProfiler.h"
+
+ResourceUploader::ResourceUploader(GLFWwindow* sharedContext)
+{
+    context = sharedContext;
+    stopping = false;
+    pending = 0;
+
+    if(context != nullptr)
+        loader = std::thread(&ResourceUploader::loaderLoop, this);
+}
+
+ResourceUploader::~ResourceUploader()
+{
+    stop();
+}
+
+void ResourceUploader::loaderLoop()
+{
+    CpuProfiler::setThreadName("Resource loader");
+    glfwMakeContextCurrent(context);
+
+    while(true)
+    {
+        Task task;
+        if(!tasks.pop(task))
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait(lock, [this]() { return stopping || !tasks.isEmpty(); });
+            if(stopping && tasks.isEmpty())
+                break;
+            continue;
+        }
+
+        CPU_ZONE("upload");
+        task.work();
+
+        // Flush makes sure the fence reaches the GPU, render context could wait on it forever otherwise
+        Finished done;
+        done.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        done.complete = std::move(task.complete);
+        glFlush();
+
+        while(!finished.push(std::move(done)))
+            std::this_thread::yield();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+void ResourceUploader::submit(Function work, Function complete)
+{
+    if(context == nullptr)
+    {
+        work();
+        complete();
+        return;
+    }
+
+    Task task;
+    task.work = std::move(work);
+    task.complete = std::move(complete);
+    pending++;
+
+    // Full means loader is far behind, render thread takes back finished work while waiting so loader can't block on it
+    while(!tasks.push(std::move(task)))
+    {
+        poll();
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+unsigned int ResourceUploader::poll()
+{
+    Finished done;
+    while(finished.pop(done))
+        waiting.push_back(std::move(done));
+
+    // Loader finishes tasks in submission order, so fences signal in order too
+    while(!waiting.empty())
+    {
+        GLenum status = glClientWaitSync(waiting.front().fence, 0, 0);
+        if(status == GL_TIMEOUT_EXPIRED)
+            break;
+        if(status == GL_WAIT_FAILED)
+            std::cerr << "ERROR::ResourceUploader::waiting for upload fence failed" << std::endl;
+
+        glDeleteSync(waiting.front().fence);
+        Function complete = std::move(waiting.front().complete);
+        waiting.pop_front();
+        pending--;
+        complete();
+    }
+
+    return pending;
+}
+
+void ResourceUploader::finish()
+{
+    while(poll() != 0)
+        std::this_thread::yield();
+}
+
+void ResourceUploader::stop()
+{
+    if(!loader.joinable())
+        return;
+
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_one();
+    loader.join();
+
+    glfwDestroyWindow(context);
+    context = nullptr;
+}
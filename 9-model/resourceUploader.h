@@ -0,0 +1,92 @@
+#pragma once
+
+#include <iostream>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "spscQueue.h"
+
+constexpr size_t UPLOAD_QUEUE_CAPACITY = 1024;
+
+/**
+ * @brief Class ResourceUploader runs GL object creation on a loader thread with its own context shared with the render context.
+ *
+ * Work (glGenBuffers, glBufferData, glTexImage2D, ...) is handed to the loader thread through a lock-free queue. After each
+ * task the loader thread inserts a fence and hands it back through a second queue. poll() on the render thread runs a task's
+ * completion once its fence signaled, so the render thread never uses an object before its data is on the GPU.
+ *
+ * Only objects that are shared between contexts may be created in work: buffers, textures, renderbuffers, programs, syncs.
+ * Container objects (vertex arrays, framebuffers) belong to one context, create them in completion.
+ * Without a shared context, work and completion simply run on the render thread in submit().
+*/
+class ResourceUploader
+{
+public:
+    using Function = std::function<void()>;
+
+private:
+    struct Task
+    {
+        Function work;
+        Function complete;
+    };
+
+    struct Finished
+    {
+        GLsync fence = 0;
+        Function complete;
+    };
+
+    GLFWwindow* context;                        // Hidden window owning shared context, nullptr if there is none
+    std::thread loader;
+    std::atomic<bool> stopping;
+
+    SpscQueue<Task, UPLOAD_QUEUE_CAPACITY> tasks;           // Render thread to loader thread
+    SpscQueue<Finished, UPLOAD_QUEUE_CAPACITY> finished;    // Loader thread to render thread
+    std::deque<Finished> waiting;               // Render thread only, fences not signaled yet
+    unsigned int pending;                       // Render thread only, submitted but not completed
+
+    // Only used to sleep while there is no work, queues themselves don't lock
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+
+    void loaderLoop();
+
+public:
+    /**
+     * @brief Start loader thread, call on main thread.
+     * @param sharedContext Hidden window from glWindow::createSharedContext(), nullptr to run everything on render thread.
+    */
+    ResourceUploader(GLFWwindow* sharedContext);
+    ~ResourceUploader();
+
+    /**
+     * @brief Run work on loader thread and complete on render thread once GPU has the result. Render thread only.
+    */
+    void submit(Function work, Function complete);
+
+    /**
+     * @brief Run completions of finished work, call once per frame on render thread.
+     * @return Number of tasks still pending.
+    */
+    unsigned int poll();
+
+    /**
+     * @brief Block until every submitted task is completed.
+    */
+    void finish();
+
+    /**
+     * @brief Finish pending work, stop loader thread and destroy shared context. Must run before glfwTerminate().
+    */
+    void stop();
+
+    bool isIdle() const { return pending == 0; };
+};
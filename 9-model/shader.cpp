@@ -1,92 +1,279 @@
 #include "shader.h"
 #include "stb_image.h"
+#include "programCache.h"
+#include "shaderPreprocessor.h"
+#include "shaderCompiler.h"
+#include "shaderReloader.h"
+#include "assetFileSystem.h"
 
+#include <algorithm>
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath, const std::string &defines)
 {
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::string geometryCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    std::ifstream gShaderFile;
+    paths[0] = vertexPath;
+    paths[1] = fragmentPath;
+    paths[2] = geometryPath != nullptr ? geometryPath : "";
+    this->defines = defines;
+    pending = false;
+    reloading = false;
+    reloadID = 0;
+
+    // Sources are expanded (includes and injected defines) before compiling
+    std::string codes[3];
+    if(!readSources(codes, sourceFiles))
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << vertexPath << ", " << fragmentPath << std::endl;
+
+    bool fromCache;
+    ID = submitProgram(codes, cacheKey, stageShaders, fromCache);
+    ShaderReloader::track(this);
+    if(fromCache)
+        return;
 
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
+    pending = true;
+    if(ShaderCompiler::isBatching())
+        ShaderCompiler::add(this);
+    else
+        finish(true);
+}
+
+bool Shader::readSources(std::string* codes, std::vector<std::string> &files) const
+{
+    files.clear();
+    bool loaded = true;
+    for(unsigned int i = 0; i < 3; i++)
     {
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
+        codes[i].clear();
+        if(!paths[i].empty())
+            loaded = ShaderPreprocessor::load(paths[i], defines, codes[i], &files) && loaded;
+    }
 
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
+    return loaded;
+}
 
-        vShaderFile.close();
-        fShaderFile.close();
+GLuint Shader::submitProgram(const std::string* codes, uint64_t &key, GLuint* stages, bool &fromCache)
+{
+    // Create shader program, from cached binary when a matching one exists
+    GLuint program = glCreateProgram();
+    stages[0] = stages[1] = stages[2] = 0;
+    key = ProgramCache::makeKey({ codes[0], codes[1], codes[2] }, defines);
+    fromCache = ProgramCache::load(program, key);
+    if(fromCache)
+        return program;
+
+    // Nothing is queried until results are checked, so driver can compile in the background
+    const GLenum stageTypes[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+    for(unsigned int i = 0; i < 3; i++)
+    {
+        if(!paths[i].empty())
+            stages[i] = addShader(program, codes[i].c_str(), stageTypes[i]);
+    }
+    ProgramCache::prepare(program);
+    glLinkProgram(program);
 
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+    return program;
+}
 
-        if(geometryPath != nullptr)
-        {
-            gShaderFile.open(geometryPath);
-            std::stringstream gShaderStream;
-            gShaderStream << gShaderFile.rdbuf();
-            gShaderFile.close();
-            geometryCode = gShaderStream.str();
+bool Shader::isCompleted(GLuint program) const
+{
+    if(!GLEW_KHR_parallel_shader_compile)
+        return true;
+
+    GLint completed;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completed);
+    return completed == GL_TRUE;
+}
 
+bool Shader::checkProgram(GLuint program, GLuint* stages, uint64_t key)
+{
+    const GLenum stageTypes[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+    for(unsigned int i = 0; i < 3; i++)
+    {
+        if(stages[i] != 0)
+        {
+            checkCompileErrors(stages[i], stageTypes[i]);
+            glDeleteShader(stages[i]);
+            stages[i] = 0;
         }
     }
-    catch(std::ifstream::failure &e)
+    checkCompileErrors(program, GL_PROGRAM);
+
+    GLint linked;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if(linked == GL_TRUE)
+        ProgramCache::store(program, key);
+
+    return linked == GL_TRUE;
+}
+
+bool Shader::finish(bool wait)
+{
+    if(!pending)
+        return true;
+    if(!wait && !isCompleted(ID))
+        return false;
+
+    checkProgram(ID, stageShaders, cacheKey);
+    pending = false;
+    return true;
+}
+
+bool Shader::dependsOn(const std::string &file) const
+{
+    return std::find(sourceFiles.begin(), sourceFiles.end(), file) != sourceFiles.end();
+}
+
+bool Shader::reload()
+{
+    if(pending || reloading)
+        return false;
+
+    // Includes may have changed too, watch what the new sources use
+    std::string codes[3];
+    std::vector<std::string> files;
+    if(!readSources(codes, files))
     {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;       
+        std::cerr << "ERROR::SHADER::RELOAD_FAILED: couldn't read " << paths[0] << ", " << paths[1] << ", keeping previous program" << std::endl;
+        return false;
     }
-    
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
+    sourceFiles = files;
 
-    // Create shader program
-    ID = glCreateProgram();
+    reloadID = submitProgram(codes, reloadKey, reloadStages, reloadFromCache);
+    reloading = true;
+    return true;
+}
 
-    GLuint vShader = addShader(ID, vertexCode.c_str(), GL_VERTEX_SHADER);
-    GLuint fShader = addShader(ID, fragmentCode.c_str(), GL_FRAGMENT_SHADER);
-    GLuint gShader  = 0;
-    if(geometryPath != nullptr)
+bool Shader::finishReload(bool wait)
+{
+    if(!reloading)
+        return true;
+    if(!reloadFromCache && !wait && !isCompleted(reloadID))
+        return false;
+
+    reloading = false;
+    if(!reloadFromCache && !checkProgram(reloadID, reloadStages, reloadKey))
     {
-        gShader = addShader(ID, geometryCode.c_str(), GL_GEOMETRY_SHADER);
+        std::cerr << "ERROR::SHADER::RELOAD_FAILED: " << paths[0] << ", " << paths[1] << ", keeping previous program" << std::endl;
+        glDeleteProgram(reloadID);
+        reloadID = 0;
+        return true;
     }
-    glLinkProgram(ID);
-    checkCompileErrors(ID, GL_PROGRAM);
 
-    glDeleteShader(vShader);
-    glDeleteShader(fShader);
-    if(geometryPath != nullptr)
+    // Values and block bindings set once at start-up live in the program object, carry them over
+    copyProgramState(ID, reloadID);
+    glDeleteProgram(ID);
+    ID = reloadID;
+    cacheKey = reloadKey;
+    reloadID = 0;
+
+    std::cout << "Shader reloaded: " << paths[0] << ", " << paths[1] << std::endl;
+    return true;
+}
+
+void Shader::copyProgramState(GLuint source, GLuint destination)
+{
+    GLint blockCount = 0;
+    glGetProgramiv(source, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    for(GLint i = 0; i < blockCount; i++)
     {
-        glDeleteShader(gShader);
+        GLchar name[256];
+        GLint binding;
+        glGetActiveUniformBlockName(source, i, sizeof(name), NULL, name);
+        glGetActiveUniformBlockiv(source, i, GL_UNIFORM_BLOCK_BINDING, &binding);
+
+        GLuint index = glGetUniformBlockIndex(destination, name);
+        if(index != GL_INVALID_INDEX)
+            glUniformBlockBinding(destination, index, binding);
     }
+
+    // GL 3.3 has no glProgramUniform, destination has to be current while values are set
+    GLint previousProgram;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+    glUseProgram(destination);
+
+    GLint uniformCount = 0;
+    glGetProgramiv(source, GL_ACTIVE_UNIFORMS, &uniformCount);
+    for(GLint i = 0; i < uniformCount; i++)
+    {
+        GLchar name[256];
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(source, i, sizeof(name), NULL, &size, &type, name);
+
+        // Block members are stored in buffers, not in the program
+        GLuint uniformIndex = i;
+        GLint blockIndex;
+        glGetActiveUniformsiv(source, 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+        if(blockIndex != -1)
+            continue;
+
+        // Arrays are reported once as "name[0]", every element has its own location
+        std::string baseName = name;
+        if(size > 1 && baseName.size() > 3 && baseName.compare(baseName.size() - 3, 3, "[0]") == 0)
+            baseName.erase(baseName.size() - 3);
+
+        for(GLint element = 0; element < size; element++)
+        {
+            std::string elementName = size > 1 ? baseName + "[" + std::to_string(element) + "]" : baseName;
+            GLint sourceLocation = glGetUniformLocation(source, elementName.c_str());
+            GLint destinationLocation = glGetUniformLocation(destination, elementName.c_str());
+            if(sourceLocation == -1 || destinationLocation == -1)
+                continue;
+
+            GLfloat floats[16];
+            GLint ints[4];
+            GLuint uints[4];
+            switch(type)
+            {
+                case GL_FLOAT:      glGetUniformfv(source, sourceLocation, floats); glUniform1fv(destinationLocation, 1, floats); break;
+                case GL_FLOAT_VEC2: glGetUniformfv(source, sourceLocation, floats); glUniform2fv(destinationLocation, 1, floats); break;
+                case GL_FLOAT_VEC3: glGetUniformfv(source, sourceLocation, floats); glUniform3fv(destinationLocation, 1, floats); break;
+                case GL_FLOAT_VEC4: glGetUniformfv(source, sourceLocation, floats); glUniform4fv(destinationLocation, 1, floats); break;
+                case GL_FLOAT_MAT2: glGetUniformfv(source, sourceLocation, floats); glUniformMatrix2fv(destinationLocation, 1, GL_FALSE, floats); break;
+                case GL_FLOAT_MAT3: glGetUniformfv(source, sourceLocation, floats); glUniformMatrix3fv(destinationLocation, 1, GL_FALSE, floats); break;
+                case GL_FLOAT_MAT4: glGetUniformfv(source, sourceLocation, floats); glUniformMatrix4fv(destinationLocation, 1, GL_FALSE, floats); break;
+                case GL_INT_VEC2: case GL_BOOL_VEC2: glGetUniformiv(source, sourceLocation, ints); glUniform2iv(destinationLocation, 1, ints); break;
+                case GL_INT_VEC3: case GL_BOOL_VEC3: glGetUniformiv(source, sourceLocation, ints); glUniform3iv(destinationLocation, 1, ints); break;
+                case GL_INT_VEC4: case GL_BOOL_VEC4: glGetUniformiv(source, sourceLocation, ints); glUniform4iv(destinationLocation, 1, ints); break;
+                case GL_UNSIGNED_INT:      glGetUniformuiv(source, sourceLocation, uints); glUniform1uiv(destinationLocation, 1, uints); break;
+                case GL_UNSIGNED_INT_VEC2: glGetUniformuiv(source, sourceLocation, uints); glUniform2uiv(destinationLocation, 1, uints); break;
+                case GL_UNSIGNED_INT_VEC3: glGetUniformuiv(source, sourceLocation, uints); glUniform3uiv(destinationLocation, 1, uints); break;
+                case GL_UNSIGNED_INT_VEC4: glGetUniformuiv(source, sourceLocation, uints); glUniform4uiv(destinationLocation, 1, uints); break;
+                case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+                    break;
+                // int, bool and every sampler type hold one int (samplers hold their texture unit)
+                default: glGetUniformiv(source, sourceLocation, ints); glUniform1iv(destinationLocation, 1, ints); break;
+            }
+        }
+    }
+
+    glUseProgram(previousProgram);
 }
 
 Shader::~Shader()
 {
+    ShaderReloader::untrack(this);
+    if(pending)
+        ShaderCompiler::remove(this);
+    for(unsigned int i = 0; i < 3; i++)
+    {
+        if(stageShaders[i] != 0)
+            glDeleteShader(stageShaders[i]);
+        if(reloading && reloadStages[i] != 0)
+            glDeleteShader(reloadStages[i]);
+    }
+    if(reloadID != 0)
+        glDeleteProgram(reloadID);
     clear();
 }
 
 std::string Shader::readFile(std::string filename)
 {
-    std::fstream file(filename, std::ios::in);
-    if(!file.is_open())
-    {
+    std::string text;
+    if(!AssetFileSystem::readText(filename, text))
         std::cerr << "Failed to open file " << filename << std::endl;
-        return "";
-    }
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    file.close();
 
-    return buffer.str();
+    return text;
 }
 
 void Shader::loadTexture(std::string filename, GLuint *texture, GLenum target, GLenum textureParam, GLenum filterParam, GLint level, GLint internalFormat, GLint border, GLint format, GLenum type)
@@ -105,7 +292,9 @@ void Shader::loadTexture(std::string filename, GLuint *texture, GLenum target, G
     // Loading texture from local storage
     int width, height, nrChannels;
     unsigned char* data = nullptr;
-    data = stbi_load(filename.c_str(), &width, &height, &nrChannels, 0);
+    AssetData file;
+    if(AssetFileSystem::read(filename, file))
+        data = stbi_load_from_memory(file.data, file.size, &width, &height, &nrChannels, 0);
     if(!data)
     {
         std::cout << "Failed to load texture" << std::endl;
@@ -130,7 +319,6 @@ GLuint Shader::addShader(GLuint program, const char* shaderCode, GLenum shaderTy
     GLint length = strlen(shaderCode);
     glShaderSource(shader, 1, &src, &length);
     glCompileShader(shader);
-    checkCompileErrors(shader, shaderType);
 
     glAttachShader(program, shader);
 
@@ -6,6 +6,8 @@
 #include <sstream>
 #include <filesystem>
 #include <cstring>
+#include <cstdint>
+#include <vector>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -27,8 +29,11 @@ public:
      * @brief Costructor to build Shader object from shader files.
      * @param vertexPath Path to vertex shader file.
      * @param fragmentPath Path to fragment shader file.
+     * @param geometryPath Path to geometry shader file, nullptr for none.
+     * @param defines Defines injected into every stage (see ShaderPreprocessor).
+     * While ShaderCompiler is batching, compile and link are only submitted and finished later by ShaderCompiler.
     */
-    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr, const std::string &defines = "");
     /**
      * @brief Destructor
     */
@@ -38,7 +43,7 @@ public:
      * @brief Read file from filesystem.
      * @param filename Path to file.
     */
-    std::string readFile(std::string filename);
+    static std::string readFile(std::string filename);
 
     /**
      * @brief Load texture from image in local storage
@@ -67,6 +72,37 @@ public:
 
     GLuint getID() const { return ID; }
 
+    /**
+     * @brief Whether compile and link results were already checked, program can be used either way (driver waits for it).
+    */
+    bool isReady() const { return !pending; }
+
+    /**
+     * @brief Check results of submitted compile and link, report errors and store program in cache.
+     * @param wait Wait for driver to finish, otherwise return false if it is still compiling (GL_KHR_parallel_shader_compile only).
+     * @return True if shader is ready.
+    */
+    bool finish(bool wait);
+
+    /**
+     * @brief Whether file (canonical path) is one of program's sources or includes.
+    */
+    bool dependsOn(const std::string &file) const;
+
+    /**
+     * @brief Read sources again and submit a new program next to the current one, current program stays in use.
+     * @return False if sources couldn't be read or a reload is already running.
+    */
+    bool reload();
+
+    /**
+     * @brief Check submitted reload, on success swap new program in (carrying over uniform values and block bindings),
+     * on failure report errors and keep current program.
+     * @param wait Wait for driver to finish, otherwise return false if it is still compiling (GL_KHR_parallel_shader_compile only).
+     * @return True if no reload is running anymore.
+    */
+    bool finishReload(bool wait);
+
     // Utility uniform functions
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
@@ -77,6 +113,52 @@ public:
     void setMatrix4fv(const std::string &name, GLsizei count, GLboolean transpose, glm::mat4 matrix) const;
 
 private:
+    std::string paths[3];                   // Vertex, fragment, geometry (empty if none) source files
+    std::string defines;
+    std::vector<std::string> sourceFiles;   // Canonical paths of sources and their includes
+
+    bool pending;                   // Submitted, results not checked yet
+    GLuint stageShaders[3];         // Vertex, fragment, geometry (0 if none) shader until finished
+    uint64_t cacheKey;
+
+    // Program being rebuilt by reload()
+    bool reloading;
+    bool reloadFromCache;
+    GLuint reloadID;
+    GLuint reloadStages[3];
+    uint64_t reloadKey;
+
+    /**
+     * @brief Read and expand sources of all stages.
+     * @param codes Source of every stage, empty for missing geometry stage.
+     * @param files Canonical paths of all files read.
+    */
+    bool readSources(std::string* codes, std::vector<std::string> &files) const;
+
+    /**
+     * @brief Create program from cache or submit compile and link of sources without querying results.
+     * @param key Cache key of sources.
+     * @param stages Submitted shaders, all 0 when loaded from cache.
+     * @param fromCache Whether program was loaded from cache (and is linked already).
+    */
+    GLuint submitProgram(const std::string* codes, uint64_t &key, GLuint* stages, bool &fromCache);
+
+    /**
+     * @brief Whether driver finished compiling program, always true without GL_KHR_parallel_shader_compile.
+    */
+    bool isCompleted(GLuint program) const;
+
+    /**
+     * @brief Report compile and link errors, delete stage shaders and store linked program in cache.
+     * @return True if program linked.
+    */
+    bool checkProgram(GLuint program, GLuint* stages, uint64_t key);
+
+    /**
+     * @brief Copy uniform values (outside of blocks) and uniform block bindings between programs with matching names.
+    */
+    static void copyProgramState(GLuint source, GLuint destination);
+
     /**
      * @brief Add shader to shader program.
      * @param program Shader program to add shader to.
@@ -0,0 +1,62 @@
+#include "shaderCompiler.h"
+#include "shader.h"
+
+#include <algorithm>
+
+std::vector<Shader*>& ShaderCompiler::getPending()
+{
+    static std::vector<Shader*> pending;
+    return pending;
+}
+
+bool& ShaderCompiler::getBatching()
+{
+    static bool batching = false;
+    return batching;
+}
+
+void ShaderCompiler::begin()
+{
+    // Default thread count is up to driver, 0xFFFFFFFF asks for all it can use
+    if(GLEW_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+
+    getBatching() = true;
+}
+
+unsigned int ShaderCompiler::poll()
+{
+    // Without the extension there is no way to ask without waiting, everything is finished in end()
+    std::vector<Shader*> &pending = getPending();
+    if(!GLEW_KHR_parallel_shader_compile)
+        return pending.size();
+
+    pending.erase(std::remove_if(pending.begin(), pending.end(), [](Shader* shader) { return shader->finish(false); }), pending.end());
+    return pending.size();
+}
+
+void ShaderCompiler::end()
+{
+    getBatching() = false;
+
+    // Without the extension finish() can't tell if driver is done, it simply waits for every program in submission order
+    for(Shader* shader : getPending())
+        shader->finish(true);
+    getPending().clear();
+}
+
+bool ShaderCompiler::isBatching()
+{
+    return getBatching();
+}
+
+void ShaderCompiler::add(Shader* shader)
+{
+    getPending().push_back(shader);
+}
+
+void ShaderCompiler::remove(Shader* shader)
+{
+    std::vector<Shader*> &pending = getPending();
+    pending.erase(std::remove(pending.begin(), pending.end(), shader), pending.end());
+}
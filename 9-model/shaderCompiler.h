@@ -0,0 +1,53 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+class Shader;
+
+/**
+ * @brief Class ShaderCompiler batches shader compilation at startup.
+ * Between begin() and end() every new Shader only submits its compile and link, nothing is queried, so drivers can compile
+ * all programs in parallel (with GL_KHR_parallel_shader_compile on their own threads, otherwise at least without a round trip
+ * per shader). poll() finishes programs the driver already completed, end() waits for the rest.
+ *
+ * Work that doesn't need the shaders (loading models) can run between begin() and end() while the driver compiles.
+*/
+class ShaderCompiler
+{
+private:
+    static std::vector<Shader*>& getPending();
+    static bool& getBatching();
+
+public:
+    /**
+     * @brief Start batching, lets driver use as many compiler threads as it has.
+    */
+    static void begin();
+
+    /**
+     * @brief Finish every program driver has completed, never waits.
+     * @return Number of programs still compiling.
+    */
+    static unsigned int poll();
+
+    /**
+     * @brief Stop batching and finish all programs, waiting for driver.
+    */
+    static void end();
+
+    static bool isBatching();
+
+    /**
+     * @brief Remember submitted shader until finished, called by Shader.
+    */
+    static void add(Shader* shader);
+
+    /**
+     * @brief Forget shader, called by Shader when destroyed before finishing.
+    */
+    static void remove(Shader* shader);
+};
@@ -0,0 +1,115 @@
+#include "shaderPreprocessor.h"
+#include "assetFileSystem.h"
+
+#include <algorithm>
+#include <sstream>
+#include <filesystem>
+
+// Strip leading whitespace and whitespace between '#' and directive name, "  #  include" is valid GLSL
+static std::string directiveOf(const std::string &line)
+{
+    size_t start = line.find_first_not_of(" \t");
+    if(start == std::string::npos || line[start] != '#')
+        return "";
+
+    size_t name = line.find_first_not_of(" \t", start + 1);
+    if(name == std::string::npos)
+        return "";
+
+    return line.substr(name);
+}
+
+std::string ShaderPreprocessor::canonical(const std::string &path)
+{
+    std::error_code error;
+    std::string canonicalPath = std::filesystem::weakly_canonical(path, error).string();
+    return error ? path : canonicalPath;
+}
+
+bool ShaderPreprocessor::expand(const std::string &path, std::vector<std::string> &includeStack, std::set<std::string> &onceFiles, std::string &output, std::vector<std::string>* files)
+{
+    std::string canonicalPath = canonical(path);
+
+    if(onceFiles.count(canonicalPath) != 0)
+        return true;
+    if(std::find(includeStack.begin(), includeStack.end(), canonicalPath) != includeStack.end())
+    {
+        std::cerr << "ERROR::ShaderPreprocessor::include cycle through " << path << std::endl;
+        return false;
+    }
+
+    // Missing files are listed too, so a watcher notices when they appear
+    if(files != nullptr && std::find(files->begin(), files->end(), canonicalPath) == files->end())
+        files->push_back(canonicalPath);
+
+    std::string text;
+    if(!AssetFileSystem::readText(path, text))
+    {
+        std::cerr << "ERROR::ShaderPreprocessor::failed to open " << path << std::endl;
+        return false;
+    }
+
+    includeStack.push_back(canonicalPath);
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+
+    std::istringstream file(text);
+    std::string line;
+    bool success = true;
+    while(success && std::getline(file, line))
+    {
+        std::string directive = directiveOf(line);
+
+        if(directive.compare(0, 7, "include") == 0)
+        {
+            size_t open = directive.find('"');
+            size_t close = open == std::string::npos ? std::string::npos : directive.find('"', open + 1);
+            if(close == std::string::npos)
+            {
+                std::cerr << "ERROR::ShaderPreprocessor::malformed include in " << path << ": " << line << std::endl;
+                success = false;
+                break;
+            }
+
+            success = expand((directory / directive.substr(open + 1, close - open - 1)).string(), includeStack, onceFiles, output, files);
+            continue;
+        }
+
+        if(directive.compare(0, 6, "pragma") == 0 && directive.find("once") != std::string::npos)
+        {
+            onceFiles.insert(canonicalPath);
+            continue;
+        }
+
+        output += line;
+        output += '\n';
+    }
+
+    includeStack.pop_back();
+    return success;
+}
+
+bool ShaderPreprocessor::load(const std::string &path, const std::string &defines, std::string &source, std::vector<std::string>* files)
+{
+    std::vector<std::string> includeStack;
+    std::set<std::string> onceFiles;
+    std::string expanded;
+    if(!expand(path, includeStack, onceFiles, expanded, files))
+        return false;
+
+    // #version has to stay first, defines go right after it
+    size_t insertAt = 0;
+    size_t version = expanded.find("#version");
+    if(version != std::string::npos)
+    {
+        size_t lineEnd = expanded.find('\n', version);
+        insertAt = lineEnd == std::string::npos ? expanded.size() : lineEnd + 1;
+    }
+
+    source = expanded.substr(0, insertAt) + defines + expanded.substr(insertAt);
+    return true;
+}
+
+std::string ShaderPreprocessor::define(const std::string &name, const std::string &value)
+{
+    return "#define " + name + (value.empty() ? "" : " " + value) + "\n";
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+
+/**
+ * @brief Class ShaderPreprocessor expands GLSL files before they are compiled:
+ * - #include "file" is replaced by file's contents, path is relative to including file. Includes may nest, cycles are errors.
+ * - Files with #pragma once are only included once per program, #ifndef guards also work (GLSL handles those itself).
+ * - Injected defines are inserted right after #version, so every stage and include sees them.
+ *
+ * Injected defines let C++ own constants shared with GLSL and let ShaderVariants specialize one source per feature set.
+*/
+class ShaderPreprocessor
+{
+private:
+    /**
+     * @brief Append expanded file to output.
+     * @param path Path of file to expand.
+     * @param includeStack Files currently being expanded, to detect cycles.
+     * @param onceFiles Files with #pragma once that were already included.
+     * @param files Canonical path of every file read is appended, if not nullptr.
+    */
+    static bool expand(const std::string &path, std::vector<std::string> &includeStack, std::set<std::string> &onceFiles, std::string &output, std::vector<std::string>* files);
+
+public:
+    /**
+     * @brief Read shader file and expand includes and defines.
+     * @param path Path to shader file.
+     * @param defines Lines to insert after #version (see define()).
+     * @param source Expanded source.
+     * @param files Canonical path of file and of every include is appended, if not nullptr (used to watch sources).
+     * @return False if file or any include couldn't be read.
+    */
+    static bool load(const std::string &path, const std::string &defines, std::string &source, std::vector<std::string>* files = nullptr);
+
+    /**
+     * @brief Canonical form of path, the same file always gives the same string.
+    */
+    static std::string canonical(const std::string &path);
+
+    /**
+     * @brief Build a define line for load().
+     * @param name Name of macro.
+     * @param value Value of macro, empty for a flag.
+    */
+    static std::string define(const std::string &name, const std::string &value = "");
+};
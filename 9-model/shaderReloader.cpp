@@ -0,0 +1,157 @@
+#include "shaderReloader.h"
+#include "shader.h"
+#include "shaderPreprocessor.h"
+#include "cpuProfiler.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+// Watcher wakes up this often to notice it should stop
+constexpr int WATCH_POLL_MILLISECONDS = 100;
+
+std::vector<Shader*>& ShaderReloader::getShaders()
+{
+    static std::vector<Shader*> shaders;
+    return shaders;
+}
+
+void ShaderReloader::track(Shader* shader)
+{
+    getShaders().push_back(shader);
+}
+
+void ShaderReloader::untrack(Shader* shader)
+{
+    std::vector<Shader*> &shaders = getShaders();
+    shaders.erase(std::remove(shaders.begin(), shaders.end(), shader), shaders.end());
+}
+
+ShaderReloader::ShaderReloader(const std::vector<std::string> &directories)
+{
+    inotifyDescriptor = -1;
+    running = false;
+
+#ifdef __linux__
+    inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(inotifyDescriptor < 0)
+    {
+        std::cerr << "ERROR::ShaderReloader::inotify_init1 failed, shaders won't be reloaded" << std::endl;
+        return;
+    }
+
+    // Editors either write in place or write a temporary file and rename it over the original
+    for(const std::string &directory : directories)
+    {
+        int watch = inotify_add_watch(inotifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if(watch < 0)
+            std::cerr << "ERROR::ShaderReloader::failed to watch " << directory << std::endl;
+        else
+            watchedDirectories[watch] = directory;
+    }
+
+    running = true;
+    watcher = std::thread(&ShaderReloader::watch, this);
+    std::cout << "Shader hot reload: watching " << watchedDirectories.size() << " directories" << std::endl;
+#else
+    std::cerr << "ERROR::ShaderReloader::hot reload needs inotify (Linux), shaders won't be reloaded" << std::endl;
+#endif
+}
+
+ShaderReloader::~ShaderReloader()
+{
+    running = false;
+    if(watcher.joinable())
+        watcher.join();
+
+#ifdef __linux__
+    if(inotifyDescriptor >= 0)
+        close(inotifyDescriptor);
+#endif
+
+    // Rebuilds still running are finished, so no shader is left half reloaded
+    for(Shader* shader : reloading)
+    {
+        std::vector<Shader*> &shaders = getShaders();
+        if(std::find(shaders.begin(), shaders.end(), shader) != shaders.end())
+            shader->finishReload(true);
+    }
+}
+
+void ShaderReloader::watch()
+{
+    CpuProfiler::setThreadName("Shader watcher");
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    pollfd descriptor = { inotifyDescriptor, POLLIN, 0 };
+
+    while(running)
+    {
+        if(poll(&descriptor, 1, WATCH_POLL_MILLISECONDS) <= 0)
+            continue;
+
+        ssize_t length;
+        while((length = read(inotifyDescriptor, buffer, sizeof(buffer))) > 0)
+        {
+            std::vector<std::string> files;
+            for(char* pointer = buffer; pointer < buffer + length; )
+            {
+                inotify_event* event = reinterpret_cast<inotify_event*>(pointer);
+                pointer += sizeof(inotify_event) + event->len;
+
+                auto directory = watchedDirectories.find(event->wd);
+                if(event->len == 0 || directory == watchedDirectories.end())
+                    continue;
+                files.push_back(ShaderPreprocessor::canonical(directory->second + "/" + event->name));
+            }
+
+            std::lock_guard<std::mutex> lock(changedMutex);
+            changedFiles.insert(files.begin(), files.end());
+        }
+    }
+#endif
+}
+
+void ShaderReloader::update()
+{
+    std::set<std::string> changed;
+    {
+        std::lock_guard<std::mutex> lock(changedMutex);
+        changed.swap(changedFiles);
+    }
+
+    std::vector<Shader*> &shaders = getShaders();
+    std::set<std::string> deferred;
+    for(Shader* shader : shaders)
+    {
+        for(const std::string &file : changed)
+        {
+            if(!shader->dependsOn(file))
+                continue;
+
+            // Changed again while rebuilding, rebuild once more after current one finishes
+            if(std::find(reloading.begin(), reloading.end(), shader) != reloading.end())
+                deferred.insert(file);
+            else if(shader->reload())
+                reloading.push_back(shader);
+            break;
+        }
+    }
+    if(!deferred.empty())
+    {
+        std::lock_guard<std::mutex> lock(changedMutex);
+        changedFiles.insert(deferred.begin(), deferred.end());
+    }
+
+    // Shaders destroyed since their rebuild was submitted are dropped, finished rebuilds are swapped in
+    reloading.erase(std::remove_if(reloading.begin(), reloading.end(), [&shaders](Shader* shader)
+    {
+        if(std::find(shaders.begin(), shaders.end(), shader) == shaders.end())
+            return true;
+        return shader->finishReload(false);
+    }), reloading.end());
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+class Shader;
+
+/**
+ * @brief Class ShaderReloader is a development tool that rebuilds shaders when their source files change on disk.
+ *
+ * A background thread watches shader directories with inotify and collects changed files. update(), called once per frame on
+ * the GL thread, submits a rebuild of every live Shader using a changed file (its sources or any include) and checks
+ * submitted rebuilds without waiting (GL_KHR_parallel_shader_compile), so frames keep rendering with the old program.
+ * A finished rebuild replaces the program between frames, a failed one only prints errors and the old program stays.
+ *
+ * Every Shader registers itself on construction, so programs created later (shader variants) are covered too.
+*/
+class ShaderReloader
+{
+private:
+    int inotifyDescriptor;
+    std::map<int, std::string> watchedDirectories;     // inotify watch descriptor to directory
+    std::thread watcher;
+    std::atomic<bool> running;
+
+    std::mutex changedMutex;
+    std::set<std::string> changedFiles;                 // Canonical paths, filled by watcher thread
+
+    std::vector<Shader*> reloading;                     // Shaders with a submitted rebuild
+
+    static std::vector<Shader*>& getShaders();
+
+    /**
+     * @brief Watcher thread, reads inotify events until running is cleared.
+    */
+    void watch();
+
+public:
+    /**
+     * @brief Start watching directories.
+     * @param directories Shader directories, not recursive.
+    */
+    ShaderReloader(const std::vector<std::string> &directories);
+    ~ShaderReloader();
+
+    /**
+     * @brief Submit rebuilds of shaders using changed files and swap in finished ones, call once per frame on GL thread.
+    */
+    void update();
+
+    /**
+     * @brief Register live shader, called by Shader.
+    */
+    static void track(Shader* shader);
+
+    /**
+     * @brief Unregister shader, called by Shader when destroyed.
+    */
+    static void untrack(Shader* shader);
+};
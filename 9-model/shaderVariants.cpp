@@ -0,0 +1,62 @@
+#include "shaderVariants.h"
+
+ShaderVariants::ShaderVariants(const std::string &vertexPath, const std::string &fragmentPath, const std::string &geometryPath, const std::vector<ShaderFeature> &features, const std::string &defines)
+{
+    this->vertexPath = vertexPath;
+    this->fragmentPath = fragmentPath;
+    this->geometryPath = geometryPath;
+    this->features = features;
+    this->defines = defines;
+
+    unsigned int totalBits = 0;
+    for(const ShaderFeature &feature : features)
+        totalBits += feature.bits;
+    if(totalBits > 32)
+        std::cerr << "ERROR::ShaderVariants::features need " << totalBits << " bits, only 32 fit in a mask" << std::endl;
+}
+
+std::string ShaderVariants::makeDefines(unsigned int featureMask) const
+{
+    std::string result = defines;
+    unsigned int shift = 0;
+    for(const ShaderFeature &feature : features)
+    {
+        unsigned int value = (featureMask >> shift) & ((1ull << feature.bits) - 1);
+        shift += feature.bits;
+
+        if(feature.bits == 1)
+        {
+            if(value != 0)
+                result += ShaderPreprocessor::define(feature.name);
+        }
+        else
+            result += ShaderPreprocessor::define(feature.name, std::to_string(value));
+    }
+
+    return result;
+}
+
+unsigned int ShaderVariants::getShift(const std::string &name) const
+{
+    unsigned int shift = 0;
+    for(const ShaderFeature &feature : features)
+    {
+        if(feature.name == name)
+            return shift;
+        shift += feature.bits;
+    }
+
+    std::cerr << "ERROR::ShaderVariants::unknown feature " << name << std::endl;
+    return 0;
+}
+
+Shader& ShaderVariants::get(unsigned int featureMask)
+{
+    auto found = variants.find(featureMask);
+    if(found != variants.end())
+        return *found->second;
+
+    std::unique_ptr<Shader> &shader = variants[featureMask];
+    shader.reset(new Shader(vertexPath.c_str(), fragmentPath.c_str(), geometryPath.empty() ? nullptr : geometryPath.c_str(), makeDefines(featureMask)));
+    return *shader;
+}
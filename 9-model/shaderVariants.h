@@ -0,0 +1,62 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+#include "shader.h"
+#include "shaderPreprocessor.h"
+
+/**
+ * @brief Struct ShaderFeature is one field of a variant's feature mask.
+ * One bit fields are flags (macro defined or not), wider fields define macro as the field's value (light count, etc.).
+*/
+struct ShaderFeature
+{
+    std::string name;       // Macro name
+    unsigned int bits;      // Width of field in mask
+};
+
+/**
+ * @brief Class ShaderVariants builds specialized programs of one set of shader files, one per feature mask, on first use.
+ * Fields of the mask are packed from lowest bit in feature order. Every variant gets the shared defines plus its feature macros,
+ * so disabled features are removed by the GLSL preprocessor instead of being skipped with uniforms at run time.
+*/
+class ShaderVariants
+{
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::string geometryPath;           // Empty for none
+    std::string defines;                // Defines shared by all variants
+    std::vector<ShaderFeature> features;
+
+    std::unordered_map<unsigned int, std::unique_ptr<Shader>> variants;
+
+public:
+    /**
+     * @brief Constructor, doesn't compile anything yet.
+     * @param features Fields of feature mask, lowest bits first.
+     * @param defines Defines shared by all variants.
+    */
+    ShaderVariants(const std::string &vertexPath, const std::string &fragmentPath, const std::string &geometryPath, const std::vector<ShaderFeature> &features, const std::string &defines = "");
+
+    /**
+     * @brief Get variant of feature mask, compiling it on first request.
+    */
+    Shader& get(unsigned int featureMask);
+
+    /**
+     * @brief Defines of variant: shared defines followed by one macro per enabled flag or wide field.
+    */
+    std::string makeDefines(unsigned int featureMask) const;
+
+    /**
+     * @brief Position of a feature's field in mask, use (value << getShift(name)) to build masks.
+    */
+    unsigned int getShift(const std::string &name) const;
+
+    size_t getVariantCount() const { return variants.size(); };
+};
@@ -1,10 +1,12 @@
 #version 330 core
 
-#define NUM_LIGHT_POINTS 5
+// LIGHT_TEXELS, LIGHT_SPOT, CLUSTER_X/Y/Z, MAX_SHADOW_CASCADES and CUBE_FACES are injected from C++ constants,
+// USE_SHADOWS is a variant feature (see main.cpp)
 
 in vec3 normal;
 in vec3 fragPosition;
 in vec2 textureCoordinates;
+in float viewDepth;
 
 out vec4 fragColor;
 
@@ -57,16 +59,27 @@ struct SpotLight
 };
 
 uniform Material material;
-uniform SpotLight spotLight;
 uniform DirectionalLight directionalLight;
-uniform PointLight pointLights[NUM_LIGHT_POINTS];
+
+// Clustered lights, filled by ClusteredLighting every frame
+uniform samplerBuffer lightData;        // LIGHT_TEXELS texels per light
+uniform usamplerBuffer clusterGrid;     // (offset, count) into lightIndices per cluster
+uniform usamplerBuffer lightIndices;    // Light indices of all clusters
+uniform vec2 clusterTileSize;           // Size of a cluster tile in pixels
+uniform float clusterScale;             // slice = log(viewDepth) * clusterScale + clusterBias
+uniform float clusterBias;
+
+#ifdef USE_SHADOWS
+#include "shadows.glsl"
+#endif
 
 vec3 calculateAmbientLight(vec3 ambient, sampler2D diffuse);
 vec3 calculateDiffuseLight(vec3 lightDirection, vec3 normal, vec3 lightDiffuse, sampler2D materialDiffuse);
 vec3 calculateSpecularLight(vec3 lightDirection, vec3 normal, vec3 viewDirection, vec3 LightSpecular, float materialShininess, sampler2D materialSpecular);
-vec3 calculateDirectionLight(DirectionalLight directionalLight, vec3 normal, vec3 viewDirection);
-vec3 calculatePointLight(PointLight pointLight, vec3 normal, vec3 fragPosition, vec3 viewDirection);
-vec3 calculateSpotLight(SpotLight spotLight, vec3 normal, vec3 fragPosition, vec3 viewDirection);
+vec3 calculateDirectionLight(DirectionalLight directionalLight, vec3 normal, vec3 viewDirection, float shadow);
+vec3 calculatePointLight(PointLight pointLight, vec3 normal, vec3 fragPosition, vec3 viewDirection, float shadow);
+vec3 calculateSpotLight(SpotLight spotLight, vec3 normal, vec3 fragPosition, vec3 viewDirection, float shadow);
+vec3 calculateClusteredLight(int lightIndex, vec3 normal, vec3 fragPosition, vec3 viewDirection);
 
 void main()
 {
@@ -75,17 +88,72 @@ void main()
     vec3 viewDirection = normalize(viewPosition - fragPosition);
     vec3 norm = normalize(normal);
 
-    result += calculateDirectionLight(directionalLight, norm, viewDirection);
+#ifdef USE_SHADOWS
+    result += calculateDirectionLight(directionalLight, norm, viewDirection, calculateShadow(norm));
+#else
+    result += calculateDirectionLight(directionalLight, norm, viewDirection, 1.0);
+#endif
 
-    for(int i = 0; i < NUM_LIGHT_POINTS; i++)
-        result += calculatePointLight(pointLights[i], norm, fragPosition, viewDirection);
+    // Find cluster of this fragment and shade only lights assigned to it
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterTileSize), ivec2(0), ivec2(CLUSTER_X - 1, CLUSTER_Y - 1));
+    int slice = clamp(int(log(viewDepth) * clusterScale + clusterBias), 0, CLUSTER_Z - 1);
+    uvec2 cluster = texelFetch(clusterGrid, (slice * CLUSTER_Y + tile.y) * CLUSTER_X + tile.x).xy;
 
-    if(spotLight.cutOff > 0)
-        result += calculateSpotLight(spotLight, norm, fragPosition, viewDirection);
+    for(uint i = 0u; i < cluster.y; i++)
+    {
+        int lightIndex = int(texelFetch(lightIndices, int(cluster.x + i)).r);
+        result += calculateClusteredLight(lightIndex, norm, fragPosition, viewDirection);
+    }
 
     fragColor = vec4(result, 1.0);
 }
 
+vec3 calculateClusteredLight(int lightIndex, vec3 normal, vec3 fragPosition, vec3 viewDirection)
+{
+    int base = lightIndex * LIGHT_TEXELS;
+    vec4 positionRange = texelFetch(lightData, base);
+    vec4 ambientConstant = texelFetch(lightData, base + 1);
+    vec4 diffuseLinear = texelFetch(lightData, base + 2);
+    vec4 specularQuadratic = texelFetch(lightData, base + 3);
+    vec4 directionCutOff = texelFetch(lightData, base + 4);
+    vec4 outerCutOffType = texelFetch(lightData, base + 5);
+
+    float shadow = 1.0;
+#ifdef USE_SHADOWS
+    int shadowSlot = int(outerCutOffType.z);
+    if(shadowSlot >= 0)
+        shadow = calculatePointShadow(shadowSlot, positionRange.xyz, positionRange.w, normal);
+#endif
+
+    if(int(outerCutOffType.y) == LIGHT_SPOT)
+    {
+        SpotLight spotLight;
+        spotLight.position = positionRange.xyz;
+        spotLight.direction = directionCutOff.xyz;
+        spotLight.cutOff = directionCutOff.w;
+        spotLight.outerCutOff = outerCutOffType.x;
+        spotLight.ambient = ambientConstant.rgb;
+        spotLight.diffuse = diffuseLinear.rgb;
+        spotLight.specular = specularQuadratic.rgb;
+        spotLight.constant = ambientConstant.w;
+        spotLight.linear = diffuseLinear.w;
+        spotLight.quadratic = specularQuadratic.w;
+
+        return calculateSpotLight(spotLight, normal, fragPosition, viewDirection, shadow);
+    }
+
+    PointLight pointLight;
+    pointLight.position = positionRange.xyz;
+    pointLight.ambient = ambientConstant.rgb;
+    pointLight.diffuse = diffuseLinear.rgb;
+    pointLight.specular = specularQuadratic.rgb;
+    pointLight.constant = ambientConstant.w;
+    pointLight.linear = diffuseLinear.w;
+    pointLight.quadratic = specularQuadratic.w;
+
+    return calculatePointLight(pointLight, normal, fragPosition, viewDirection, shadow);
+}
+
 vec3 calculateAmbientLight(vec3 ambient, sampler2D diffuse)
 {
     return ambient * vec3(texture(diffuse, textureCoordinates));
@@ -109,7 +177,7 @@ vec3 calculateSpecularLight(vec3 lightDirection, vec3 normal, vec3 viewDirection
     return spec * LightSpecular * vec3(texture(materialSpecular, textureCoordinates));
 }
 
-vec3 calculateDirectionLight(DirectionalLight directionalLight, vec3 normal, vec3 viewDirection)
+vec3 calculateDirectionLight(DirectionalLight directionalLight, vec3 normal, vec3 viewDirection, float shadow)
 {
     vec3 ambientLight = calculateAmbientLight(directionalLight.ambient, material.diffuse);
 
@@ -117,10 +185,10 @@ vec3 calculateDirectionLight(DirectionalLight directionalLight, vec3 normal, vec
 
     vec3 specularLight = calculateSpecularLight(directionalLight.direction, normal, viewDirection, directionalLight.specular, material.shininess, material.specular);
 
-    return (ambientLight + diffuseLight + specularLight);
+    return (ambientLight + shadow * (diffuseLight + specularLight));
 }
 
-vec3 calculatePointLight(PointLight pointLight, vec3 normal, vec3 fragPosition, vec3 viewDirection)
+vec3 calculatePointLight(PointLight pointLight, vec3 normal, vec3 fragPosition, vec3 viewDirection, float shadow)
 {
     vec3 ambientLight = calculateAmbientLight(pointLight.ambient, material.diffuse);
     vec3 diffuseLight = calculateDiffuseLight(normalize(pointLight.position - fragPosition), normal, pointLight.diffuse, material.diffuse);
@@ -133,10 +201,10 @@ vec3 calculatePointLight(PointLight pointLight, vec3 normal, vec3 fragPosition,
     diffuseLight *= attenuation;
     specularLight *= attenuation;
 
-    return (ambientLight + diffuseLight + specularLight);
+    return (ambientLight + shadow * (diffuseLight + specularLight));
 }
 
-vec3 calculateSpotLight(SpotLight spotLight, vec3 normal, vec3 fragPosition, vec3 viewDirection)
+vec3 calculateSpotLight(SpotLight spotLight, vec3 normal, vec3 fragPosition, vec3 viewDirection, float shadow)
 {
     vec3 ambientLight = calculateAmbientLight(spotLight.ambient, material.diffuse);
     vec3 diffuseLight = calculateDiffuseLight(spotLight.direction, normal, spotLight.diffuse, material.diffuse);
@@ -158,5 +226,5 @@ vec3 calculateSpotLight(SpotLight spotLight, vec3 normal, vec3 fragPosition, vec
     diffuseLight *= attenuation;
     specularLight *= attenuation;
 
-    return (ambientLight + diffuseLight + specularLight);
+    return (ambientLight + shadow * (diffuseLight + specularLight));
 }
\ No newline at end of file
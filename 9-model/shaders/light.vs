@@ -7,6 +7,7 @@ layout (location = 2) in vec2 aTextureCoordinates;
 out vec3 fragPosition;
 out vec3 normal;
 out vec2 textureCoordinates;
+out float viewDepth;
 
 uniform mat4 model;
 uniform mat4 view;
@@ -21,5 +22,9 @@ void main()
 
     textureCoordinates = aTextureCoordinates;
     
-    gl_Position = projection * view * vec4(fragPosition, 1.0);
+    vec4 viewPosition = view * vec4(fragPosition, 1.0);
+    // Camera looks down -z, clustered lighting uses positive distance to pick depth slice
+    viewDepth = -viewPosition.z;
+
+    gl_Position = projection * viewPosition;
 }
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 330 core
+
+in vec3 worldPosition;
+
+uniform vec3 lightPosition;
+uniform float lightRange;
+
+// Linear distance is the same on every face, so lookups don't need to know face's projection
+void main()
+{
+    gl_FragDepth = length(worldPosition - lightPosition) / lightRange;
+}
@@ -0,0 +1,38 @@
+#version 330 core
+
+// CUBE_FACES is injected by PointShadowAtlas
+
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 18) out;
+
+uniform mat4 faceMatrices[CUBE_FACES];
+uniform int baseLayer;      // First layer of light's slot
+
+out vec3 worldPosition;
+
+void main()
+{
+    for(int face = 0; face < CUBE_FACES; face++)
+    {
+        vec4 clip[3];
+        for(int i = 0; i < 3; i++)
+            clip[i] = faceMatrices[face] * gl_in[i].gl_Position;
+
+        // Skip faces whose frustum the triangle is entirely outside of, most triangles touch one or two faces
+        vec3 x = vec3(clip[0].x, clip[1].x, clip[2].x);
+        vec3 y = vec3(clip[0].y, clip[1].y, clip[2].y);
+        vec3 z = vec3(clip[0].z, clip[1].z, clip[2].z);
+        vec3 w = vec3(clip[0].w, clip[1].w, clip[2].w);
+        if(all(greaterThan(x, w)) || all(lessThan(x, -w)) || all(greaterThan(y, w)) || all(lessThan(y, -w)) || all(greaterThan(z, w)) || all(lessThan(z, -w)))
+            continue;
+
+        for(int i = 0; i < 3; i++)
+        {
+            gl_Layer = baseLayer + face;
+            worldPosition = gl_in[i].gl_Position.xyz;
+            gl_Position = clip[i];
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
+}
@@ -0,0 +1,12 @@
+#version 330 core
+
+// Position-only stream, see Mesh::drawPositions()
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+
+// World position, geometry shader projects it into every face
+void main()
+{
+    gl_Position = model * vec4(aPos, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 330 core
+// Either extension allows writing gl_Layer here, PointShadowAtlas only uses this shader when one is available
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+
+// CUBE_FACES is injected by PointShadowAtlas
+
+// Position-only stream, see Mesh::drawPositions()
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 faceMatrices[CUBE_FACES];
+uniform int baseLayer;      // First layer of light's slot
+
+out vec3 worldPosition;
+
+// Drawn with CUBE_FACES instances, one per face
+void main()
+{
+    vec4 world = model * vec4(aPos, 1.0);
+    worldPosition = world.xyz;
+    gl_Layer = baseLayer + gl_InstanceID;
+    gl_Position = faceMatrices[gl_InstanceID] * world;
+}
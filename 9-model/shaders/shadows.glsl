@@ -0,0 +1,69 @@
+#pragma once
+
+// Shadow lookups of light.fs, uses its fragPosition and viewDepth inputs
+
+// Cascaded shadow map of directional light, filled by CascadedShadowMap
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 lightSpaceMatrices[MAX_SHADOW_CASCADES];
+uniform float cascadeSplits[MAX_SHADOW_CASCADES];       // View depth where every cascade ends
+uniform float cascadeTexelSizes[MAX_SHADOW_CASCADES];   // World size of a shadow texel
+uniform int cascadeCount;
+
+// Point light shadows, filled by PointShadowAtlas, lights store their slot in packed data (-1 for no shadow)
+uniform sampler2DArrayShadow pointShadowAtlas;          // CUBE_FACES layers per slot, distance / range
+uniform mat4 pointShadowFaces[CUBE_FACES];              // Light relative position to face clip space
+
+float calculateShadow(vec3 normal)
+{
+    // Pick first cascade that still covers this depth, nothing beyond last one is shadowed
+    int cascade = -1;
+    for(int i = 0; i < cascadeCount; i++)
+    {
+        if(viewDepth < cascadeSplits[i])
+        {
+            cascade = i;
+            break;
+        }
+    }
+    if(cascade < 0)
+        return 1.0;
+
+    // Offset along normal by about a texel, bigger texels of far cascades need bigger offset
+    vec3 position = fragPosition + normal * cascadeTexelSizes[cascade] * 1.5;
+    vec4 lightSpace = lightSpaceMatrices[cascade] * vec4(position, 1.0);
+    vec3 coordinates = lightSpace.xyz / lightSpace.w * 0.5 + 0.5;
+
+    // 3x3 taps, every tap is already a bilinear 2x2 comparison
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float shadow = 0.0;
+    for(int x = -1; x <= 1; x++)
+    {
+        for(int y = -1; y <= 1; y++)
+            shadow += texture(shadowMap, vec4(coordinates.xy + vec2(x, y) * texelSize, cascade, coordinates.z));
+    }
+
+    return shadow / 9.0;
+}
+
+float calculatePointShadow(int slot, vec3 lightPosition, float range, vec3 normal)
+{
+    // One texel of a 90 degree face at this distance, offset along normal against acne
+    float distance = length(fragPosition - lightPosition);
+    float texelSize = 2.0 * distance / float(textureSize(pointShadowAtlas, 0).x);
+    vec3 position = fragPosition + normal * texelSize * 1.5 - lightPosition;
+
+    // Face is picked by major axis, the same way cube maps do
+    vec3 absolute = abs(position);
+    int face;
+    if(absolute.x >= absolute.y && absolute.x >= absolute.z)
+        face = position.x > 0.0 ? 0 : 1;
+    else if(absolute.y >= absolute.z)
+        face = position.y > 0.0 ? 2 : 3;
+    else
+        face = position.z > 0.0 ? 4 : 5;
+
+    vec4 clip = pointShadowFaces[face] * vec4(position, 1.0);
+    vec2 coordinates = clip.xy / clip.w * 0.5 + 0.5;
+
+    return texture(pointShadowAtlas, vec4(coordinates, slot * CUBE_FACES + face, length(position) / range));
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief Class SpscQueue is a lock-free ring buffer for exactly one producer thread and one consumer thread.
+ *
+ * Producer only writes tail and consumer only writes head, each publishes with release and reads the other side with
+ * acquire, so an item is fully written before the consumer can see it. One slot stays empty to tell full from empty.
+*/
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+private:
+    std::array<T, Capacity> items;
+    // Separate cache lines, producer and consumer don't invalidate each other's index on every operation
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    /**
+     * @brief Add item, producer thread only.
+     * @return False if queue is full, item is untouched then.
+    */
+    bool push(T &&item)
+    {
+        size_t current = tail.load(std::memory_order_relaxed);
+        size_t next = (current + 1) % Capacity;
+        if(next == head.load(std::memory_order_acquire))
+            return false;
+
+        items[current] = std::move(item);
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take oldest item, consumer thread only.
+     * @return False if queue is empty.
+    */
+    bool pop(T &item)
+    {
+        size_t current = head.load(std::memory_order_relaxed);
+        if(current == tail.load(std::memory_order_acquire))
+            return false;
+
+        item = std::move(items[current]);
+        head.store((current + 1) % Capacity, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Whether queue looks empty, exact only on consumer thread.
+    */
+    bool isEmpty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,294 @@
+#include "textureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Closest distance used for density, meshes around the camera would otherwise ask for infinitely fine levels
+constexpr float STREAMING_MIN_DISTANCE = 0.01f;
+
+TextureStreamer::TextureStreamer()
+{
+    frame = 0;
+    enabled = true;
+    residentBytes = 0;
+    budget = 0;
+}
+
+GLenum TextureStreamer::formatOf(int components)
+{
+    switch(components)
+    {
+        case 1:
+            return GL_RED;
+        case 2:
+            return GL_RG;
+        case 3:
+            return GL_RGB;
+        default:
+            return GL_RGBA;
+    }
+}
+
+size_t TextureStreamer::levelSize(const MipChain &chain, int level)
+{
+    return chain.levels[level].size();
+}
+
+MipChain TextureStreamer::buildMipChain(const unsigned char* pixels, int width, int height, int components)
+{
+    MipChain chain;
+    chain.width = width;
+    chain.height = height;
+    chain.components = components;
+    chain.levels.emplace_back(pixels, pixels + (size_t)width * height * components);
+
+    // 2x2 box filter, last row or column is repeated for odd sizes
+    while(width > 1 || height > 1)
+    {
+        int nextWidth = std::max(1, width / 2);
+        int nextHeight = std::max(1, height / 2);
+        const std::vector<unsigned char> &source = chain.levels.back();
+        std::vector<unsigned char> level((size_t)nextWidth * nextHeight * components);
+
+        for(int y = 0; y < nextHeight; y++)
+        {
+            const unsigned char* row0 = &source[(size_t)std::min(2 * y, height - 1) * width * components];
+            const unsigned char* row1 = &source[(size_t)std::min(2 * y + 1, height - 1) * width * components];
+            for(int x = 0; x < nextWidth; x++)
+            {
+                int x0 = std::min(2 * x, width - 1) * components;
+                int x1 = std::min(2 * x + 1, width - 1) * components;
+                unsigned char* output = &level[((size_t)y * nextWidth + x) * components];
+                for(int c = 0; c < components; c++)
+                    output[c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2;
+            }
+        }
+
+        chain.levels.push_back(std::move(level));
+        width = nextWidth;
+        height = nextHeight;
+    }
+
+    return chain;
+}
+
+void TextureStreamer::add(GLuint texture, MipChain &&chain)
+{
+    StreamedTexture &streamed = textures[texture];
+    streamed.chain = std::move(chain);
+    streamed.format = formatOf(streamed.chain.components);
+
+    int levelCount = streamed.chain.levels.size();
+    streamed.tailLevel = levelCount - 1;
+    while(streamed.tailLevel > 0 && std::max(streamed.chain.width >> (streamed.tailLevel - 1), streamed.chain.height >> (streamed.tailLevel - 1)) <= STREAMING_TAIL_SIZE)
+        streamed.tailLevel--;
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Tail is uploaded coarsest first, each upload lowers BASE_LEVEL so texture stays complete
+    streamed.residentLevel = levelCount;
+    streamed.minLod = 0.0f;
+    for(int level = levelCount - 1; level >= streamed.tailLevel; level--)
+        uploadLevel(texture, streamed, level);
+    // Tail shows at once, there is nothing coarser to fade in from
+    streamed.minLod = 0.0f;
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, 0.0f);
+
+    streamed.uploadingLevel = -1;
+    streamed.neededLevel = streamed.tailLevel;
+    streamed.targetLevel = streamed.tailLevel;
+    streamed.lastNeeded = frame;
+    streamed.lastUsed = frame;
+}
+
+void TextureStreamer::remove(GLuint texture)
+{
+    // Textures that failed to load were never added, they are still deleted
+    uploader.cancel(texture);
+    glDeleteTextures(1, &texture);
+
+    auto found = textures.find(texture);
+    if(found == textures.end())
+        return;
+
+    for(unsigned int level = found->second.residentLevel; level < found->second.chain.levels.size(); level++)
+        residentBytes -= levelSize(found->second.chain, level);
+    if(found->second.uploadingLevel >= 0)
+        residentBytes -= levelSize(found->second.chain, found->second.uploadingLevel);
+    textures.erase(found);
+}
+
+void TextureStreamer::uploadLevel(GLuint texture, StreamedTexture &streamed, int level)
+{
+    GLint alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    // Rows of small RGB levels aren't 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, level, streamed.format, std::max(1, streamed.chain.width >> level), std::max(1, streamed.chain.height >> level),
+                 0, streamed.format, GL_UNSIGNED_BYTE, streamed.chain.levels[level].data());
+    // MIN_LOD clamps lambda, which counts from BASE_LEVEL: raising it by the levels BASE_LEVEL drops keeps the old
+    // detail, update() fades it to 0
+    streamed.minLod += streamed.residentLevel - level;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, streamed.minLod);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    streamed.residentLevel = level;
+    residentBytes += levelSize(streamed.chain, level);
+}
+
+void TextureStreamer::queueLevel(GLuint texture, StreamedTexture &streamed, int level)
+{
+    // Counted from now on, so the budget holds while the level trickles in
+    streamed.uploadingLevel = level;
+    residentBytes += levelSize(streamed.chain, level);
+    uploader.queue(texture, level, std::max(1, streamed.chain.width >> level), std::max(1, streamed.chain.height >> level),
+                   streamed.format, streamed.chain.levels[level].data(), [this, texture, level]() { finishLevel(texture, level); });
+}
+
+void TextureStreamer::finishLevel(GLuint texture, int level)
+{
+    StreamedTexture &streamed = textures[texture];
+    // MIN_LOD is relative to BASE_LEVEL, keep the old detail and let update() fade it in
+    streamed.minLod += streamed.residentLevel - level;
+    streamed.residentLevel = level;
+    streamed.uploadingLevel = -1;
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, streamed.minLod);
+}
+
+void TextureStreamer::evictLevel(GLuint texture, StreamedTexture &streamed)
+{
+    int level = streamed.residentLevel++;
+    residentBytes -= levelSize(streamed.chain, level);
+    // BASE_LEVEL moves up, the same detail is one level less of MIN_LOD
+    streamed.minLod = std::max(0.0f, streamed.minLod - 1.0f);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, streamed.residentLevel);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, streamed.minLod);
+    // Levels below BASE_LEVEL don't count for completeness, an empty one releases its memory
+    glTexImage2D(GL_TEXTURE_2D, level, streamed.format, 0, 0, 0, streamed.format, GL_UNSIGNED_BYTE, nullptr);
+}
+
+void TextureStreamer::request(const Mesh &mesh, const glm::mat4 &model, const glm::vec3 &cameraPosition, float pixelsPerUnit)
+{
+    if(mesh.worldPerUv <= 0.0f)
+        return;
+
+    float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    glm::vec3 center = glm::vec3(model * glm::vec4(mesh.boundsCenter, 1.0f));
+    float distance = std::max(glm::length(center - cameraPosition) - mesh.boundsRadius * scale, STREAMING_MIN_DISTANCE);
+
+    // Pixels one UV unit covers on the closest point of the mesh
+    float pixelsPerUv = mesh.worldPerUv * scale * pixelsPerUnit / distance;
+
+    for(const Texture &texture : mesh.textures)
+    {
+        auto found = textures.find(texture.id);
+        if(found == textures.end())
+            continue;
+
+        StreamedTexture &streamed = found->second;
+        streamed.lastUsed = frame;
+        float texelsPerPixel = std::max(streamed.chain.width, streamed.chain.height) / pixelsPerUv;
+        int level = texelsPerPixel <= 1.0f ? 0 : (int)std::floor(std::log2(texelsPerPixel));
+        streamed.neededLevel = std::min(streamed.neededLevel, std::min(level, streamed.tailLevel));
+    }
+}
+
+void TextureStreamer::update(float deltaTime)
+{
+    // Textures furthest from the level they need come first
+    std::vector<std::pair<int, GLuint>> uploads;
+    for(auto &entry : textures)
+    {
+        StreamedTexture &streamed = entry.second;
+        int target = enabled ? streamed.neededLevel : 0;
+        streamed.targetLevel = target;
+        streamed.neededLevel = streamed.tailLevel;
+
+        // A texture with a level in flight waits for it before streaming further in or out
+        if(target <= streamed.residentLevel)
+            streamed.lastNeeded = frame;
+        bool uploading = streamed.uploadingLevel >= 0;
+        if(!uploading && target < streamed.residentLevel)
+            uploads.emplace_back(streamed.residentLevel - target, entry.first);
+        else if(!uploading && frame - streamed.lastNeeded >= STREAMING_EVICT_FRAMES)
+        {
+            // One level at a time, each one has to stay unneeded for the whole period
+            evictLevel(entry.first, streamed);
+            streamed.lastNeeded = frame;
+        }
+
+        if(streamed.minLod > 0.0f)
+        {
+            streamed.minLod = std::max(0.0f, streamed.minLod - STREAMING_FADE_SPEED * deltaTime);
+            glBindTexture(GL_TEXTURE_2D, entry.first);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, streamed.minLod);
+        }
+    }
+
+    std::sort(uploads.begin(), uploads.end(), [](const std::pair<int, GLuint> &a, const std::pair<int, GLuint> &b) { return a.first > b.first; });
+    for(const std::pair<int, GLuint> &upload : uploads)
+    {
+        StreamedTexture &streamed = textures[upload.second];
+        int level = streamed.residentLevel - 1;
+        // Budget is full of levels visible textures need
+        if(!makeRoom(levelSize(streamed.chain, level), upload.second))
+            continue;
+
+        queueLevel(upload.second, streamed, level);
+    }
+
+    // Budget may have been lowered
+    makeRoom(0, 0);
+
+    uploader.update(STREAMING_UPLOAD_BUDGET);
+
+    frame++;
+}
+
+GLuint TextureStreamer::findVictim(GLuint keep) const
+{
+    GLuint victim = 0;
+    const StreamedTexture* victimTexture = nullptr;
+    for(const auto &entry : textures)
+    {
+        const StreamedTexture &streamed = entry.second;
+        bool drawn = streamed.lastUsed == frame;
+        if(entry.first == keep || streamed.uploadingLevel >= 0 || streamed.residentLevel >= streamed.tailLevel ||
+           (drawn && streamed.residentLevel >= streamed.targetLevel))
+            continue;
+
+        // Least recently drawn first, then the one with most levels it doesn't need
+        if(victimTexture == nullptr || streamed.lastUsed < victimTexture->lastUsed ||
+           (streamed.lastUsed == victimTexture->lastUsed && streamed.targetLevel - streamed.residentLevel > victimTexture->targetLevel - victimTexture->residentLevel))
+        {
+            victim = entry.first;
+            victimTexture = &streamed;
+        }
+    }
+    return victim;
+}
+
+bool TextureStreamer::makeRoom(size_t size, GLuint keep)
+{
+    while(budget != 0 && residentBytes + size > budget)
+    {
+        GLuint victim = findVictim(keep);
+        if(victim == 0)
+            return false;
+        evictLevel(victim, textures[victim]);
+    }
+    return true;
+}
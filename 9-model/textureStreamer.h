@@ -0,0 +1,151 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include <glm/glm.hpp>
+
+#include "mesh.h"
+#include "textureUploader.h"
+
+constexpr int STREAMING_TAIL_SIZE = 64;                         // Levels this size and smaller are uploaded when texture is added
+constexpr size_t STREAMING_UPLOAD_BUDGET = 8 * 1024 * 1024;     // Bytes uploaded per frame (at least one row always goes)
+constexpr unsigned int STREAMING_EVICT_FRAMES = 120;            // Frames a level must be unneeded before it is dropped
+constexpr float STREAMING_FADE_SPEED = 4.0f;                    // Levels per second MIN_LOD moves towards a new level
+
+/**
+ * @brief Struct MipChain is a decoded image with all its mip levels, built on a worker thread.
+*/
+struct MipChain
+{
+    int width = 0, height = 0, components = 0;
+    std::vector<std::vector<unsigned char>> levels;     // Level 0 is full resolution, last level is 1x1
+};
+
+/**
+ * @brief Class TextureStreamer keeps only the mip levels of a texture that are actually visible on the GPU.
+ *
+ * A texture starts with only its mip tail (levels up to STREAMING_TAIL_SIZE). Every frame, visible meshes report the finest
+ * level their textures need, computed from screen-space UV density: texels per UV unit against pixels a UV unit covers at
+ * the mesh's distance. update() then queues finer levels, furthest from needed level first, and drops levels nobody needed
+ * for STREAMING_EVICT_FRAMES frames. Queued levels go through TextureUploader's staging buffers within a per-frame byte
+ * budget, a level becomes BASE_LEVEL once all its rows were issued. Mip tails are small and are uploaded directly.
+ *
+ * Textures use mutable storage: only levels from GL_TEXTURE_BASE_LEVEL up are defined, dropped levels are redefined
+ * empty, so the driver doesn't keep memory for them. GL_TEXTURE_MIN_LOD fades towards a new level instead of popping.
+ * Full mip chains stay in system memory, so streaming a level in never touches the disk.
+ *
+ * GPU bytes of every level are accounted. With a budget set, a level is only streamed in if it fits, making room by
+ * downgrading least recently drawn textures one level at a time (textures drawn this frame only lose levels finer than
+ * they need). Downgraded textures stream back in when they are drawn again. Mip tails are never evicted.
+*/
+class TextureStreamer
+{
+private:
+    struct StreamedTexture
+    {
+        MipChain chain;
+        GLenum format;
+        int residentLevel;          // Finest level on GPU (BASE_LEVEL)
+        int uploadingLevel;         // Level queued in uploader, -1 if none
+        int tailLevel;              // Coarsest level streaming ever drops to
+        int neededLevel;            // Finest level requested this frame
+        int targetLevel;            // Level texture should have this frame
+        float minLod;               // Current MIN_LOD, relative to residentLevel like GL's, fades towards 0
+        unsigned int lastNeeded;    // Frame residentLevel was last needed
+        unsigned int lastUsed;      // Frame texture was last drawn, least recently used is downgraded first
+    };
+
+    std::unordered_map<GLuint, StreamedTexture> textures;
+    TextureUploader uploader;
+    unsigned int frame;
+    bool enabled;
+    size_t residentBytes;
+    size_t budget;                  // 0 for no budget
+
+    static GLenum formatOf(int components);
+    static size_t levelSize(const MipChain &chain, int level);
+
+    /**
+     * @brief Upload level right away and make it texture's finest level (mip tail).
+    */
+    void uploadLevel(GLuint texture, StreamedTexture &streamed, int level);
+
+    /**
+     * @brief Queue level in uploader, it becomes texture's finest level in finishLevel().
+    */
+    void queueLevel(GLuint texture, StreamedTexture &streamed, int level);
+    void finishLevel(GLuint texture, int level);
+
+    /**
+     * @brief Drop texture's finest level.
+    */
+    void evictLevel(GLuint texture, StreamedTexture &streamed);
+
+    /**
+     * @brief Texture that should lose its finest level first, 0 if none can.
+     * @param keep Texture that is never chosen (the one room is made for).
+    */
+    GLuint findVictim(GLuint keep) const;
+
+    /**
+     * @brief Downgrade textures until size more bytes fit in budget.
+     * @return False if budget can't be met without taking levels visible textures need.
+    */
+    bool makeRoom(size_t size, GLuint keep);
+
+public:
+    /**
+     * @brief Build mip chain of an 8-bit image with a box filter, safe to call on any thread.
+    */
+    static MipChain buildMipChain(const unsigned char* pixels, int width, int height, int components);
+
+    /**
+     * @brief Create staging buffers, needs a GL context.
+    */
+    TextureStreamer();
+
+    /**
+     * @brief Take over texture, its mip tail is uploaded now.
+     * @param texture Texture name from glGenTextures, no storage defined yet.
+    */
+    void add(GLuint texture, MipChain &&chain);
+
+    /**
+     * @brief Forget texture and delete it (also if it was never added).
+    */
+    void remove(GLuint texture);
+
+    /**
+     * @brief Report that mesh is drawn this frame.
+     * @param model Model matrix of mesh.
+     * @param pixelsPerUnit Pixels one world unit covers at distance 1 (screen height / (2 * tan(fovY / 2))).
+    */
+    void request(const Mesh &mesh, const glm::mat4 &model, const glm::vec3 &cameraPosition, float pixelsPerUnit);
+
+    /**
+     * @brief Stream levels in and out for requests of this frame, call once per frame after all requests.
+     * @param deltaTime Seconds since last frame, for MIN_LOD fading.
+    */
+    void update(float deltaTime);
+
+    /**
+     * @brief When disabled, every texture streams in to full resolution (for comparison).
+    */
+    void setEnabled(bool enabled) { this->enabled = enabled; };
+
+    /**
+     * @brief Limit GPU bytes of streamed textures, 0 for no limit. Takes effect on next update().
+    */
+    void setBudget(size_t budget) { this->budget = budget; };
+    size_t getBudget() const { return budget; };
+
+    /**
+     * @brief Bytes of mip levels currently on GPU.
+    */
+    size_t getResidentBytes() const { return residentBytes; };
+};
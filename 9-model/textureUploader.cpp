@@ -0,0 +1,107 @@
+#include "textureUploader.h"
+
+#include <algorithm>
+#include <cstring>
+
+TextureUploader::TextureUploader()
+{
+    glGenBuffers(UPLOAD_BUFFER_COUNT, buffers);
+    for(unsigned int i = 0; i < UPLOAD_BUFFER_COUNT; i++)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, UPLOAD_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+        fences[i] = 0;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    nextBuffer = 0;
+}
+
+TextureUploader::~TextureUploader()
+{
+    for(unsigned int i = 0; i < UPLOAD_BUFFER_COUNT; i++)
+        if(fences[i] != 0)
+            glDeleteSync(fences[i]);
+    glDeleteBuffers(UPLOAD_BUFFER_COUNT, buffers);
+}
+
+void TextureUploader::queue(GLuint texture, int level, int width, int height, GLenum format, const unsigned char* pixels, CompleteFunction complete)
+{
+    Job job;
+    job.texture = texture;
+    job.level = level;
+    job.width = width;
+    job.height = height;
+    job.format = format;
+    job.rowSize = (size_t)width * (format == GL_RED ? 1 : format == GL_RG ? 2 : format == GL_RGB ? 3 : 4);
+    job.pixels = pixels;
+    job.rowsDone = 0;
+    job.complete = std::move(complete);
+
+    // Storage only, no client memory is read
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+
+    jobs.push_back(std::move(job));
+}
+
+void TextureUploader::cancel(GLuint texture)
+{
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [texture](const Job &job) { return job.texture == texture; }), jobs.end());
+}
+
+void TextureUploader::update(size_t budget)
+{
+    GLint alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    size_t uploaded = 0;
+    while(!jobs.empty() && (uploaded == 0 || uploaded < budget))
+    {
+        // GPU still reads from the oldest buffer, continue next frame instead of waiting
+        GLsync &fence = fences[nextBuffer];
+        if(fence != 0)
+        {
+            if(glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                break;
+            glDeleteSync(fence);
+            fence = 0;
+        }
+
+        Job &job = jobs.front();
+        // As many rows as fit in buffer and what is left of budget, but always at least one
+        size_t remaining = uploaded < budget ? budget - uploaded : 0;
+        size_t rowLimit = std::max<size_t>(1, std::min(UPLOAD_BUFFER_SIZE, remaining) / job.rowSize);
+        int rows = std::min<size_t>(job.height - job.rowsDone, rowLimit);
+        size_t size = rows * job.rowSize;
+
+        // Fence passed, so invalidating and skipping synchronization is safe
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[nextBuffer]);
+        void* staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if(staging == nullptr)
+        {
+            std::cerr << "ERROR::TextureUploader::failed to map staging buffer" << std::endl;
+            break;
+        }
+        std::memcpy(staging, job.pixels + job.rowsDone * job.rowSize, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        glBindTexture(GL_TEXTURE_2D, job.texture);
+        glTexSubImage2D(GL_TEXTURE_2D, job.level, 0, job.rowsDone, job.width, rows, job.format, GL_UNSIGNED_BYTE, (void*)0);
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        nextBuffer = (nextBuffer + 1) % UPLOAD_BUFFER_COUNT;
+
+        uploaded += size;
+        job.rowsDone += rows;
+        if(job.rowsDone == job.height)
+        {
+            CompleteFunction complete = std::move(job.complete);
+            jobs.pop_front();
+            complete();
+        }
+    }
+
+    // Bound unpack buffer would turn pointers of later client uploads into offsets
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+}
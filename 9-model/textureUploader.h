@@ -0,0 +1,71 @@
+#pragma once
+
+#include <iostream>
+#include <deque>
+#include <functional>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+constexpr unsigned int UPLOAD_BUFFER_COUNT = 4;                 // Staging buffers in ring, GPU may still read the others
+constexpr size_t UPLOAD_BUFFER_SIZE = 4 * 1024 * 1024;          // Bytes per staging buffer, larger levels go in row chunks
+
+/**
+ * @brief Class TextureUploader copies texture levels to the GPU through a ring of pixel unpack buffers, a few rows at a time.
+ *
+ * update() copies rows of queued levels into the next staging buffer and issues glTexSubImage2D from it, so the driver
+ * uploads from a buffer it owns instead of copying client memory at call time. A fence after each copy tells when the GPU
+ * is done with the buffer: a buffer still in use ends the frame's uploads instead of stalling. At most "budget" bytes go
+ * per update(), so a large level trickles in over several frames.
+*/
+class TextureUploader
+{
+public:
+    /**
+     * @brief Called from update() once every row of a level was issued.
+    */
+    using CompleteFunction = std::function<void()>;
+
+private:
+    struct Job
+    {
+        GLuint texture;
+        int level;
+        int width, height;
+        GLenum format;
+        size_t rowSize;
+        const unsigned char* pixels;    // Owned by caller, valid until job completes or is cancelled
+        int rowsDone;
+        CompleteFunction complete;
+    };
+
+    GLuint buffers[UPLOAD_BUFFER_COUNT];
+    GLsync fences[UPLOAD_BUFFER_COUNT];     // Signaled once GPU stopped reading buffer, 0 if never used
+    unsigned int nextBuffer;
+    std::deque<Job> jobs;
+
+public:
+    TextureUploader();
+    ~TextureUploader();
+    TextureUploader(const TextureUploader &) = delete;
+    TextureUploader& operator=(const TextureUploader &) = delete;
+
+    /**
+     * @brief Queue upload of a whole level, its storage is defined now (empty) and filled by update().
+     * @param pixels Tightly packed rows, 1 byte per component.
+    */
+    void queue(GLuint texture, int level, int width, int height, GLenum format, const unsigned char* pixels, CompleteFunction complete);
+
+    /**
+     * @brief Drop queued uploads of texture, for textures about to be deleted.
+    */
+    void cancel(GLuint texture);
+
+    /**
+     * @brief Issue uploads, call once per frame.
+     * @param budget Bytes to upload at most (at least one row goes).
+    */
+    void update(size_t budget);
+
+    bool isIdle() const { return jobs.empty(); };
+};
@@ -0,0 +1,93 @@
+#include "threadPool.h"
+#include "cpuProfiler.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    job = nullptr;
+    itemCount = 0;
+    generation = 0;
+    pending = 0;
+    stopping = false;
+
+    // Calling thread works too, so we only need threadCount - 1 workers
+    for(unsigned int i = 1; i < threadCount; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+
+    for(unsigned int i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+void ThreadPool::workerLoop(unsigned int threadIndex)
+{
+    CpuProfiler::setThreadName("Worker " + std::to_string(threadIndex));
+    unsigned int seenGeneration = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+            if(stopping)
+                return;
+            seenGeneration = generation;
+        }
+
+        runRange(threadIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+        }
+        doneCondition.notify_one();
+    }
+}
+
+void ThreadPool::runRange(unsigned int threadIndex)
+{
+    unsigned int threadCount = getThreadCount();
+    unsigned int chunk = (itemCount + threadCount - 1) / threadCount;
+    unsigned int begin = std::min(itemCount, threadIndex * chunk);
+    unsigned int end = std::min(itemCount, begin + chunk);
+
+    if(begin < end)
+    {
+        CPU_ZONE("parallelFor");
+        (*job)(begin, end, threadIndex);
+    }
+}
+
+void ThreadPool::parallelFor(unsigned int itemCount, const RangeFunction &function)
+{
+    if(workers.empty() || itemCount < 2)
+    {
+        if(itemCount > 0)
+            function(0, itemCount, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &function;
+        this->itemCount = itemCount;
+        pending = workers.size();
+        generation++;
+    }
+    startCondition.notify_all();
+
+    runRange(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [&]() { return pending == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Class ThreadPool keeps worker threads alive between frames and splits loops across them.
+*/
+class ThreadPool
+{
+public:
+    /**
+     * @brief Function that processes items [begin, end), threadIndex is unique per running thread (0 is calling thread).
+    */
+    using RangeFunction = std::function<void(unsigned int begin, unsigned int end, unsigned int threadIndex)>;
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+
+    const RangeFunction* job;       // Job of current parallelFor, only valid while it runs
+    unsigned int itemCount;
+    unsigned int generation;        // Incremented every job so workers know a new job arrived
+    unsigned int pending;           // Workers that didn't finish current job yet
+    bool stopping;
+
+    void workerLoop(unsigned int threadIndex);
+    void runRange(unsigned int threadIndex);
+
+public:
+    /**
+     * @brief Constructor to start worker threads.
+     * @param threadCount Number of threads (including calling thread), 0 uses all hardware threads.
+    */
+    ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    /**
+     * @brief Run function over "itemCount" items split into one contiguous range per thread, returns when all ranges are done.
+     * @param itemCount Number of items.
+     * @param function Function that processes a range of items.
+    */
+    void parallelFor(unsigned int itemCount, const RangeFunction &function);
+
+    unsigned int getThreadCount() const { return workers.size() + 1; };
+};
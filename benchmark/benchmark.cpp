@@ -0,0 +1,210 @@
+#include "benchmark.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+bool Benchmark::parseArguments(int argc, char** argv, BenchmarkOptions &options)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(argument == "--benchmark")
+            options.enabled = true;
+        else if(argument == "--frames" && hasValue)
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        else if(argument == "--size" && hasValue)
+        {
+            if(std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 || options.height <= 0)
+            {
+                std::cerr << "ERROR::Benchmark::size has to be WIDTHxHEIGHT, got " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else if(argument == "--output" && hasValue)
+            options.output = argv[++i];
+        else
+        {
+            std::cerr << "ERROR::Benchmark::unknown argument " << argument << std::endl;
+            std::cerr << "usage: " << argv[0] << " [--benchmark [--frames N] [--size WxH] [--output file.json]]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void Benchmark::prepareContext()
+{
+#ifdef GLFW_PLATFORM_NULL
+    // GLFW 3.4+: without a display there is no window system at all, null platform with EGL renders surfaceless
+    // (Mesa llvmpipe works). Otherwise a hidden window on the normal platform (Xvfb works too).
+    if(std::getenv("DISPLAY") == nullptr && std::getenv("WAYLAND_DISPLAY") == nullptr)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+
+    if(!glfwInit())
+    {
+        std::cerr << "ERROR::Benchmark::failed to initialise GLFW" << std::endl;
+        return;
+    }
+
+#ifdef GLFW_PLATFORM_NULL
+    if(glfwGetPlatform() == GLFW_PLATFORM_NULL)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#endif
+    // glWindow calls glfwInit() again, which keeps these hints
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+}
+
+Benchmark::Benchmark(const BenchmarkOptions &options, const std::string &scene, glm::vec3 center, float radius)
+{
+    this->options = options;
+    this->scene = scene;
+    this->center = center;
+    this->radius = radius;
+
+    frame = 0;
+    counters = GlFrameCounters();
+    warmupBytesUploaded = 0;
+    frameTimes.reserve(options.frames);
+    cpuTimes.reserve(options.frames);
+
+    // No vsync, frames go as fast as GPU allows
+    glfwSwapInterval(0);
+    GlCounters::install();
+    GlCounters::takeFrame();
+
+    frameStart = std::chrono::steady_clock::now();
+    cpuStart = threadCpuTime();
+}
+
+uint64_t Benchmark::threadCpuTime()
+{
+#ifdef __linux__
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return (uint64_t)time.tv_sec * 1000000000ull + time.tv_nsec;
+#else
+    return (uint64_t)std::clock() * (1000000000ull / CLOCKS_PER_SEC);
+#endif
+}
+
+void Benchmark::beginFrame()
+{
+    glfwSetTime(frame * BENCHMARK_TIME_STEP);
+}
+
+BenchmarkCameraPose Benchmark::cameraPose() const
+{
+    // Warm-up frames look where the first measured frame looks
+    unsigned int measured = frame < BENCHMARK_WARMUP_FRAMES ? 0 : frame - BENCHMARK_WARMUP_FRAMES;
+    float progress = float(measured) / options.frames;
+    float angle = progress * 2.0f * glm::pi<float>();
+
+    BenchmarkCameraPose pose;
+    pose.position = center + glm::vec3(std::cos(angle) * radius, std::sin(angle) * radius * 0.25f, std::sin(angle) * radius);
+
+    glm::vec3 front = glm::normalize(center - pose.position);
+    pose.yaw = glm::degrees(std::atan2(front.z, front.x));
+    pose.pitch = glm::degrees(std::asin(glm::clamp(front.y, -1.0f, 1.0f)));
+    return pose;
+}
+
+void Benchmark::endFrame()
+{
+    uint64_t cpuEnd = threadCpuTime();
+    GlFrameCounters frameCounters = GlCounters::takeFrame();
+    glFinish();
+    std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+    // Drop the glFinish() above, it is the benchmark's sync point and not the scene's
+    GlCounters::takeFrame();
+
+    if(frame >= BENCHMARK_WARMUP_FRAMES)
+    {
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+        cpuTimes.push_back((cpuEnd - cpuStart) / 1000000.0);
+        counters += frameCounters;
+    }
+    else
+        warmupBytesUploaded += frameCounters.bytesUploaded;
+
+    frame++;
+    frameStart = frameEnd;
+    cpuStart = threadCpuTime();
+}
+
+double Benchmark::percentile(std::vector<double> values, double fraction)
+{
+    if(values.empty())
+        return 0.0;
+    size_t rank = std::min(values.size() - 1, (size_t)std::ceil(values.size() * fraction) - (fraction > 0.0 ? 1 : 0));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+bool Benchmark::finish()
+{
+    double frameSum = 0.0, cpuSum = 0.0;
+    for(double time : frameTimes)
+        frameSum += time;
+    for(double time : cpuTimes)
+        cpuSum += time;
+    size_t count = std::max<size_t>(1, frameTimes.size());
+
+    const GLubyte* renderer = glGetString(GL_RENDERER);
+    std::string rendererName = renderer ? (const char*)renderer : "unknown";
+    std::replace(rendererName.begin(), rendererName.end(), '"', '\'');
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\n"
+         << "  \"scene\": \"" << scene << "\",\n"
+         << "  \"renderer\": \"" << rendererName << "\",\n"
+         << "  \"width\": " << options.width << ",\n"
+         << "  \"height\": " << options.height << ",\n"
+         << "  \"frames\": " << frameTimes.size() << ",\n"
+         << "  \"warmupFrames\": " << BENCHMARK_WARMUP_FRAMES << ",\n"
+         << "  \"frameTimeMs\": { \"min\": " << percentile(frameTimes, 0.0) << ", \"avg\": " << frameSum / count
+         << ", \"p50\": " << percentile(frameTimes, 0.5) << ", \"p90\": " << percentile(frameTimes, 0.9)
+         << ", \"p99\": " << percentile(frameTimes, 0.99) << ", \"max\": " << percentile(frameTimes, 1.0) << " },\n"
+         << "  \"cpuTimeMs\": { \"avg\": " << cpuSum / count << ", \"p50\": " << percentile(cpuTimes, 0.5)
+         << ", \"p99\": " << percentile(cpuTimes, 0.99) << " },\n"
+         << "  \"drawCallsPerFrame\": " << double(counters.drawCalls) / count << ",\n"
+         << "  \"stateChangesPerFrame\": " << double(counters.stateChanges) / count << ",\n"
+         << "  \"programBindsPerFrame\": " << double(counters.programBinds) / count << ",\n"
+         << "  \"textureBindsPerFrame\": " << double(counters.textureBinds) / count << ",\n"
+         << "  \"uniformLocationQueriesPerFrame\": " << double(counters.uniformLocationQueries) / count << ",\n"
+         << "  \"syncPointsPerFrame\": " << double(counters.syncPoints) / count << ",\n"
+         << "  \"bytesUploadedPerFrame\": " << double(counters.bytesUploaded) / count << ",\n"
+         << "  \"bytesUploadedWarmup\": " << warmupBytesUploaded << "\n"
+         << "}\n";
+
+    if(options.output.empty())
+    {
+        std::cout << json.str();
+        return true;
+    }
+
+    std::ofstream file(options.output);
+    if(!file)
+    {
+        std::cerr << "ERROR::Benchmark::can't write report to " << options.output << std::endl;
+        return false;
+    }
+    file << json.str();
+    return true;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include <glm/glm.hpp>
+
+#include "glCounters.h"
+
+constexpr unsigned int BENCHMARK_DEFAULT_FRAMES = 600;
+constexpr unsigned int BENCHMARK_WARMUP_FRAMES = 30;      // Shader compiles and first uploads, not part of statistics
+constexpr int BENCHMARK_DEFAULT_WIDTH = 1280;
+constexpr int BENCHMARK_DEFAULT_HEIGHT = 720;
+constexpr double BENCHMARK_TIME_STEP = 1.0 / 60.0;       // Scene time advances by this much per frame
+
+/**
+ * @brief Struct BenchmarkOptions stores command line options of benchmark mode.
+*/
+struct BenchmarkOptions
+{
+    bool enabled = false;
+    unsigned int frames = BENCHMARK_DEFAULT_FRAMES;
+    int width = BENCHMARK_DEFAULT_WIDTH;
+    int height = BENCHMARK_DEFAULT_HEIGHT;
+    std::string output;         // JSON file, stdout if empty
+};
+
+/**
+ * @brief Struct BenchmarkCameraPose stores where scripted camera is in a frame.
+*/
+struct BenchmarkCameraPose
+{
+    glm::vec3 position;
+    float yaw;          // Degrees, same convention as Camera
+    float pitch;
+};
+
+/**
+ * @brief Class Benchmark renders a chapter's scene for a fixed number of frames without a visible window and reports timings.
+ *
+ * Usage in a chapter's main():
+ *   Benchmark::parseArguments() before anything else, then Benchmark::prepareContext() before creating the window, which
+ *   makes it hidden (or creates a surfaceless EGL context when there is no display and GLFW supports it).
+ *   Each frame: beginFrame(), apply cameraPose(), render, endFrame() instead of swapping buffers. finish() writes the report.
+ *
+ * Scene time is glfwGetTime(), beginFrame() sets it to frame * BENCHMARK_TIME_STEP so animations are the same every run.
+ * endFrame() waits for the GPU with glFinish(), frame time is the wall time between endFrame() calls and CPU time is the
+ * render thread's CPU time in between. GL call counts and uploaded bytes come from GlCounters, endFrame()'s own glFinish()
+ * isn't counted.
+*/
+class Benchmark
+{
+private:
+    BenchmarkOptions options;
+    std::string scene;
+    glm::vec3 center;
+    float radius;
+
+    unsigned int frame;
+    std::chrono::steady_clock::time_point frameStart;
+    uint64_t cpuStart;
+
+    std::vector<double> frameTimes;         // Milliseconds, measured frames only
+    std::vector<double> cpuTimes;
+    GlFrameCounters counters;               // Measured frames only
+    uint64_t warmupBytesUploaded;
+
+    static uint64_t threadCpuTime();
+    static double percentile(std::vector<double> values, double fraction);
+
+public:
+    /**
+     * @brief Parse "--benchmark [--frames N] [--size WxH] [--output file]".
+     * @return False on malformed arguments, options.enabled tells whether benchmark mode was requested.
+    */
+    static bool parseArguments(int argc, char** argv, BenchmarkOptions &options);
+
+    /**
+     * @brief Initialise GLFW for a window nobody sees, call before creating the window.
+    */
+    static void prepareContext();
+
+    /**
+     * @brief Start counting, call once the window (and GL context) exists.
+     * @param scene Name in the report.
+     * @param center Point camera orbits and looks at.
+     * @param radius Distance of orbit from center.
+    */
+    Benchmark(const BenchmarkOptions &options, const std::string &scene, glm::vec3 center, float radius);
+
+    void beginFrame();
+    void endFrame();
+
+    /**
+     * @brief Camera of current frame: one orbit around center over the whole run, rising and falling once.
+    */
+    BenchmarkCameraPose cameraPose() const;
+
+    bool isDone() const { return frame >= BENCHMARK_WARMUP_FRAMES + options.frames; };
+
+    /**
+     * @brief Write JSON report to output file or stdout.
+     * @return False if output can't be written.
+    */
+    bool finish();
+};
@@ -0,0 +1,693 @@
+#include "glCounters.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+// Return address of the wrapper is the call site, only where it can be symbolized
+#if defined(__linux__) && defined(__GNUC__)
+#define CALLER __builtin_return_address(0)
+#else
+#define CALLER nullptr
+#endif
+
+static std::atomic<bool> installed(false);
+// Atomic since loader threads with shared contexts upload too
+static std::atomic<uint64_t> drawCalls(0);
+static std::atomic<uint64_t> stateChanges(0);
+static std::atomic<uint64_t> programBinds(0);
+static std::atomic<uint64_t> textureBinds(0);
+static std::atomic<uint64_t> bytesUploaded(0);
+static std::atomic<uint64_t> uniformLocationQueries(0);
+static std::atomic<uint64_t> syncPoints(0);
+
+// Calls per (caller, GL function), a caller address only ever calls one function but wrappers can share a caller
+struct CallSiteKey
+{
+    const void* caller;
+    const char* function;
+
+    bool operator==(const CallSiteKey &other) const
+    {
+        return caller == other.caller && function == other.function;
+    }
+};
+
+struct CallSiteHash
+{
+    size_t operator()(const CallSiteKey &key) const
+    {
+        return std::hash<const void*>()(key.caller) ^ (std::hash<const void*>()(key.function) << 1);
+    }
+};
+
+// Bindings are per context and every thread here has its own context. Texture uploads from a bound unpack buffer
+// aren't counted, their bytes were counted when the buffer was written
+static thread_local GLuint unpackBuffer = 0;
+
+static std::atomic<bool> trackCallSites(false);
+static std::mutex callSiteMutex;
+static std::unordered_map<CallSiteKey, uint64_t, CallSiteHash> callSites;
+
+static void recordCallSite(const char* function, const void* caller)
+{
+    std::lock_guard<std::mutex> lock(callSiteMutex);
+    callSites[{ caller, function }]++;
+}
+
+// Function names are string literals, so comparing their addresses is enough for call site keys
+static void countCall(std::atomic<uint64_t> &counter, uint64_t amount, const char* function, const void* caller)
+{
+    counter.fetch_add(amount, std::memory_order_relaxed);
+    if(caller != nullptr && trackCallSites.load(std::memory_order_relaxed))
+        recordCallSite(function, caller);
+}
+
+// Original GLEW function pointers, wrappers call through them
+static PFNGLDRAWARRAYSINSTANCEDPROC realDrawArraysInstanced;
+static PFNGLDRAWELEMENTSINSTANCEDPROC realDrawElementsInstanced;
+static PFNGLDRAWELEMENTSBASEVERTEXPROC realDrawElementsBaseVertex;
+static PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC realDrawElementsInstancedBaseVertex;
+static PFNGLDRAWRANGEELEMENTSPROC realDrawRangeElements;
+static PFNGLMULTIDRAWARRAYSPROC realMultiDrawArrays;
+static PFNGLMULTIDRAWELEMENTSPROC realMultiDrawElements;
+static PFNGLBUFFERDATAPROC realBufferData;
+static PFNGLBUFFERSUBDATAPROC realBufferSubData;
+static PFNGLMAPBUFFERPROC realMapBuffer;
+static PFNGLMAPBUFFERRANGEPROC realMapBufferRange;
+static PFNGLTEXIMAGE3DPROC realTexImage3D;
+static PFNGLTEXSUBIMAGE3DPROC realTexSubImage3D;
+static PFNGLUSEPROGRAMPROC realUseProgram;
+static PFNGLBINDBUFFERPROC realBindBuffer;
+static PFNGLBINDBUFFERBASEPROC realBindBufferBase;
+static PFNGLBINDBUFFERRANGEPROC realBindBufferRange;
+static PFNGLBINDVERTEXARRAYPROC realBindVertexArray;
+static PFNGLBINDFRAMEBUFFERPROC realBindFramebuffer;
+static PFNGLACTIVETEXTUREPROC realActiveTexture;
+static PFNGLBINDSAMPLERPROC realBindSampler;
+static PFNGLBLENDFUNCSEPARATEPROC realBlendFuncSeparate;
+static PFNGLBLENDEQUATIONPROC realBlendEquation;
+static PFNGLDRAWBUFFERSPROC realDrawBuffers;
+static PFNGLGETUNIFORMLOCATIONPROC realGetUniformLocation;
+static PFNGLCLIENTWAITSYNCPROC realClientWaitSync;
+static PFNGLGETQUERYOBJECTIVPROC realGetQueryObjectiv;
+static PFNGLGETQUERYOBJECTUIVPROC realGetQueryObjectuiv;
+static PFNGLGETQUERYOBJECTI64VPROC realGetQueryObjecti64v;
+static PFNGLGETQUERYOBJECTUI64VPROC realGetQueryObjectui64v;
+static PFNGLGETBUFFERSUBDATAPROC realGetBufferSubData;
+
+static void GLAPIENTRY countDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount)
+{
+    countCall(drawCalls, 1, "glDrawArraysInstanced", CALLER);
+    realDrawArraysInstanced(mode, first, count, instanceCount);
+}
+
+static void GLAPIENTRY countDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount)
+{
+    countCall(drawCalls, 1, "glDrawElementsInstanced", CALLER);
+    realDrawElementsInstanced(mode, count, type, indices, instanceCount);
+}
+
+static void GLAPIENTRY countDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint baseVertex)
+{
+    countCall(drawCalls, 1, "glDrawElementsBaseVertex", CALLER);
+    realDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+}
+
+static void GLAPIENTRY countDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount, GLint baseVertex)
+{
+    countCall(drawCalls, 1, "glDrawElementsInstancedBaseVertex", CALLER);
+    realDrawElementsInstancedBaseVertex(mode, count, type, indices, instanceCount, baseVertex);
+}
+
+static void GLAPIENTRY countDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void* indices)
+{
+    countCall(drawCalls, 1, "glDrawRangeElements", CALLER);
+    realDrawRangeElements(mode, start, end, count, type, indices);
+}
+
+// A multi-draw is one call for the driver but drawCount draws for the GPU, it counts as drawCount
+static void GLAPIENTRY countMultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawCount)
+{
+    countCall(drawCalls, drawCount, "glMultiDrawArrays", CALLER);
+    realMultiDrawArrays(mode, first, count, drawCount);
+}
+
+static void GLAPIENTRY countMultiDrawElements(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei drawCount)
+{
+    countCall(drawCalls, drawCount, "glMultiDrawElements", CALLER);
+    realMultiDrawElements(mode, count, type, indices, drawCount);
+}
+
+static void GLAPIENTRY countBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    if(data != nullptr)
+        countCall(bytesUploaded, size, "glBufferData", CALLER);
+    realBufferData(target, size, data, usage);
+}
+
+static void GLAPIENTRY countBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    countCall(bytesUploaded, size, "glBufferSubData", CALLER);
+    realBufferSubData(target, offset, size, data);
+}
+
+// Size of the whole buffer isn't known here, write maps aren't counted as uploads; every map waits for GPU to be done with the buffer
+static void* GLAPIENTRY countMapBuffer(GLenum target, GLenum access)
+{
+    countCall(syncPoints, 1, "glMapBuffer", CALLER);
+    return realMapBuffer(target, access);
+}
+
+// Whatever the caller writes can't be seen, the whole write-mapped range is counted; persistent maps only count once.
+// Maps wait for GPU unless unsynchronized or the buffer is orphaned
+static void* GLAPIENTRY countMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    if(access & GL_MAP_WRITE_BIT)
+        countCall(bytesUploaded, length, "glMapBufferRange", CALLER);
+    if(!(access & (GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)))
+        countCall(syncPoints, 1, "glMapBufferRange", CALLER);
+    return realMapBufferRange(target, offset, length, access);
+}
+
+static void GLAPIENTRY countTexImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+    if(pixels != nullptr && unpackBuffer == 0)
+        countCall(bytesUploaded, GlCounters::imageSize(width, height, depth, format, type), "glTexImage3D", CALLER);
+    realTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels);
+}
+
+static void GLAPIENTRY countTexSubImage3D(GLenum target, GLint level, GLint xOffset, GLint yOffset, GLint zOffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels)
+{
+    if(unpackBuffer == 0)
+        countCall(bytesUploaded, GlCounters::imageSize(width, height, depth, format, type), "glTexSubImage3D", CALLER);
+    realTexSubImage3D(target, level, xOffset, yOffset, zOffset, width, height, depth, format, type, pixels);
+}
+
+static void GLAPIENTRY countUseProgram(GLuint program)
+{
+    countCall(programBinds, 1, "glUseProgram", CALLER);
+    realUseProgram(program);
+}
+
+static void GLAPIENTRY countBindBuffer(GLenum target, GLuint buffer)
+{
+    countCall(stateChanges, 1, "glBindBuffer", CALLER);
+    if(target == GL_PIXEL_UNPACK_BUFFER)
+        unpackBuffer = buffer;
+    realBindBuffer(target, buffer);
+}
+
+static void GLAPIENTRY countBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    countCall(stateChanges, 1, "glBindBufferBase", CALLER);
+    realBindBufferBase(target, index, buffer);
+}
+
+static void GLAPIENTRY countBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    countCall(stateChanges, 1, "glBindBufferRange", CALLER);
+    realBindBufferRange(target, index, buffer, offset, size);
+}
+
+static void GLAPIENTRY countBindVertexArray(GLuint array)
+{
+    countCall(stateChanges, 1, "glBindVertexArray", CALLER);
+    realBindVertexArray(array);
+}
+
+static void GLAPIENTRY countBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    countCall(stateChanges, 1, "glBindFramebuffer", CALLER);
+    realBindFramebuffer(target, framebuffer);
+}
+
+static void GLAPIENTRY countActiveTexture(GLenum texture)
+{
+    countCall(stateChanges, 1, "glActiveTexture", CALLER);
+    realActiveTexture(texture);
+}
+
+static void GLAPIENTRY countBindSampler(GLuint unit, GLuint sampler)
+{
+    countCall(textureBinds, 1, "glBindSampler", CALLER);
+    realBindSampler(unit, sampler);
+}
+
+static void GLAPIENTRY countBlendFuncSeparate(GLenum sourceRgb, GLenum destinationRgb, GLenum sourceAlpha, GLenum destinationAlpha)
+{
+    countCall(stateChanges, 1, "glBlendFuncSeparate", CALLER);
+    realBlendFuncSeparate(sourceRgb, destinationRgb, sourceAlpha, destinationAlpha);
+}
+
+static void GLAPIENTRY countBlendEquation(GLenum mode)
+{
+    countCall(stateChanges, 1, "glBlendEquation", CALLER);
+    realBlendEquation(mode);
+}
+
+static void GLAPIENTRY countDrawBuffers(GLsizei n, const GLenum* buffers)
+{
+    countCall(stateChanges, 1, "glDrawBuffers", CALLER);
+    realDrawBuffers(n, buffers);
+}
+
+static GLint GLAPIENTRY countGetUniformLocation(GLuint program, const GLchar* name)
+{
+    countCall(uniformLocationQueries, 1, "glGetUniformLocation", CALLER);
+    return realGetUniformLocation(program, name);
+}
+
+// A wait with timeout 0 only polls, it can't block
+static GLenum GLAPIENTRY countClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    if(timeout != 0)
+        countCall(syncPoints, 1, "glClientWaitSync", CALLER);
+    return realClientWaitSync(sync, flags, timeout);
+}
+
+// Asking whether a result is available doesn't block, asking for the result does until it is. Queries the calling
+// thread saw available are remembered (query names are per context, like bindings), reading their result then is free
+static thread_local std::unordered_set<GLuint> availableQueries;
+
+template <typename Value>
+static void getQueryObject(void (GLAPIENTRY *real)(GLuint, GLenum, Value*), GLuint id, GLenum pname, Value* params, const char* function, const void* caller)
+{
+    if(pname == GL_QUERY_RESULT && availableQueries.erase(id) == 0)
+        countCall(syncPoints, 1, function, caller);
+    real(id, pname, params);
+    if(pname == GL_QUERY_RESULT_AVAILABLE)
+    {
+        if(*params)
+            availableQueries.insert(id);
+        else
+            availableQueries.erase(id);
+    }
+}
+
+static void GLAPIENTRY countGetQueryObjectiv(GLuint id, GLenum pname, GLint* params)
+{
+    getQueryObject(realGetQueryObjectiv, id, pname, params, "glGetQueryObjectiv", CALLER);
+}
+
+static void GLAPIENTRY countGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params)
+{
+    getQueryObject(realGetQueryObjectuiv, id, pname, params, "glGetQueryObjectuiv", CALLER);
+}
+
+static void GLAPIENTRY countGetQueryObjecti64v(GLuint id, GLenum pname, GLint64* params)
+{
+    getQueryObject(realGetQueryObjecti64v, id, pname, params, "glGetQueryObjecti64v", CALLER);
+}
+
+static void GLAPIENTRY countGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params)
+{
+    getQueryObject(realGetQueryObjectui64v, id, pname, params, "glGetQueryObjectui64v", CALLER);
+}
+
+static void GLAPIENTRY countGetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data)
+{
+    countCall(syncPoints, 1, "glGetBufferSubData", CALLER);
+    realGetBufferSubData(target, offset, size, data);
+}
+
+// Swap one GLEW pointer for its wrapper, entry points the context doesn't have stay null
+template <typename Function>
+static void wrap(Function &glewPointer, Function &real, Function wrapper)
+{
+    real = glewPointer;
+    if(real != nullptr)
+        glewPointer = wrapper;
+}
+
+GlFrameCounters& GlFrameCounters::operator+=(const GlFrameCounters &other)
+{
+    drawCalls += other.drawCalls;
+    stateChanges += other.stateChanges;
+    programBinds += other.programBinds;
+    textureBinds += other.textureBinds;
+    bytesUploaded += other.bytesUploaded;
+    uniformLocationQueries += other.uniformLocationQueries;
+    syncPoints += other.syncPoints;
+    return *this;
+}
+
+void GlCounters::install()
+{
+    if(installed)
+        return;
+
+    wrap(glDrawArraysInstanced, realDrawArraysInstanced, countDrawArraysInstanced);
+    wrap(glDrawElementsInstanced, realDrawElementsInstanced, countDrawElementsInstanced);
+    wrap(glDrawElementsBaseVertex, realDrawElementsBaseVertex, countDrawElementsBaseVertex);
+    wrap(glDrawElementsInstancedBaseVertex, realDrawElementsInstancedBaseVertex, countDrawElementsInstancedBaseVertex);
+    wrap(glDrawRangeElements, realDrawRangeElements, countDrawRangeElements);
+    wrap(glMultiDrawArrays, realMultiDrawArrays, countMultiDrawArrays);
+    wrap(glMultiDrawElements, realMultiDrawElements, countMultiDrawElements);
+    wrap(glBufferData, realBufferData, countBufferData);
+    wrap(glBufferSubData, realBufferSubData, countBufferSubData);
+    wrap(glMapBuffer, realMapBuffer, countMapBuffer);
+    wrap(glMapBufferRange, realMapBufferRange, countMapBufferRange);
+    wrap(glTexImage3D, realTexImage3D, countTexImage3D);
+    wrap(glTexSubImage3D, realTexSubImage3D, countTexSubImage3D);
+    wrap(glUseProgram, realUseProgram, countUseProgram);
+    wrap(glBindBuffer, realBindBuffer, countBindBuffer);
+    wrap(glBindBufferBase, realBindBufferBase, countBindBufferBase);
+    wrap(glBindBufferRange, realBindBufferRange, countBindBufferRange);
+    wrap(glBindVertexArray, realBindVertexArray, countBindVertexArray);
+    wrap(glBindFramebuffer, realBindFramebuffer, countBindFramebuffer);
+    wrap(glActiveTexture, realActiveTexture, countActiveTexture);
+    wrap(glBindSampler, realBindSampler, countBindSampler);
+    wrap(glBlendFuncSeparate, realBlendFuncSeparate, countBlendFuncSeparate);
+    wrap(glBlendEquation, realBlendEquation, countBlendEquation);
+    wrap(glDrawBuffers, realDrawBuffers, countDrawBuffers);
+    wrap(glGetUniformLocation, realGetUniformLocation, countGetUniformLocation);
+    wrap(glClientWaitSync, realClientWaitSync, countClientWaitSync);
+    wrap(glGetQueryObjectiv, realGetQueryObjectiv, countGetQueryObjectiv);
+    wrap(glGetQueryObjectuiv, realGetQueryObjectuiv, countGetQueryObjectuiv);
+    wrap(glGetQueryObjecti64v, realGetQueryObjecti64v, countGetQueryObjecti64v);
+    wrap(glGetQueryObjectui64v, realGetQueryObjectui64v, countGetQueryObjectui64v);
+    wrap(glGetBufferSubData, realGetBufferSubData, countGetBufferSubData);
+
+    installed = true;
+}
+
+bool GlCounters::isInstalled()
+{
+    return installed;
+}
+
+GlFrameCounters GlCounters::takeFrame()
+{
+    GlFrameCounters frame;
+    frame.drawCalls = drawCalls.exchange(0, std::memory_order_relaxed);
+    frame.stateChanges = stateChanges.exchange(0, std::memory_order_relaxed);
+    frame.programBinds = programBinds.exchange(0, std::memory_order_relaxed);
+    frame.textureBinds = textureBinds.exchange(0, std::memory_order_relaxed);
+    frame.bytesUploaded = bytesUploaded.exchange(0, std::memory_order_relaxed);
+    frame.uniformLocationQueries = uniformLocationQueries.exchange(0, std::memory_order_relaxed);
+    frame.syncPoints = syncPoints.exchange(0, std::memory_order_relaxed);
+    return frame;
+}
+
+void GlCounters::setCallSiteTracking(bool enabled)
+{
+#if defined(__linux__) && defined(__GNUC__)
+    trackCallSites = enabled;
+    if(!enabled)
+    {
+        std::lock_guard<std::mutex> lock(callSiteMutex);
+        callSites.clear();
+    }
+#else
+    if(enabled)
+        std::cerr << "ERROR::GlCounters::call site tracking is only supported on Linux" << std::endl;
+#endif
+}
+
+// "function (module+0xoffset)", offset is of the call instruction (return address - 1) so addr2line gives the calling line
+static std::string describeCaller(const void* caller)
+{
+    std::ostringstream location;
+#ifdef __linux__
+    Dl_info info;
+    if(dladdr(caller, &info) != 0 && info.dli_fname != nullptr)
+    {
+        // Functions of the executable only have names if it exports its symbols (ENABLE_EXPORTS)
+        if(info.dli_sname != nullptr)
+        {
+            int status;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            location << (status == 0 ? demangled : info.dli_sname) << " ";
+            std::free(demangled);
+        }
+        const char* module = std::strrchr(info.dli_fname, '/');
+        location << "(" << (module != nullptr ? module + 1 : info.dli_fname) << "+0x" << std::hex
+                 << (uintptr_t)caller - (uintptr_t)info.dli_fbase - 1 << ")";
+        return location.str();
+    }
+#endif
+    location << caller;
+    return location.str();
+}
+
+std::vector<GlCallSite> GlCounters::takeCallSites(unsigned int count)
+{
+    std::vector<std::pair<CallSiteKey, uint64_t>> sites;
+    {
+        std::lock_guard<std::mutex> lock(callSiteMutex);
+        sites.assign(callSites.begin(), callSites.end());
+        callSites.clear();
+    }
+
+    // Only the top ones are symbolized, dladdr() is slow
+    size_t top = std::min<size_t>(count, sites.size());
+    std::partial_sort(sites.begin(), sites.begin() + top, sites.end(), [](const std::pair<CallSiteKey, uint64_t> &a, const std::pair<CallSiteKey, uint64_t> &b)
+    {
+        return a.second > b.second;
+    });
+
+    std::vector<GlCallSite> result;
+    for(size_t i = 0; i < top; i++)
+        result.push_back({ describeCaller(sites[i].first.caller), sites[i].first.function, sites[i].second });
+    return result;
+}
+
+uint64_t GlCounters::imageSize(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type)
+{
+    uint64_t components;
+    switch(format)
+    {
+        case GL_RED:
+        case GL_DEPTH_COMPONENT:
+            components = 1;
+            break;
+        case GL_RG:
+        case GL_DEPTH_STENCIL:
+            components = 2;
+            break;
+        case GL_RGB:
+        case GL_BGR:
+            components = 3;
+            break;
+        default:
+            components = 4;
+            break;
+    }
+
+    uint64_t componentSize;
+    switch(type)
+    {
+        case GL_UNSIGNED_BYTE:
+        case GL_BYTE:
+            componentSize = 1;
+            break;
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT:
+            componentSize = 2;
+            break;
+        case GL_UNSIGNED_INT_24_8:
+            // Packed, one 4 byte value per pixel
+            components = 1;
+            componentSize = 4;
+            break;
+        default:
+            componentSize = 4;
+            break;
+    }
+
+    return (uint64_t)width * height * depth * components * componentSize;
+}
+
+#ifdef __linux__
+// GL 1.1 entry points, definitions in the executable take precedence over libGL's, RTLD_NEXT finds libGL's
+template <typename Function>
+static Function nextDefinition(const char* name)
+{
+    return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+}
+
+// Wrappers count only after install(), GLEW itself calls some of these from glewInit()
+#define COUNT_INSTALLED(counter, amount, function) if(installed) countCall(counter, amount, function, CALLER)
+
+extern "C"
+{
+
+GLAPI void GLAPIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum, GLint, GLsizei)>("glDrawArrays");
+    COUNT_INSTALLED(drawCalls, 1, "glDrawArrays");
+    real(mode, first, count);
+}
+
+GLAPI void GLAPIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum, GLsizei, GLenum, const void*)>("glDrawElements");
+    COUNT_INSTALLED(drawCalls, 1, "glDrawElements");
+    real(mode, count, type, indices);
+}
+
+GLAPI void GLAPIENTRY glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*)>("glTexImage2D");
+    if(pixels != nullptr && unpackBuffer == 0)
+        COUNT_INSTALLED(bytesUploaded, GlCounters::imageSize(width, height, 1, format, type), "glTexImage2D");
+    real(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+GLAPI void GLAPIENTRY glTexSubImage2D(GLenum target, GLint level, GLint xOffset, GLint yOffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*)>("glTexSubImage2D");
+    if(unpackBuffer == 0)
+        COUNT_INSTALLED(bytesUploaded, GlCounters::imageSize(width, height, 1, format, type), "glTexSubImage2D");
+    real(target, level, xOffset, yOffset, width, height, format, type, pixels);
+}
+
+GLAPI void GLAPIENTRY glBindTexture(GLenum target, GLuint texture)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum, GLuint)>("glBindTexture");
+    COUNT_INSTALLED(textureBinds, 1, "glBindTexture");
+    real(target, texture);
+}
+
+GLAPI void GLAPIENTRY glEnable(GLenum capability)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum)>("glEnable");
+    COUNT_INSTALLED(stateChanges, 1, "glEnable");
+    real(capability);
+}
+
+GLAPI void GLAPIENTRY glDisable(GLenum capability)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum)>("glDisable");
+    COUNT_INSTALLED(stateChanges, 1, "glDisable");
+    real(capability);
+}
+
+GLAPI void GLAPIENTRY glBlendFunc(GLenum source, GLenum destination)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum, GLenum)>("glBlendFunc");
+    COUNT_INSTALLED(stateChanges, 1, "glBlendFunc");
+    real(source, destination);
+}
+
+GLAPI void GLAPIENTRY glDepthFunc(GLenum function)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum)>("glDepthFunc");
+    COUNT_INSTALLED(stateChanges, 1, "glDepthFunc");
+    real(function);
+}
+
+GLAPI void GLAPIENTRY glDepthMask(GLboolean flag)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLboolean)>("glDepthMask");
+    COUNT_INSTALLED(stateChanges, 1, "glDepthMask");
+    real(flag);
+}
+
+GLAPI void GLAPIENTRY glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLboolean, GLboolean, GLboolean, GLboolean)>("glColorMask");
+    COUNT_INSTALLED(stateChanges, 1, "glColorMask");
+    real(red, green, blue, alpha);
+}
+
+GLAPI void GLAPIENTRY glCullFace(GLenum mode)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum)>("glCullFace");
+    COUNT_INSTALLED(stateChanges, 1, "glCullFace");
+    real(mode);
+}
+
+GLAPI void GLAPIENTRY glPolygonMode(GLenum face, GLenum mode)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum, GLenum)>("glPolygonMode");
+    COUNT_INSTALLED(stateChanges, 1, "glPolygonMode");
+    real(face, mode);
+}
+
+GLAPI void GLAPIENTRY glStencilFunc(GLenum function, GLint reference, GLuint mask)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum, GLint, GLuint)>("glStencilFunc");
+    COUNT_INSTALLED(stateChanges, 1, "glStencilFunc");
+    real(function, reference, mask);
+}
+
+GLAPI void GLAPIENTRY glStencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum, GLenum, GLenum)>("glStencilOp");
+    COUNT_INSTALLED(stateChanges, 1, "glStencilOp");
+    real(stencilFail, depthFail, depthPass);
+}
+
+GLAPI void GLAPIENTRY glStencilMask(GLuint mask)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLuint)>("glStencilMask");
+    COUNT_INSTALLED(stateChanges, 1, "glStencilMask");
+    real(mask);
+}
+
+GLAPI void GLAPIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLint, GLint, GLsizei, GLsizei)>("glViewport");
+    COUNT_INSTALLED(stateChanges, 1, "glViewport");
+    real(x, y, width, height);
+}
+
+GLAPI void GLAPIENTRY glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLint, GLint, GLsizei, GLsizei)>("glScissor");
+    COUNT_INSTALLED(stateChanges, 1, "glScissor");
+    real(x, y, width, height);
+}
+
+GLAPI void GLAPIENTRY glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLfloat, GLfloat, GLfloat, GLfloat)>("glClearColor");
+    COUNT_INSTALLED(stateChanges, 1, "glClearColor");
+    real(red, green, blue, alpha);
+}
+
+GLAPI void GLAPIENTRY glFinish(void)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(void)>("glFinish");
+    COUNT_INSTALLED(syncPoints, 1, "glFinish");
+    real();
+}
+
+GLAPI void GLAPIENTRY glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, void*)>("glReadPixels");
+    COUNT_INSTALLED(syncPoints, 1, "glReadPixels");
+    real(x, y, width, height, format, type, pixels);
+}
+
+// Gets and errors are answered right away, a threaded driver (Mesa's glthread, NVIDIA's threaded optimization) waits for its thread
+GLAPI void GLAPIENTRY glGetIntegerv(GLenum pname, GLint* data)
+{
+    static const auto real = nextDefinition<void (GLAPIENTRY *)(GLenum, GLint*)>("glGetIntegerv");
+    COUNT_INSTALLED(syncPoints, 1, "glGetIntegerv");
+    real(pname, data);
+}
+
+GLAPI GLenum GLAPIENTRY glGetError(void)
+{
+    static const auto real = nextDefinition<GLenum (GLAPIENTRY *)(void)>("glGetError");
+    COUNT_INSTALLED(syncPoints, 1, "glGetError");
+    return real();
+}
+
+}
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+/**
+ * @brief Struct GlFrameCounters stores GL work issued during one frame.
+*/
+struct GlFrameCounters
+{
+    uint64_t drawCalls = 0;
+    uint64_t stateChanges = 0;          // Fixed function state, viewport, buffer, vertex array and framebuffer binds, active texture unit
+    uint64_t programBinds = 0;
+    uint64_t textureBinds = 0;
+    uint64_t bytesUploaded = 0;         // Buffer and texture data handed to GL, including write-mapped buffer ranges (texture uploads from unpack buffers count there)
+    uint64_t uniformLocationQueries = 0;
+    uint64_t syncPoints = 0;            // Calls that can make CPU wait for GPU (or for a threaded driver): finish, reads, gets, waits
+
+    GlFrameCounters& operator+=(const GlFrameCounters &other);
+};
+
+/**
+ * @brief Struct GlCallSite stores how often one place in code called one GL function.
+*/
+struct GlCallSite
+{
+    std::string location;       // Function and module offset of caller, "addr2line -e module offset" gives the line
+    const char* function;       // GL function called
+    uint64_t calls;
+};
+
+/**
+ * @brief Class GlCounters is an interception layer that counts GL calls by kind, and optionally by call site.
+ *
+ * Entry points GLEW loads (glUseProgram, glBufferData, glDrawElementsInstanced, ...) are wrapped by swapping GLEW's
+ * function pointers in install(). GL 1.1 entry points (glDrawArrays, glBindTexture, glEnable, glFinish, ...) are exported
+ * by libGL itself, on Linux they are interposed by definitions in glCounters.cpp that forward to the next definition;
+ * elsewhere they aren't counted. Wrappers only count after install(), so linking this in costs nothing until then.
+ *
+ * Counters are atomics, loader threads with shared contexts call GL too. Call sites are the return addresses of wrappers,
+ * tracking them takes a lock per call and is off until setCallSiteTracking(true).
+*/
+class GlCounters
+{
+public:
+    /**
+     * @brief Wrap GLEW function pointers and start counting, call after glewInit().
+    */
+    static void install();
+
+    static bool isInstalled();
+
+    /**
+     * @brief Counters since last call, then reset them.
+    */
+    static GlFrameCounters takeFrame();
+
+    /**
+     * @brief Count calls per call site from now on (Linux only), or stop and forget them.
+    */
+    static void setCallSiteTracking(bool enabled);
+
+    /**
+     * @brief Call sites with most calls since last call, then reset them.
+     * @param count Number of call sites returned at most.
+    */
+    static std::vector<GlCallSite> takeCallSites(unsigned int count);
+
+    /**
+     * @brief Bytes of a width x height x depth image in format and type.
+    */
+    static uint64_t imageSize(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type);
+};
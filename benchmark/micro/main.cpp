@@ -0,0 +1,199 @@
+#include "glWindow.h"
+#include "camera.h"
+#include "shader.h"
+#include "shaderPreprocessor.h"
+#include "clusteredLighting.h"
+#include "cascadedShadowMap.h"
+#include "pointShadowAtlas.h"
+#include "benchmark.h"
+#include "microBenchmark.h"
+#include "modelBenchmark.h"
+#include "../../11-blending/transparentQueue.h"
+
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Working directory, suite runs from benchmark/micro/build like chapters run from their build directory
+std::string pwd = std::filesystem::current_path().string();
+std::string shaderDirectory = pwd + "/../../../9-model/shaders";
+
+// Light set-up of 9-model: 5 scene lights, DYNAMIC_LIGHT_COUNT moving ones and the flashlight
+const unsigned int SCENE_LIGHT_COUNT = 5;
+const unsigned int DYNAMIC_LIGHT_COUNT = 1024;
+const float DYNAMIC_LIGHT_AREA = 20.0f;
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
+const float FRAME_TIME_STEP = 1.0f / 60.0f;
+
+void addCameraCases(MicroBenchmark &suite)
+{
+    suite.add("Camera::updateCameraVectors", 0, []() -> MicroBenchmarkBody
+    {
+        std::shared_ptr<Camera> camera(new Camera(glm::vec3(0.0f, 0.0f, 3.0f)));
+        // Mouse movement is the public way in, it only adds offsets to yaw and pitch before updating vectors
+        return [camera](uint64_t iterations)
+        {
+            for(uint64_t i = 0; i < iterations; i++)
+            {
+                camera->processMouseMovement(0.1f, (i & 1) ? 0.1f : -0.1f);
+                MicroBenchmark::doNotOptimize(camera->getFront());
+            }
+        };
+    });
+
+    suite.add("Camera::calculateLookAtMatrix", 0, []() -> MicroBenchmarkBody
+    {
+        std::shared_ptr<Camera> camera(new Camera(glm::vec3(0.0f, 0.0f, 3.0f)));
+        return [camera](uint64_t iterations)
+        {
+            glm::vec3 position = camera->getPosition();
+            for(uint64_t i = 0; i < iterations; i++)
+            {
+                // Inputs go through doNotOptimize so the matrix can't be computed once for all iterations
+                MicroBenchmark::doNotOptimize(position);
+                glm::mat4 view = camera->calculateLookAtMatrix(position, position + camera->getFront(), camera->getUp());
+                MicroBenchmark::doNotOptimize(view);
+            }
+        };
+    });
+}
+
+// Lights packed, assigned to froxels and uploaded as in a 9-model frame, dynamic lights move every iteration
+struct LightUploadState
+{
+    std::unique_ptr<Shader> lightShader;
+    ClusteredLighting clusteredLighting;
+    std::vector<PointLight> pointLights;
+    std::vector<glm::vec4> dynamicLightPaths;
+    std::vector<SpotLight> spotLights;
+    glm::mat4 view;
+    float time = 0.0f;
+};
+
+void addLightUploadCases(MicroBenchmark &suite)
+{
+    const unsigned int lightCounts[] = { SCENE_LIGHT_COUNT, SCENE_LIGHT_COUNT + DYNAMIC_LIGHT_COUNT };
+    for(unsigned int lightCount : lightCounts)
+    {
+        suite.add("ClusteredLighting::update+bind/" + std::to_string(lightCount), lightCount, [lightCount]() -> MicroBenchmarkBody
+        {
+            std::shared_ptr<LightUploadState> state(new LightUploadState());
+            std::string lightDefines = ShaderPreprocessor::define("LIGHT_TEXELS", std::to_string(LIGHT_TEXELS)) +
+                                       ShaderPreprocessor::define("LIGHT_SPOT", std::to_string(LIGHT_SPOT)) +
+                                       ShaderPreprocessor::define("CLUSTER_X", std::to_string(CLUSTER_X)) +
+                                       ShaderPreprocessor::define("CLUSTER_Y", std::to_string(CLUSTER_Y)) +
+                                       ShaderPreprocessor::define("CLUSTER_Z", std::to_string(CLUSTER_Z)) +
+                                       ShaderPreprocessor::define("MAX_SHADOW_CASCADES", std::to_string(MAX_SHADOW_CASCADES)) +
+                                       ShaderPreprocessor::define("CUBE_FACES", std::to_string(CUBE_FACES));
+            state->lightShader.reset(new Shader((shaderDirectory + "/light.vs").c_str(), (shaderDirectory + "/light.fs").c_str(), nullptr, lightDefines));
+
+            for(unsigned int i = 0; i < lightCount; i++)
+            {
+                float x = (std::fmod(i * 0.618034f, 1.0f) - 0.5f) * DYNAMIC_LIGHT_AREA;
+                float z = (std::fmod(i * 0.754878f, 1.0f) - 0.5f) * DYNAMIC_LIGHT_AREA;
+                float y = (std::fmod(i * 0.569840f, 1.0f) - 0.5f) * 6.0f;
+                state->dynamicLightPaths.push_back(glm::vec4(x, y, z, i * 0.1f));
+                state->pointLights.push_back(PointLight(glm::vec3(x, y, z), 1.0f, 0.7f, 1.8f, glm::vec3(0.05f), glm::vec3(1.0f), glm::vec3(1.0f)));
+            }
+            state->spotLights.push_back(SpotLight(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, -1.0f), 15.0f, 17.5f, 1.0f, 0.09f, 0.032f, glm::vec3(0.0f), glm::vec3(1.0f), glm::vec3(1.0f)));
+            state->view = glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            state->clusteredLighting.setProjection(glm::radians(45.0f), float(BENCHMARK_DEFAULT_WIDTH) / BENCHMARK_DEFAULT_HEIGHT, NEAR_PLANE, FAR_PLANE);
+
+            return [state](uint64_t iterations)
+            {
+                state->lightShader->use();
+                for(uint64_t i = 0; i < iterations; i++)
+                {
+                    state->time += FRAME_TIME_STEP;
+                    for(unsigned int j = 0; j < state->pointLights.size(); j++)
+                    {
+                        const glm::vec4 &path = state->dynamicLightPaths[j];
+                        state->pointLights[j].setPosition(glm::vec3(path) + glm::vec3(std::cos(state->time + path.w), 0.0f, std::sin(state->time + path.w)));
+                    }
+                    state->clusteredLighting.update(state->view, state->pointLights, state->pointLights.size(), state->spotLights, state->spotLights.size());
+                    state->clusteredLighting.bind(*state->lightShader, BENCHMARK_DEFAULT_WIDTH, BENCHMARK_DEFAULT_HEIGHT);
+                }
+                // Uploads are only queued by then, time it took GPU to take them belongs to the sample
+                glFinish();
+            };
+        });
+    }
+}
+
+void addTransparentSortCases(MicroBenchmark &suite)
+{
+    const unsigned int objectCounts[] = { 1000, 10000, 100000 };
+    for(unsigned int objectCount : objectCounts)
+    {
+        suite.add("TransparentQueue::sort/" + std::to_string(objectCount), objectCount, [objectCount]() -> MicroBenchmarkBody
+        {
+            // Windows scattered in front of camera, pushed with their squared distance like 11-blending does every frame
+            std::shared_ptr<std::vector<glm::vec3>> positions(new std::vector<glm::vec3>());
+            for(unsigned int i = 0; i < objectCount; i++)
+                positions->push_back(glm::vec3((std::fmod(i * 0.618034f, 1.0f) - 0.5f) * 40.0f, (std::fmod(i * 0.569840f, 1.0f) - 0.5f) * 10.0f, -std::fmod(i * 0.754878f, 1.0f) * 40.0f));
+            std::shared_ptr<TransparentQueue> queue(new TransparentQueue(objectCount));
+
+            return [positions, queue](uint64_t iterations)
+            {
+                glm::vec3 cameraPosition(0.0f, 0.0f, 3.0f);
+                for(uint64_t i = 0; i < iterations; i++)
+                {
+                    // Camera moves a little every frame, so the order changes like it does while walking
+                    cameraPosition.x = std::sin(float(i) * 0.01f);
+                    queue->clear();
+                    for(unsigned int j = 0; j < positions->size(); j++)
+                    {
+                        glm::vec3 offset = (*positions)[j] - cameraPosition;
+                        queue->push(glm::dot(offset, offset), j);
+                    }
+                    queue->sort();
+                    MicroBenchmark::doNotOptimize(queue->getIndex(0));
+                }
+            };
+        });
+    }
+}
+
+void addShaderCases(MicroBenchmark &suite)
+{
+    const char* files[] = { "light.vs", "light.fs" };
+    for(const char* file : files)
+    {
+        std::string path = shaderDirectory + "/" + file;
+        suite.add(std::string("Shader::readFile/") + file, Shader::readFile(path).size(), [path]() -> MicroBenchmarkBody
+        {
+            return [path](uint64_t iterations)
+            {
+                for(uint64_t i = 0; i < iterations; i++)
+                {
+                    std::string text = Shader::readFile(path);
+                    MicroBenchmark::doNotOptimize(text.data());
+                }
+            };
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // Hidden window (or surfaceless EGL context) like the frame benchmark, only light upload needs GL
+    Benchmark::prepareContext();
+    glWindow window("Micro benchmarks", 64, 64);
+
+    MicroBenchmark suite;
+    ModelBenchmark::addCases(suite);
+    addCameraCases(suite);
+    if(window.getGlWindow() != nullptr)
+        addLightUploadCases(suite);
+    else
+        std::cerr << "ERROR::MicroBenchmark::no GL context, light upload cases are skipped" << std::endl;
+    addTransparentSortCases(suite);
+    addShaderCases(suite);
+
+    return suite.run(argc, argv);
+}
@@ -0,0 +1,182 @@
+#include "microBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+void MicroBenchmark::add(const std::string &name, uint64_t itemsPerIteration, std::function<MicroBenchmarkBody()> setup)
+{
+    cases.push_back({ name, itemsPerIteration, setup });
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+MicroBenchmarkResult MicroBenchmark::measure(const std::string &name, MicroBenchmarkBody &body, uint64_t itemsPerIteration)
+{
+    // First run also warms caches and lazily created state, it is never a sample
+    uint64_t iterations = 1;
+    double sampleTime;
+    while(true)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        body(iterations);
+        sampleTime = secondsSince(start);
+        if(sampleTime >= MICRO_BENCHMARK_SAMPLE_TIME)
+            break;
+        iterations *= 2;
+    }
+
+    unsigned int sampleCount = (unsigned int)std::max<double>(MICRO_BENCHMARK_MIN_SAMPLES, MICRO_BENCHMARK_CASE_TIME / sampleTime);
+    sampleCount = std::min(sampleCount, MICRO_BENCHMARK_MAX_SAMPLES);
+
+    std::vector<double> samples;
+    for(unsigned int i = 0; i < sampleCount; i++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        body(iterations);
+        samples.push_back(secondsSince(start) * 1e9 / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    MicroBenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.samples = sampleCount;
+    result.minNs = samples.front();
+    result.medianNs = samples[samples.size() / 2];
+    result.maxNs = samples.back();
+    result.itemsPerSecond = itemsPerIteration > 0 ? itemsPerIteration * 1e9 / result.medianNs : 0.0;
+    return result;
+}
+
+void MicroBenchmark::writeReport(std::ostream &stream, const std::vector<MicroBenchmarkResult> &results)
+{
+    stream << std::fixed << std::setprecision(1);
+    stream << "{\n"
+           << "  \"suite\": \"micro\",\n"
+           << "  \"version\": " << MICRO_BENCHMARK_FORMAT_VERSION << ",\n"
+           << "  \"results\": [\n";
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const MicroBenchmarkResult &result = results[i];
+        // One case per line, readBaseline() depends on it
+        stream << "    { \"name\": \"" << result.name << "\", \"iterations\": " << result.iterations << ", \"samples\": " << result.samples
+               << ", \"minNs\": " << result.minNs << ", \"medianNs\": " << result.medianNs << ", \"maxNs\": " << result.maxNs
+               << ", \"itemsPerSecond\": " << result.itemsPerSecond << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    stream << "  ]\n"
+           << "}\n";
+}
+
+bool MicroBenchmark::readBaseline(const std::string &path, std::vector<std::pair<std::string, double>> &medians)
+{
+    std::ifstream file(path);
+    if(!file)
+    {
+        std::cerr << "ERROR::MicroBenchmark::can't read baseline " << path << std::endl;
+        return false;
+    }
+
+    const std::string versionKey = "\"version\": ";
+    const std::string nameKey = "\"name\": \"";
+    const std::string medianKey = "\"medianNs\": ";
+    std::string line;
+    while(std::getline(file, line))
+    {
+        size_t version = line.find(versionKey);
+        if(version != std::string::npos && std::atoi(line.c_str() + version + versionKey.size()) != MICRO_BENCHMARK_FORMAT_VERSION)
+        {
+            std::cerr << "ERROR::MicroBenchmark::baseline " << path << " has another report version" << std::endl;
+            return false;
+        }
+
+        size_t name = line.find(nameKey);
+        size_t median = line.find(medianKey);
+        if(name == std::string::npos || median == std::string::npos)
+            continue;
+        name += nameKey.size();
+        medians.push_back({ line.substr(name, line.find('"', name) - name), std::atof(line.c_str() + median + medianKey.size()) });
+    }
+    return true;
+}
+
+int MicroBenchmark::run(int argc, char** argv)
+{
+    std::string filter, output, baselinePath;
+    bool list = false;
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(argument == "--filter" && hasValue)
+            filter = argv[++i];
+        else if(argument == "--output" && hasValue)
+            output = argv[++i];
+        else if(argument == "--baseline" && hasValue)
+            baselinePath = argv[++i];
+        else if(argument == "--list")
+            list = true;
+        else
+        {
+            std::cerr << "ERROR::MicroBenchmark::unknown argument " << argument << std::endl;
+            std::cerr << "usage: " << argv[0] << " [--filter text] [--output file.json] [--baseline file.json] [--list]" << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<std::pair<std::string, double>> baseline;
+    if(!baselinePath.empty() && !readBaseline(baselinePath, baseline))
+        return -1;
+
+    // Progress and comparison go to stderr, stdout only gets the report when there is no output file
+    std::vector<MicroBenchmarkResult> results;
+    for(Case &benchmarkCase : cases)
+    {
+        if(benchmarkCase.name.find(filter) == std::string::npos)
+            continue;
+        if(list)
+        {
+            std::cout << benchmarkCase.name << std::endl;
+            continue;
+        }
+
+        MicroBenchmarkResult result;
+        {
+            MicroBenchmarkBody body = benchmarkCase.setup();
+            result = measure(benchmarkCase.name, body, benchmarkCase.itemsPerIteration);
+        }
+        results.push_back(result);
+
+        std::cerr << std::left << std::setw(48) << result.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(16) << result.medianNs << " ns";
+        for(const std::pair<std::string, double> &entry : baseline)
+        {
+            if(entry.first == result.name && entry.second > 0.0)
+                std::cerr << std::showpos << std::setw(10) << (result.medianNs / entry.second - 1.0) * 100.0 << std::noshowpos << " %";
+        }
+        std::cerr << std::endl;
+    }
+    if(list)
+        return 0;
+
+    if(output.empty())
+    {
+        writeReport(std::cout, results);
+        return 0;
+    }
+
+    std::ofstream file(output);
+    if(!file)
+    {
+        std::cerr << "ERROR::MicroBenchmark::can't write report to " << output << std::endl;
+        return -1;
+    }
+    writeReport(file, results);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+constexpr int MICRO_BENCHMARK_FORMAT_VERSION = 1;          // Bump when report fields change, baselines of other versions are refused
+constexpr double MICRO_BENCHMARK_SAMPLE_TIME = 0.02;       // Seconds, iterations per sample grow until one sample takes this long
+constexpr double MICRO_BENCHMARK_CASE_TIME = 1.0;          // Seconds of sampling per case, slow cases take fewer samples
+constexpr unsigned int MICRO_BENCHMARK_MIN_SAMPLES = 3;
+constexpr unsigned int MICRO_BENCHMARK_MAX_SAMPLES = 30;
+
+// Runs body "iterations" times, state it needs was built by the case's setup
+typedef std::function<void(uint64_t iterations)> MicroBenchmarkBody;
+
+/**
+ * @brief Struct MicroBenchmarkResult stores timing of one case.
+*/
+struct MicroBenchmarkResult
+{
+    std::string name;
+    uint64_t iterations;        // Per sample
+    unsigned int samples;
+    double minNs;               // Per iteration
+    double medianNs;
+    double maxNs;
+    double itemsPerSecond;      // From median, 0 if case has no items
+};
+
+/**
+ * @brief Class MicroBenchmark is a small harness for CPU micro benchmarks.
+ *
+ * A case is a name, a setup that builds its data and returns the timed body, and the number of items (vertices, lights,
+ * bytes, ...) one iteration handles. Setup only runs when the case is selected, its data is freed once the case is done.
+ * Iterations per sample are doubled until a sample takes MICRO_BENCHMARK_SAMPLE_TIME, then samples are taken until
+ * MICRO_BENCHMARK_CASE_TIME is used up; min, median and max are per iteration.
+ *
+ * Report is JSON with one case per line in registration order, so reports of two commits diff line by line and
+ * "--baseline" can read one back without a JSON parser.
+*/
+class MicroBenchmark
+{
+private:
+    struct Case
+    {
+        std::string name;
+        uint64_t itemsPerIteration;
+        std::function<MicroBenchmarkBody()> setup;
+    };
+    std::vector<Case> cases;
+
+    static MicroBenchmarkResult measure(const std::string &name, MicroBenchmarkBody &body, uint64_t itemsPerIteration);
+    static bool readBaseline(const std::string &path, std::vector<std::pair<std::string, double>> &medians);
+    static void writeReport(std::ostream &stream, const std::vector<MicroBenchmarkResult> &results);
+
+public:
+    /**
+     * @brief Register a case.
+     * @param name Stable name, reports of different commits are matched by it.
+     * @param itemsPerIteration Items one iteration handles, 0 if throughput means nothing for the case.
+     * @param setup Builds case's data, returns body that is timed.
+    */
+    void add(const std::string &name, uint64_t itemsPerIteration, std::function<MicroBenchmarkBody()> setup);
+
+    /**
+     * @brief Run cases selected by "[--filter text] [--output file.json] [--baseline file.json] [--list]".
+     * @return Exit code of program.
+    */
+    int run(int argc, char** argv);
+
+    /**
+     * @brief Keep compiler from dropping computation whose result is otherwise unused.
+    */
+    template <typename T>
+    static void doNotOptimize(const T &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+};
@@ -0,0 +1,132 @@
+#include "modelBenchmark.h"
+
+#include <memory>
+
+#include "model.h"
+
+constexpr unsigned int TEXTURES_PER_MATERIAL = 4;
+
+aiScene* ModelBenchmark::createScene(unsigned int vertexCount)
+{
+    aiScene* scene = new aiScene();
+    scene->mRootNode = new aiNode();
+    scene->mNumMaterials = 1;
+    scene->mMaterials = new aiMaterial*[1];
+    scene->mMaterials[0] = new aiMaterial();
+    if(vertexCount == 0)
+        return scene;
+
+    // Flat grid with every attribute processMesh() reads
+    aiMesh* mesh = new aiMesh();
+    mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+    mesh->mNumVertices = vertexCount;
+    mesh->mVertices = new aiVector3D[vertexCount];
+    mesh->mNormals = new aiVector3D[vertexCount];
+    mesh->mTangents = new aiVector3D[vertexCount];
+    mesh->mBitangents = new aiVector3D[vertexCount];
+    mesh->mTextureCoords[0] = new aiVector3D[vertexCount];
+    mesh->mNumUVComponents[0] = 2;
+    for(unsigned int i = 0; i < vertexCount; i++)
+    {
+        float x = float(i % 1024), z = float(i / 1024);
+        mesh->mVertices[i] = aiVector3D(x, 0.0f, z);
+        mesh->mNormals[i] = aiVector3D(0.0f, 1.0f, 0.0f);
+        mesh->mTangents[i] = aiVector3D(1.0f, 0.0f, 0.0f);
+        mesh->mBitangents[i] = aiVector3D(0.0f, 0.0f, 1.0f);
+        mesh->mTextureCoords[0][i] = aiVector3D(x / 1024.0f, z / 1024.0f, 0.0f);
+    }
+
+    mesh->mNumFaces = vertexCount / 3;
+    mesh->mFaces = new aiFace[mesh->mNumFaces];
+    for(unsigned int i = 0; i < mesh->mNumFaces; i++)
+    {
+        mesh->mFaces[i].mNumIndices = 3;
+        mesh->mFaces[i].mIndices = new unsigned int[3] { i * 3, i * 3 + 1, i * 3 + 2 };
+    }
+    mesh->mMaterialIndex = 0;
+
+    scene->mNumMeshes = 1;
+    scene->mMeshes = new aiMesh*[1];
+    scene->mMeshes[0] = mesh;
+    scene->mRootNode->mNumMeshes = 1;
+    scene->mRootNode->mMeshes = new unsigned int[1] { 0 };
+    return scene;
+}
+
+// Model with nothing loaded (its scene has no meshes, so no GL objects are made), steps are called on it directly
+struct EmptyModel
+{
+    std::unique_ptr<aiScene> scene;
+    std::unique_ptr<aiScene> meshScene;     // Input of processMesh cases, never loaded by Model
+    ResourceUploader uploader { nullptr };
+    std::unique_ptr<Model> model;
+
+    ~EmptyModel()
+    {
+        // Fake textures of loadMaterialTextures cases must not reach glDeleteTextures() in ~Model
+        if(model)
+            model->texturesLoaded.clear();
+    }
+};
+
+static void createEmptyModel(EmptyModel &empty, aiScene* scene)
+{
+    empty.scene.reset(scene);
+    empty.model.reset(new Model(empty.scene.get(), "."));
+}
+
+void ModelBenchmark::addCases(MicroBenchmark &suite)
+{
+    const std::pair<const char*, unsigned int> meshSizes[] = { { "10k", 10000 }, { "100k", 100000 }, { "1M", 1000000 }, { "10M", 10000000 } };
+    for(const std::pair<const char*, unsigned int> &size : meshSizes)
+    {
+        unsigned int vertexCount = size.second;
+        suite.add(std::string("Model::processMesh/") + size.first, vertexCount, [vertexCount]() -> MicroBenchmarkBody
+        {
+            std::shared_ptr<EmptyModel> state(new EmptyModel());
+            createEmptyModel(*state, createScene(0));
+            state->meshScene.reset(createScene(vertexCount));
+            // Model keeps uploader only while loading, meshes are then created without GL objects like in 9-model
+            state->model->uploader = &state->uploader;
+            return [state](uint64_t iterations)
+            {
+                aiScene* scene = state->meshScene.get();
+                for(uint64_t i = 0; i < iterations; i++)
+                {
+                    Mesh mesh = state->model->processMesh(scene->mMeshes[0], scene);
+                    MicroBenchmark::doNotOptimize(mesh.vertices.data());
+                }
+            };
+        });
+    }
+
+    // Name is size of texturesLoaded, every path is looked up in it and the ones asked for are at its end (all hits, nothing is read)
+    const unsigned int loadedCounts[] = { 16, 256, 4096 };
+    for(unsigned int loadedCount : loadedCounts)
+    {
+        suite.add("Model::loadMaterialTextures/" + std::to_string(loadedCount), TEXTURES_PER_MATERIAL, [loadedCount]() -> MicroBenchmarkBody
+        {
+            std::shared_ptr<EmptyModel> state(new EmptyModel());
+            createEmptyModel(*state, createScene(0));
+
+            Model &model = *state->model;
+            for(unsigned int i = 0; i < loadedCount; i++)
+                model.texturesLoaded.push_back({ 0, "texture_diffuse", "textures/texture_" + std::to_string(i) + ".png" });
+            aiMaterial* material = state->scene->mMaterials[0];
+            for(unsigned int i = 0; i < TEXTURES_PER_MATERIAL; i++)
+            {
+                aiString path(model.texturesLoaded[loadedCount - 1 - i].path);
+                material->AddProperty(&path, AI_MATKEY_TEXTURE(aiTextureType_DIFFUSE, i));
+            }
+
+            return [state, material](uint64_t iterations)
+            {
+                for(uint64_t i = 0; i < iterations; i++)
+                {
+                    std::vector<Texture> textures = state->model->loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
+                    MicroBenchmark::doNotOptimize(textures.data());
+                }
+            };
+        });
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <assimp/scene.h>
+
+#include "microBenchmark.h"
+
+/**
+ * @brief Class ModelBenchmark registers cases for Model's loading steps, it is Model's friend so single steps can be timed.
+ *
+ * Scenes are generated in memory, nothing is read from disk. Meshes are processed the way 9-model loads them (with a
+ * ResourceUploader), so processMesh() only converts data and creates no GL objects.
+*/
+class ModelBenchmark
+{
+private:
+    /**
+     * @brief Scene with one triangle mesh of vertexCount vertices (none if 0) and one material without textures.
+    */
+    static aiScene* createScene(unsigned int vertexCount);
+
+public:
+    static void addCases(MicroBenchmark &suite);
+};
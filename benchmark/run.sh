@@ -0,0 +1,29 @@
+#!/bin/sh
+# Run benchmark mode of every chapter that has been built and collect the reports.
+# usage: benchmark/run.sh [output directory] [extra main.o arguments, e.g. --frames 300 --size 1920x1080]
+# Chapters have to be built first (mkdir build && cd build && cmake .. && make in each chapter).
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+output=${1:-"$root/benchmark/results"}
+[ $# -gt 0 ] && shift
+mkdir -p "$output"
+output=$(cd "$output" && pwd)
+
+status=0
+for chapter in 7-camera 8-light 9-model 10-depth-and-stencil 11-blending 12-face-culling 13-framebuffer 14-cubemaps 15-advanced-glsl
+do
+    build="$root/$chapter/build"
+    if [ ! -x "$build/main.o" ]; then
+        echo "$chapter: not built, skipped"
+        continue
+    fi
+
+    # Chapters find shaders and assets relative to the directory they run from
+    if (cd "$build" && ./main.o --benchmark --output "$output/$chapter.json" "$@" > "$output/$chapter.log" 2>&1); then
+        echo "$chapter: $output/$chapter.json"
+    else
+        echo "$chapter: failed, see $output/$chapter.log"
+        status=1
+    fi
+done
+exit $status